@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+
+using namespace std;
+
+/**
+ * @brief A monotonic arena that backs the short-lived objects created
+ * while producing the plan of a single query (boundaries, interval
+ * lists, requests, complex boundaries and scan parameters). The owner
+ * passes resource() to the functions that produce the plan; destroying
+ * the arena releases all allocations at once, so the objects allocated
+ * from it must not outlive it. A copy of a pmr container allocated
+ * from the arena is allocated from the default resource, only a move
+ * keeps the arena.
+ */
+class QueryArena
+{
+  public:
+    static const size_t kDefaultSize = 1 << 20;
+
+    QueryArena(size_t initial_size = kDefaultSize)
+        : buffer(initial_size, std::pmr::new_delete_resource())
+    {
+    }
+
+    QueryArena(const QueryArena &) = delete;
+    QueryArena &operator=(const QueryArena &) = delete;
+
+    std::pmr::memory_resource *resource()
+    {
+        return &buffer;
+    }
+
+  private:
+    std::pmr::monotonic_buffer_resource buffer;
+};
+
+/**
+ * @brief make_shared that places the object and its control block in a
+ * memory resource
+ */
+template <typename T, typename... Args>
+shared_ptr<T> makeArenaShared(std::pmr::memory_resource *resource,
+                              Args &&...args)
+{
+    return std::allocate_shared<T>(
+        std::pmr::polymorphic_allocator<T>(resource),
+        std::forward<Args>(args)...);
+}
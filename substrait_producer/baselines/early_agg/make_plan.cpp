@@ -2,8 +2,8 @@
 #include "baselines/make_plan_base.h"
 #include "produce_plan/build_substrait.h"
 #include "produce_plan/helper.h"
-#include <boost/dynamic_bitset.hpp>
 #include <iostream>
+#include <sstream>
 
 using namespace std;
 
@@ -63,14 +63,16 @@ shared_ptr<Schema> reconstructByAgg(
     // then evaluate the query predicate
     vector<shared_ptr<const Expression>> new_filters;
     auto requested_attributes = query->getAllReferredAttributes();
-    for (string attribute : requested_attributes)
+    for (int off_in_table = requested_attributes.findFirst();
+         off_in_table != AttributeSet::npos;
+         off_in_table = requested_attributes.findNext(off_in_table))
     {
+        string attribute = table_schema->get(off_in_table)->getName();
         if (!schema_after_agg->contains(attribute))
             throw Exception(
                 "reconstruct: the schema after reconstruction does "
                 "contain the requested attribute " +
                 attribute);
-        int off_in_table = table_schema->getOffset(attribute);
         auto valid_attr_exp = makeBitmapGet(
             valid_attribute_name, schema_after_agg, off_in_table);
         new_filters.push_back(std::move(valid_attr_exp));
@@ -95,50 +97,45 @@ shared_ptr<Schema> evaluateEarlyAgg(
     bool is_reconstruct)
 {
     auto params = mergeBeforeRead(unmerged_params);
-    cout << table_schema->toString() << endl;
-    cout << query->toString() << endl;
-    if (is_reconstruct)
-        printf("**************Early agg (%zu params)***************\n",
-               params.size());
-    else
-        printf(
-            "**************Early direct (%zu params)***************\n",
-            params.size());
-    for (auto p : params)
-        cout << p->toString() << endl;
+    if (InputParameter::get()->verbose)
+    {
+        std::ostringstream dump;
+        dump << table_schema->toString() << endl;
+        dump << query->toString() << endl;
+        dump << "**************Early "
+             << (is_reconstruct ? "agg" : "direct") << " ("
+             << params.size() << " params)***************\n";
+        for (auto p : params)
+            dump << p->toString() << endl;
+        fputs(dump.str().c_str(), stdout);
+    }
 
-    boost::dynamic_bitset<> requested_attributes(table_schema->size());
+    AttributeSet requested_attributes(table_schema->size());
     for (auto p : params)
         requested_attributes |= p->project_attributes;
-    vector<substrait::Rel *> read_rel;
+    // read the blocks directly into the inputs of the union
+    substrait::Rel *union_rel = newRel(*rel);
     shared_ptr<Schema> schema_after_read;
     for (auto p : params)
     {
-        auto rel = new substrait::Rel();
-        auto s = readBlocks(rel, p, table_schema, requested_attributes);
+        auto s = readBlocks(union_rel->mutable_set()->add_inputs(), p,
+                            table_schema, requested_attributes);
         if (!schema_after_read)
             schema_after_read = s;
         else if (!schema_after_read->equal(s))
             throw Exception(
                 "evaluate: inputs of union have different schemas");
-        read_rel.push_back(rel);
     }
 
     // union all
-    substrait::Rel *union_rel = new substrait::Rel();
     auto schema_after_union = unionAll(union_rel, schema_after_read);
-    for (auto r : read_rel)
-    {
-        *union_rel->mutable_set()->add_inputs() = *r;
-        delete r;
-    }
 
     // reconstruct
     substrait::Rel *reconstruct_rel = union_rel;
     auto schema_after_reconstruct = schema_after_union;
     if (is_reconstruct)
     {
-        reconstruct_rel = new substrait::Rel();
+        reconstruct_rel = newRel(*rel);
         schema_after_reconstruct =
             reconstructByAgg(reconstruct_rel, union_rel,
                              schema_after_union, table_schema, query);
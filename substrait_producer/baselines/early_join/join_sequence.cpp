@@ -17,9 +17,9 @@ MiniTable::MiniTable(
 void MiniTable::addDataBlock(shared_ptr<const ScanParameter> block)
 {
     data_blocks.push_back(block);
-    for (auto i = block->project_attributes.find_first();
-         i != block->project_attributes.npos;
-         i = block->project_attributes.find_next(i))
+    for (int i = block->project_attributes.findFirst();
+         i != AttributeSet::npos;
+         i = block->project_attributes.findNext(i))
     {
         if (!mini_schema->contains(table_schema->get(i)->getName()))
             mini_schema->add(table_schema->get(i));
@@ -29,8 +29,8 @@ void MiniTable::addDataBlock(shared_ptr<const ScanParameter> block)
 shared_ptr<Schema> MiniTable::makeSubstraitRel(
     ::substrait::Rel *rel) const
 {
-    boost::dynamic_bitset<> requested_attributes =
-        table_schema->getOffsets(mini_schema);
+    AttributeSet requested_attributes(
+        table_schema->getOffsets(mini_schema));
     if (data_blocks.size() == 0)
         throw Exception("MiniTable::makeSubstraitRel: mini table must "
                         "have at least one data block");
@@ -224,8 +224,8 @@ shared_ptr<Schema> FilterParameter::makeSubstraitRel(
         child->makeSubstraitRel(join_rel, table_schema);
 
     vector<shared_ptr<const Expression>> filter_exp;
-    for (auto i = expect_valid.find_first(); i != expect_valid.npos;
-         i = expect_valid.find_next(i))
+    for (int i = expect_valid.findFirst(); i != AttributeSet::npos;
+         i = expect_valid.findNext(i))
         filter_exp.push_back(
             makeBitmapGet(valid_attribute_name, schema_after_join, i));
 
@@ -273,26 +273,19 @@ string FilterParameter::toString() const
 {
     string ans = "Filter:{\n" + child->toString() + "\n";
 
-    auto bitset_to_string =
-        [&](const boost::dynamic_bitset<> &bitset) -> string {
-        size_t size = bitset.size();
-        char c_str[size + 1] = {0};
-        for (size_t i = 0; i < size; i++)
-            if (bitset.test(i))
-                c_str[i] = '1';
-            else
-                c_str[i] = '0';
-        return string(c_str);
-    };
-    ans += "expect_valid: " + bitset_to_string(expect_valid) + "\n";
+    ans += "expect_valid: " + expect_valid.toString() + "\n";
     ans += "expect_same:{\n";
     for (auto it = expect_same.begin(); it != expect_same.end(); it++)
         ans += std::to_string(it->first) + ": " +
-               bitset_to_string(it->second) + "\n";
+               it->second.toString() + "\n";
     ans += "}\n}\\END FILTER";
     return ans;
 }
 
+// the helpers are local, so that the baselines link with the late
+// reconstruction that has helpers of the same names
+namespace
+{
 /**
  * @brief Find the attribute that has the most tuples in the active set
  *
@@ -303,15 +296,15 @@ string FilterParameter::toString() const
  */
 int findLargestAttribute(
     const list<pair<shared_ptr<const ScanParameter>, int64_t>> &active,
-    const boost::dynamic_bitset<> &query_attributes)
+    const AttributeSet &query_attributes)
 {
     unordered_map<int, int64_t> tnum;
     for (auto it = active.begin(); it != active.end(); it++)
     {
         const auto &proj_attr = it->first->project_attributes;
         int64_t t = it->second;
-        for (auto i = proj_attr.find_first(); i != proj_attr.npos;
-             i = proj_attr.find_next(i))
+        for (int i = proj_attr.findFirst(); i != AttributeSet::npos;
+             i = proj_attr.findNext(i))
         {
             if (query_attributes.test(i))
                 tnum[i] += t;
@@ -364,29 +357,27 @@ unordered_set<shared_ptr<const ScanParameter>> extractBlocks(
  */
 void checkAttributes(
     const unordered_set<shared_ptr<const ScanParameter>> &finished,
-    const boost::dynamic_bitset<> &query_attributes,
-    boost::dynamic_bitset<> &expect_valid,
-    unordered_map<int, boost::dynamic_bitset<>> &expect_same)
+    const AttributeSet &query_attributes, AttributeSet &expect_valid,
+    unordered_map<int, AttributeSet> &expect_same)
 {
     unordered_map<int, boost::dynamic_bitset<>> occurence;
-    for (auto i = query_attributes.find_first();
-         i != query_attributes.npos; i = query_attributes.find_next(i))
+    for (int i = query_attributes.findFirst(); i != AttributeSet::npos;
+         i = query_attributes.findNext(i))
         occurence[i].resize(finished.size(), false);
 
     int idx = 0;
     for (auto it = finished.begin(); it != finished.end(); it++, idx++)
     {
         const auto &proj = (*it)->project_attributes;
-        for (auto i = proj.find_first(); i != proj.npos;
-             i = proj.find_next(i))
+        for (int i = proj.findFirst(); i != AttributeSet::npos;
+             i = proj.findNext(i))
         {
             if (query_attributes.test(i))
                 occurence[i].set(idx);
         }
     }
 
-    expect_valid.resize(query_attributes.size());
-    expect_valid.reset();
+    expect_valid = AttributeSet(query_attributes.size());
     expect_same.clear();
     for (auto it = occurence.begin(); it != occurence.end(); it++)
     {
@@ -402,8 +393,7 @@ void checkAttributes(
                 {
                     if (expect_same.count(it->first) == 0)
                         expect_same[it->first] =
-                            boost::dynamic_bitset<>(
-                                query_attributes.size(), false);
+                            AttributeSet(query_attributes.size());
                     expect_same[it->first].set(it1->first);
                 }
             }
@@ -415,7 +405,7 @@ makeJoinSequenceRecursive(
     list<pair<shared_ptr<const ScanParameter>, int64_t>> active,
     unordered_set<shared_ptr<const ScanParameter>> finished,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &query_attributes)
+    const AttributeSet &query_attributes)
 {
     int attribute = findLargestAttribute(active, query_attributes);
     const auto &mini_table_blocks = extractBlocks(active, attribute);
@@ -441,13 +431,14 @@ makeJoinSequenceRecursive(
 
     return filter_node;
 }
+}; // namespace
 
 variant<shared_ptr<MiniTable>, shared_ptr<FilterParameter>>
 makeJoinSequence(
     shared_ptr<const Schema> table_schema,
     const vector<shared_ptr<const ScanParameter>> &scan_parameters)
 {
-    boost::dynamic_bitset<> query_attributes(table_schema->size());
+    AttributeSet query_attributes(table_schema->size());
     list<pair<shared_ptr<const ScanParameter>, int64_t>> active;
     unordered_set<shared_ptr<const ScanParameter>> finished;
     for (auto p : scan_parameters)
@@ -464,8 +455,8 @@ makeJoinSequence(
         query_attributes |= p->project_attributes;
     }
 
-    for (auto i = query_attributes.find_first();
-         i != query_attributes.npos; i = query_attributes.find_next(i))
+    for (int i = query_attributes.findFirst(); i != AttributeSet::npos;
+         i = query_attributes.findNext(i))
         if (table_schema->get(i)->getName() == block_id_name ||
             table_schema->get(i)->getName() == tuple_id_name)
             query_attributes.reset(i);
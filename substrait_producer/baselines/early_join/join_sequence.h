@@ -62,11 +62,11 @@ struct FilterParameter
     shared_ptr<JoinParameter> child;
 
     // all these attributes must be valid in the output of child
-    boost::dynamic_bitset<> expect_valid;
+    AttributeSet expect_valid;
 
     // the key attribute must be valid if any attribute of the value is
     // valid
-    unordered_map<int, boost::dynamic_bitset<>> expect_same;
+    unordered_map<int, AttributeSet> expect_same;
 
     bool needFilter() const
     {
@@ -5,6 +5,7 @@
 #include "produce_plan/helper.h"
 #include "substrait/plan.pb.h"
 #include <iostream>
+#include <sstream>
 #include <variant>
 
 using namespace std;
@@ -55,28 +56,46 @@ shared_ptr<Schema> evaluateEarlyJoin(
 {
     auto reconstruct_params =
         mergeBeforeRead(unmerged_reconstruct_params);
-    cout << table_schema->toString() << endl;
-    cout << query->toString() << endl;
-    printf("**************Early join (%zu params)***************\n",
-           reconstruct_params.size());
-    for (auto p : reconstruct_params)
-        cout << p->toString() << endl;
-
     auto join_sequence =
         makeJoinSequence(table_schema, reconstruct_params);
-    if (std::get_if<shared_ptr<MiniTable>>(&join_sequence))
-        cout << std::get<shared_ptr<MiniTable>>(join_sequence)
-                    ->toString()
-             << endl;
-    else
-        cout << std::get<shared_ptr<FilterParameter>>(join_sequence)
-                    ->toString()
-             << endl;
+    if (InputParameter::get()->verbose)
+    {
+        std::ostringstream dump;
+        dump << table_schema->toString() << endl;
+        dump << query->toString() << endl;
+        dump << "**************Early join ("
+             << reconstruct_params.size()
+             << " params)***************\n";
+        for (auto p : reconstruct_params)
+            dump << p->toString() << endl;
+        if (std::get_if<shared_ptr<MiniTable>>(&join_sequence))
+            dump << std::get<shared_ptr<MiniTable>>(join_sequence)
+                        ->toString()
+                 << endl;
+        else
+            dump << std::get<shared_ptr<FilterParameter>>(
+                        join_sequence)
+                        ->toString()
+                 << endl;
+        fputs(dump.str().c_str(), stdout);
+    }
 
-    substrait::Rel *reconstruct_rel = new substrait::Rel();
+    substrait::Rel *reconstruct_rel = newRel(*rel);
     auto schema_after_reconstruct =
         reconstructByJoin(reconstruct_rel, join_sequence, table_schema);
 
+    // the scans only apply the filter boundary, which widens the
+    // conjuncts on several attributes to their full ranges
+    if (query->getTemplate()->hasResidualFilters())
+    {
+        substrait::Rel *filter_rel = newRel(*rel);
+        filter_rel->mutable_filter()->set_allocated_input(
+            reconstruct_rel);
+        schema_after_reconstruct = filter(
+            filter_rel, query->getFilter(), schema_after_reconstruct);
+        reconstruct_rel = filter_rel;
+    }
+
     auto schema_after_agg = aggregate(rel, reconstruct_rel,
                                       schema_after_reconstruct, query);
     return schema_after_agg;
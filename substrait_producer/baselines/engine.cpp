@@ -1,24 +1,21 @@
+#include "arena.h"
 #include "baselines/make_plan_base.h"
 #include "baselines/produce_scan_parameter.h"
 #include "configuration.h"
-#include "google/protobuf/util/json_util.h"
-#include "metadata/boundary.h"
+#include "evaluate/table_sample.h"
+#include "metadata/layout.h"
 #include "metadata/query.h"
 #include "metadata/schema.h"
+#include "plan_cache.h"
+#include "plan_writer.h"
 #include "produce_plan/build_substrait.h"
-#include <google/protobuf/text_format.h>
+#include "query_pipeline.h"
+#include <mutex>
 #include <stdio.h>
 #include <stdlib.h>
 
 using namespace std;
 
-void setMinMax(const Boundary *boundary)
-{
-    auto intervals = boundary->getIntervals();
-    for (auto p : intervals)
-        setMinMax(p.first, p.second->getMin(), p.second->getMax());
-}
-
 int main(int argc, char const *argv[])
 {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
@@ -26,79 +23,76 @@ int main(int argc, char const *argv[])
 
     // parse schema
     shared_ptr<Schema> table_schema;
-    vector<shared_ptr<const PartitionMeta>> partitions;
-    vector<shared_ptr<Query>> queries;
-    {
-        substrait::NamedStruct s;
-        readSubstrait(&s, parameter->schema_path);
-        table_schema = Schema::parseSubstraitSchema(&s);
-    }
+    shared_ptr<const TableStatistics> statistics;
+    table_schema = Schema::readSchema(parameter->schema_path);
 
-    // set min/max
+    // get min/max
     {
         substrait::Partition s;
         readSubstrait(&s, parameter->table_range_path);
-        auto p = PartitionMeta::parseSubstraitPartition(
-            &s, table_schema, parameter->data_path);
-        setMinMax(p->getBlocks()[0]->getBoundary().get());
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+        if (!parameter->sample_path.empty())
+            statistics = statistics->withSample(TableSample::readSample(
+                parameter->sample_path, table_schema));
     }
 
-    // parse partitions
-    {
-        substrait::PartitionList s;
-        readSubstrait(&s, parameter->partition_path);
-        for (int i = 0; i < s.partitions_size(); i++)
-        {
-            bool check_path = false;
-            if (parameter->engine == InputParameter::Engine::Velox)
-                check_path = true;
-            auto &p = s.partitions(i);
-            partitions.push_back(PartitionMeta::parseSubstraitPartition(
-                &p, table_schema, parameter->data_path, check_path));
-        }
-    }
-    // parse query
+    // parse partitions, or map the catalog whose blocks are built once
+    // a query selects them. The layout is loaded by the first query
+    // whose plan is not cached, so a run that hits the plan cache on
+    // every query never reads it
+    shared_ptr<const Layout> layout;
+    std::once_flag layout_loaded;
+    auto load_layout = [&]
     {
-        substrait::Plan p;
-        readSubstrait(&p, parameter->query_path);
-        queries = Query::parseSubstraitQuery(&p, table_schema,
-                                             parameter->data_path);
-    }
+        layout = Layout::load(*parameter, table_schema, statistics);
+    };
+    // read the queries one at a time, so that only the query being
+    // planned is in memory
+    bool from_log = !parameter->query_log_path.empty();
+    QueryReader reader(from_log ? parameter->query_log_path
+                                : parameter->query_path,
+                       from_log, table_schema, statistics,
+                       parameter->data_path);
 
     // evalaute queries
-    for (int i = 0; i < queries.size(); i++)
+    PlanWriter writer(*parameter);
+    PlanCache cache(*parameter, "baseline");
+    auto plan_query = [&](int i, shared_ptr<const Query> query)
     {
-        substrait::Plan plan;
-        registFunctions(&plan);
-        auto rel = plan.add_relations()->mutable_rel();
+        // the plan is built on an arena, so the subtrees built apart
+        // are moved into it without copies and all freed at once
+        google::protobuf::Arena arena;
+        auto plan =
+            google::protobuf::Arena::CreateMessage<substrait::Plan>(
+                &arena);
+        if (cache.enabled() && cache.read(*query, plan))
+        {
+            writer.write(i, *plan);
+            return;
+        }
+        std::call_once(layout_loaded, load_layout);
+        registFunctions(plan);
+        auto rel = plan->add_relations()->mutable_rel();
+        auto query_partitions = layout->selectPartitions(*query);
+        QueryArena query_arena;
         auto scan_parameters =
-            produceScanParameters(queries[i], table_schema, partitions);
+            produceScanParameters(query, table_schema, query_partitions,
+                                  query_arena.resource());
 
-        evaluate(rel, table_schema, queries[i], scan_parameters.second,
+        evaluate(rel, table_schema, query, scan_parameters.second,
                  scan_parameters.first);
 
-        // write plan
-        string plan_path =
-            parameter->plan_dir + "/q" + std::to_string(i);
-        // ofstream ofile(plan_path, ios::trunc | ios::binary);
-        // if (!plan.SerializeToOstream(&ofile))
-        // {
-        //     std::cerr << "Failed to write plan" << endl;
-        //     return -1;
-        // }
-        // ofile.close();
-
-        ofstream ofile(plan_path, ios::trunc);
-        string plan_str;
-        if (!google::protobuf::TextFormat::PrintToString(plan,
-                                                         &plan_str))
-        {
-            std::cerr << "Failed to serialize plan" << endl;
-            return -1;
-        }
-        ofile << plan_str;
-        ofile.close();
-    }
+        // write the plan
+        if (cache.enabled())
+            cache.write(*query, *plan);
+        writer.write(i, *plan);
+    };
+    // plan the queries on the workers. The plan of the i-th query is
+    // written to q<i>, or as the i-th plan of the stream, whatever the
+    // number of workers
+    planQueries(reader, parameter->workers, plan_query);
+    writer.close();
     google::protobuf::ShutdownProtobufLibrary();
 
     return 0;
@@ -9,7 +9,7 @@ using namespace std;
 shared_ptr<Schema> readBlocks(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &requested_attributes)
+    const AttributeSet &requested_attributes)
 {
     substrait::Rel *project_rel, *filter_rel, *read_rel;
     project_rel = rel;
@@ -39,9 +39,8 @@ shared_ptr<Schema> readBlocks(
     project_expression.push_back(
         make_shared<Literal>(valid_attribute_name, valid_attribute));
 
-    for (auto i = requested_attributes.find_first();
-         i != requested_attributes.npos;
-         i = requested_attributes.find_next(i))
+    for (int i = requested_attributes.findFirst();
+         i != AttributeSet::npos; i = requested_attributes.findNext(i))
     {
         if (parameter->project_attributes.test(i))
             project_expression.push_back(table_schema->get(i));
@@ -77,17 +76,27 @@ shared_ptr<Schema> aggregate(substrait::Rel *rel,
         project_rel->mutable_project()->set_allocated_input(input_rel);
     }
 
-    auto all_measures = query->getMeasures();
+    const auto &all_measures = query->getMeasures();
     vector<shared_ptr<const Expression>> project_expression;
+    // the measures on one expression, e.g. sum(a) and max(a), read the
+    // same projected column
+    unordered_map<string, shared_ptr<const Expression>> projected;
     for (auto m : all_measures)
     {
         if (m->getChildren().size() != 1)
             throw Exception("aggregate: an aggregate measure function "
                             "must exactly have one arguments");
-        // auto child =
-        //     shared_ptr<Expression>(m->getChildren()[0]->clone());
-        // child->setName(m->getName());
-        project_expression.push_back(m->getChildren()[0]);
+        auto child = m->getChildren()[0];
+        auto it = projected.find(child->getName());
+        if (it == projected.end())
+        {
+            projected.emplace(child->getName(), child);
+            project_expression.push_back(child);
+        }
+        else if (!it->second->equal(child))
+            throw Exception("aggregate: the measures have different "
+                            "arguments named " +
+                            child->getName());
     }
     auto schema_after_project =
         project(project_rel, project_expression, input_schema);
@@ -120,10 +129,39 @@ shared_ptr<Schema> evaluate(
 {
     // either reconstruct everything or nothing
     assert(direct_params.size() == 0 || reconstruct_params.size() == 0);
-    assert(direct_params.size() + reconstruct_params.size() > 0);
+
+    // no block passes the filter, so aggregate an empty table
+    if (direct_params.size() + reconstruct_params.size() == 0)
+    {
+        const auto &all_measures = query->getMeasures();
+        auto schema_after_read = readNothing(
+            rel->mutable_aggregate()->mutable_input(), all_measures);
+        vector<shared_ptr<const AggregateExpression>>
+            measures_after_read;
+        for (int i = 0; i < all_measures.size(); i++)
+        {
+            auto m = all_measures[i];
+            measures_after_read.push_back(
+                make_shared<AggregateExpression>(
+                    m->getName(), m->getFunction(),
+                    vector<shared_ptr<const Expression>>{
+                        schema_after_read->get(i)},
+                    m->getType(), m->getNullable()));
+        }
+        return aggregate(rel, schema_after_read, measures_after_read,
+                         nullptr);
+    }
 
     if (reconstruct_params.size())
     {
+        if (InputParameter::get()->reconstruct ==
+            InputParameter::ReconstructType::Merge)
+            throw Exception(
+                "evaluate: the baselines do not reconstruct by merge");
+        if (InputParameter::get()->reconstruct ==
+            InputParameter::ReconstructType::Positional)
+            throw Exception("evaluate: the baselines do not "
+                            "reconstruct by position");
         if (InputParameter::get()->reconstruct ==
             InputParameter::ReconstructType::Join)
             return evaluateEarlyJoin(rel, table_schema, query,
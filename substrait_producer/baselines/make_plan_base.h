@@ -8,7 +8,7 @@
 shared_ptr<Schema> readBlocks(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &requested_attributes);
+    const AttributeSet &requested_attributes);
 
 shared_ptr<Schema> aggregate(substrait::Rel *rel,
                              substrait::Rel *input_rel,
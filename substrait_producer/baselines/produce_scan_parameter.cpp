@@ -1,33 +1,51 @@
 #include "baselines/produce_scan_parameter.h"
+#include "arena.h"
 
 shared_ptr<ScanParameter> produceScanParameters(
     shared_ptr<const BlockMeta> block, shared_ptr<const Query> query,
-    shared_ptr<const Schema> table_schema)
+    shared_ptr<const Schema> table_schema,
+    std::pmr::memory_resource *resource)
 {
-    shared_ptr<ScanParameter> p = make_shared<ScanParameter>();
+    shared_ptr<ScanParameter> p =
+        makeArenaShared<ScanParameter>(resource);
     p->file_path = block->getPartition()->getPath();
     p->block_id.insert(block->getBlockID());
     p->blocks.insert(block);
 
-    auto query_boundary =
-        shared_ptr<Boundary>(query->getFilterBoundary()->clone());
-    auto block_attributes = block->getSchema()->getAttributeNames();
+    auto query_boundary = makeArenaShared<ComplexBoundary>(
+        resource, *query->getFilterBoundary(), resource);
+    const auto &block_attributes =
+        block->getSchema()->getAttributeSet();
     // only keep intervals that the referred attributes are in the block
     query_boundary->keepAttributes(block_attributes);
-    p->filter_boundary = make_shared<ComplexBoundary>(*query_boundary);
-    p->filter = query_boundary->makeExpression();
+    p->filter_boundary = query_boundary;
+    auto filter = query_boundary->makeExpression();
+    // the boundary widens the conjuncts on several attributes, which
+    // are evaluated here if the block contains their attributes
+    const auto &residual_attributes =
+        query->attributesInResidualFilters();
+    if (!residual_attributes.empty() &&
+        residual_attributes.isSubsetOf(block_attributes))
+    {
+        vector<shared_ptr<const Expression>> exps;
+        if (filter)
+            exps.push_back(filter);
+        const auto &sub_filters = query->getSubFilters();
+        const auto &offsets =
+            query->getTemplate()->subFilterAttributes();
+        for (int i = 0; i < sub_filters.size(); i++)
+            if (offsets[i] < 0)
+                exps.push_back(sub_filters[i]);
+        filter = FunctionExpression::connectExpression(
+            "filter_exp", exps, false, true);
+    }
+    p->filter = Expression::intern<FunctionExpression>(filter);
 
     auto requested_attributes = query->getAllReferredAttributes();
-    requested_attributes.insert(tuple_id_name);
+    requested_attributes.set(table_schema->getOffset(tuple_id_name));
 
+    p->read_attributes = requested_attributes & block_attributes;
     p->read_attributes.resize(table_schema->size());
-    for (auto a : requested_attributes)
-    {
-        if (!block->getSchema()->contains(a))
-            continue;
-        int off = table_schema->getOffset(a);
-        p->read_attributes.set(off, true);
-    }
     p->project_attributes = p->read_attributes;
     return p;
 }
@@ -37,11 +55,11 @@ std::pair<vector<shared_ptr<const ScanParameter>>,
 produceScanParameters(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const PartitionMeta>> &partitions)
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    std::pmr::memory_resource *resource)
 {
     auto query_boundary = query->getFilterBoundary();
-    unordered_set<string> requested_attributes =
-        query->getAllReferredAttributes();
+    auto requested_attributes = query->getAllReferredAttributes();
 
     vector<shared_ptr<const ScanParameter>> empty;
     vector<shared_ptr<ScanParameter>> result;
@@ -65,8 +83,8 @@ produceScanParameters(
                 relation == SET_RELATION::INTERSECT)
                 all_skipping = false;
 
-            result.push_back(
-                produceScanParameters(block, query, table_schema));
+            result.push_back(produceScanParameters(
+                block, query, table_schema, resource));
         }
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "produce_plan/scan_parameter.h"
+#include <memory_resource>
 
 /**
  * @brief Produce the scan parameters for early reconstruction plan.
@@ -9,6 +10,7 @@
  * @param query
  * @param table_schema
  * @param partitions
+ * @param resource the memory resource of the parameters
  * @return std::pair<vector<shared_ptr<const ScanParameter>>,
  * vector<shared_ptr<const ScanParameter>>> The first vector is for
  * partitions that do not need to be reconstructed and the second vector
@@ -19,4 +21,5 @@ std::pair<vector<shared_ptr<const ScanParameter>>,
 produceScanParameters(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const PartitionMeta>> &partitions);
\ No newline at end of file
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    std::pmr::memory_resource *resource);
\ No newline at end of file
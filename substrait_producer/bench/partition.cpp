@@ -0,0 +1,94 @@
+#include "baselines/produce_scan_parameter.h"
+#include "evaluate/table_sample.h"
+#include "metadata/boundary.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include "partitioner/common.h"
+#include "partitioner/hierarchical_partitioner.h"
+#include "partitioner/horizontal_partitioner.h"
+#include "partitioner/model.h"
+#include "produce_plan/produce_scan_parameter.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Time the partitioning algorithms on a workload. Takes the same
+ * arguments as partitioner/partitioner, except that no layout is
+ * written. Each algorithm runs kRuns times on the training queries.
+ */
+
+constexpr int kRuns = 3;
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    auto parameter = PartitionParameter::parse(argc, argv);
+
+    shared_ptr<Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
+    shared_ptr<BlockMeta> root_block;
+    unordered_set<shared_ptr<const Query>> queries, validate_queries;
+
+    table_schema = Schema::readSchema(parameter.schema_path);
+    {
+        substrait::Partition s;
+        readSubstrait(&s, parameter.table_range_path);
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+        if (!parameter.sample_path.empty())
+            statistics = statistics->withSample(TableSample::readSample(
+                parameter.sample_path, table_schema));
+        auto p = PartitionMeta::parseSubstraitPartition(
+            &s, table_schema, statistics, "", false);
+        root_block = shared_ptr<BlockMeta>(p->getBlocks()[0]->clone());
+        root_block->setSchema(table_schema);
+        IntervalMap empty_intervals;
+        root_block->setBoundary(
+            make_shared<Boundary>(empty_intervals, statistics));
+        root_block->setSortedByTid(parameter.sorted_blocks);
+    }
+    {
+        substrait::Plan p;
+        readSubstrait(&p, parameter.query_path);
+        for (auto q : Query::parseSubstraitQuery(&p, table_schema,
+                                                  statistics, ""))
+            queries.insert(q);
+    }
+    {
+        substrait::Plan p;
+        readSubstrait(&p, parameter.validation_path);
+        for (auto q : Query::parseSubstraitQuery(&p, table_schema,
+                                                  statistics, ""))
+            validate_queries.insert(q);
+    }
+
+    printf("run\tms\tblocks\n");
+    double total_ms = 0;
+    for (int i = 0; i < kRuns; i++)
+    {
+        vector<shared_ptr<const BlockMeta>> blocks;
+        auto start = std::chrono::steady_clock::now();
+        if (parameter.partition_type == PartitionParameter::Horizontal)
+            blocks = horizontalPartition(root_block, queries,
+                                         stopByRowNum, {});
+        else if (parameter.partition_type ==
+                 PartitionParameter::Hierarchical_Late)
+            blocks = hierarchicalPartition(
+                root_block, queries, validate_queries, stopByRowNum,
+                produceScanParametersAggregation, predictAggTimeLate);
+        else
+            blocks = hierarchicalPartition(
+                root_block, queries, validate_queries, stopByRowNum,
+                produceScanParameters, predictAggTimeEarly);
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        total_ms += ms;
+        printf("%d\t%.3f\t%zu\n", i, ms, blocks.size());
+    }
+    printf("mean\t%.3f\n", total_ms / kRuns);
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "arena.h"
+#include "configuration.h"
+#include "metadata/boundary.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include "produce_plan/make_plan.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Count the heap allocations made while producing the plan of each
+ * query, once with the default heap and once with a per-query
+ * QueryArena. Takes the same arguments as engine/engine, except that no
+ * plan is written and --verbose is rejected.
+ */
+
+std::atomic<uint64_t> allocation_count(0);
+
+void *operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size == 0 ? 1 : size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void *p = aligned_alloc((size_t)align,
+                            (size + (size_t)align - 1) &
+                                ~((size_t)align - 1));
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+void producePlan(
+    shared_ptr<const Query> query, shared_ptr<const Schema> table_schema,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    int query_index, std::pmr::memory_resource *resource)
+{
+    substrait::Plan plan;
+    makeQueryPlan(&plan, table_schema, query, partitions, query_index,
+                  resource);
+}
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    auto parameter = InputParameter::parse(argc, argv);
+    // the dumps of the scan parameters would be timed with the plans
+    if (parameter->verbose)
+        throw Exception("plan_alloc: --verbose is not supported");
+
+    shared_ptr<Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
+    vector<shared_ptr<const PartitionMeta>> partitions;
+    vector<shared_ptr<Query>> queries;
+    table_schema = Schema::readSchema(parameter->schema_path);
+    {
+        substrait::Partition s;
+        readSubstrait(&s, parameter->table_range_path);
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+    }
+    {
+        substrait::PartitionList s;
+        readSubstrait(&s, parameter->partition_path);
+        for (int i = 0; i < s.partitions_size(); i++)
+            partitions.push_back(PartitionMeta::parseSubstraitPartition(
+                &s.partitions(i), table_schema, statistics,
+                parameter->data_path));
+    }
+    {
+        substrait::Plan p;
+        readSubstrait(&p, parameter->query_path);
+        queries = Query::parseSubstraitQuery(
+            &p, table_schema, statistics, parameter->data_path);
+    }
+
+    printf("query\theap_allocs\tarena_allocs\theap_ms\tarena_ms\n");
+    uint64_t total_heap = 0, total_arena = 0;
+    for (int i = 0; i < queries.size(); i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t before = allocation_count.load();
+        producePlan(queries[i], table_schema, partitions, i,
+                    std::pmr::new_delete_resource());
+        uint64_t heap = allocation_count.load() - before;
+        auto mid = std::chrono::steady_clock::now();
+
+        before = allocation_count.load();
+        {
+            QueryArena arena;
+            producePlan(queries[i], table_schema, partitions, i,
+                        arena.resource());
+        }
+        uint64_t arena = allocation_count.load() - before;
+        auto end = std::chrono::steady_clock::now();
+
+        total_heap += heap;
+        total_arena += arena;
+        printf("q%d\t%lu\t%lu\t%.3f\t%.3f\n", i, heap, arena,
+               std::chrono::duration<double, std::milli>(mid - start)
+                   .count(),
+               std::chrono::duration<double, std::milli>(end - mid)
+                   .count());
+    }
+    if (queries.size())
+        printf("mean\t%lu\t%lu\n", total_heap / queries.size(),
+               total_arena / queries.size());
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return 0;
+}
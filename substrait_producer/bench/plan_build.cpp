@@ -0,0 +1,176 @@
+#include "configuration.h"
+#include "metadata/boundary.h"
+#include "metadata/schema.h"
+#include "produce_plan/build_substrait.h"
+#include "produce_plan/join_sequence.h"
+#include <atomic>
+#include <chrono>
+#include <malloc.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Time the assembly of the Substrait plan that reconstructs tuples
+ * from kWays vertical partitions of kBlocks / kWays blocks each, i.e. a
+ * kWays-way join sequence over unions of reads, and record the peak of
+ * the live heap bytes while the plan is built. The plan is built once
+ * on the heap and once on a protobuf Arena. No input file is read;
+ * --engine selects the engine the plan is built for.
+ */
+
+constexpr int kBlocks = 200;
+constexpr int kWays = 20;
+constexpr int kRuns = 20;
+
+std::atomic<uint64_t> allocation_count(0);
+std::atomic<int64_t> live_bytes(0), peak_bytes(0);
+
+void countAllocation(void *p)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    int64_t size = malloc_usable_size(p);
+    int64_t live = live_bytes.fetch_add(size) + size;
+    int64_t peak = peak_bytes.load();
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live))
+        ;
+}
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size == 0 ? 1 : size);
+    if (!p)
+        throw std::bad_alloc();
+    countAllocation(p);
+    return p;
+}
+
+// both deletes free the block themselves: a delete that forwards to
+// operator delete(void *) makes GCC warn that the malloc-backed new is
+// paired with a mismatched delete
+void releaseAllocation(void *p)
+{
+    if (p)
+        live_bytes.fetch_sub(malloc_usable_size(p));
+    free(p);
+}
+
+void operator delete(void *p) noexcept
+{
+    releaseAllocation(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    releaseAllocation(p);
+}
+
+/**
+ * @brief The scan parameters of the reconstruction, one per block.
+ * They go to makeJoinSequence directly, so the blocks are not coalesced
+ * into runs as mergeBeforeRead does for the Velox reads, and each block
+ * stays a join input of its own. The blocks of partition w hold the
+ * tuple id and attribute a<w + 1>, and a partition with a larger w has
+ * more rows, so the join sequence takes them in a fixed order.
+ */
+vector<shared_ptr<const ScanParameter>> makeParameters(
+    shared_ptr<const Schema> table_schema)
+{
+    IntervalMap no_intervals;
+    auto boundary = make_shared<Boundary>(no_intervals, nullptr);
+    auto filter_boundary = make_shared<ComplexBoundary>(*boundary);
+
+    vector<shared_ptr<const ScanParameter>> parameters;
+    for (int w = 0; w < kWays; w++)
+        for (int b = 0; b < kBlocks / kWays; b++)
+        {
+            auto p = make_shared<ScanParameter>();
+            p->filter_boundary = filter_boundary;
+            p->read_attributes.resize(table_schema->size());
+            p->read_attributes.set(
+                table_schema->getOffset(tuple_id_name));
+            p->read_attributes.set(w + 1);
+            p->project_attributes = p->read_attributes;
+            p->direct_meassures = Bitmap(1);
+            p->passed_preds = Bitmap(1);
+            p->file_path =
+                "file:///bench/partition_" + std::to_string(w);
+            p->block_id.insert(b);
+            p->blocks.insert(make_shared<BlockMeta>(
+                b, boundary, table_schema, nullptr, 1000 * (w + 1)));
+            parameters.push_back(p);
+        }
+    return parameters;
+}
+
+void buildPlan(
+    substrait::Plan *plan,
+    const vector<shared_ptr<const ScanParameter>> &parameters,
+    shared_ptr<const Schema> table_schema)
+{
+    registFunctions(plan);
+    unordered_set<int> checked_measures;
+    makeJoinSequence(plan->add_relations()->mutable_rel(), parameters,
+                     table_schema, nullptr, false, checked_measures);
+}
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    InputParameter::parse(argc, argv);
+
+    auto table_schema = make_shared<Schema>();
+    for (int i = 0; i <= kWays; i++)
+    {
+        auto a = make_shared<Attribute>(
+            i == 0 ? tuple_id_name : "a" + std::to_string(i),
+            DATA_TYPE::INTEGER);
+        a->setTableOffset(i);
+        table_schema->add(a);
+    }
+    auto parameters = makeParameters(table_schema);
+
+    printf("plan\tms\tallocs\tpeak_kb\tplan_kb\n");
+    for (bool on_arena : {false, true})
+    {
+        double total_ms = 0;
+        uint64_t allocations = 0;
+        int64_t peak = 0;
+        size_t plan_size = 0;
+        for (int i = 0; i < kRuns; i++)
+        {
+            int64_t base = live_bytes.load();
+            peak_bytes.store(base);
+            uint64_t before = allocation_count.load();
+            auto start = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point end;
+            if (on_arena)
+            {
+                google::protobuf::Arena arena;
+                auto plan = google::protobuf::Arena::CreateMessage<
+                    substrait::Plan>(&arena);
+                buildPlan(plan, parameters, table_schema);
+                end = std::chrono::steady_clock::now();
+                plan_size = plan->ByteSizeLong();
+            }
+            else
+            {
+                substrait::Plan plan;
+                buildPlan(&plan, parameters, table_schema);
+                end = std::chrono::steady_clock::now();
+                plan_size = plan.ByteSizeLong();
+            }
+            total_ms +=
+                std::chrono::duration<double, std::milli>(end - start)
+                    .count();
+            allocations += allocation_count.load() - before;
+            peak = std::max(peak, peak_bytes.load() - base);
+        }
+        printf("%s\t%.3f\t%lu\t%ld\t%zu\n", on_arena ? "arena" : "heap",
+               total_ms / kRuns, allocations / kRuns, peak / 1024,
+               plan_size / 1024);
+    }
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "configuration.h"
+#include "evaluate/predicate_program.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include "metadata/statistics.h"
+#include <chrono>
+#include <random>
+#include <stdio.h>
+
+/**
+ * Compile the filter of each query to a PredicateProgram and evaluate
+ * it over a batch of rows drawn uniformly from the table range. Reports
+ * the throughput and compares the measured selectivity with the one
+ * estimated from the filter boundary, which is exact for uniform data.
+ * Takes the same arguments as engine/engine.
+ */
+
+constexpr size_t kRows = 1 << 22;
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    auto parameter = InputParameter::parse(argc, argv);
+
+    auto table_schema = Schema::readSchema(parameter->schema_path);
+    shared_ptr<const TableStatistics> statistics;
+    {
+        substrait::Partition s;
+        readSubstrait(&s, parameter->table_range_path);
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+    }
+    vector<shared_ptr<Query>> queries;
+    {
+        substrait::Plan p;
+        readSubstrait(&p, parameter->query_path);
+        queries = Query::parseSubstraitQuery(
+            &p, table_schema, statistics, parameter->data_path);
+    }
+
+    // fill the columns referred by any filter
+    std::mt19937_64 random(42);
+    ColumnBatch batch(kRows);
+    unordered_set<string> filled;
+    for (auto q : queries)
+        for (const auto &name : q->getFilter()->getAttributes())
+        {
+            if (!filled.insert(name).second)
+                continue;
+            auto range = statistics->getRange(name);
+            auto type = table_schema->get(name)->getType();
+            Column &c = batch.addColumn(name, type);
+            if (type == DATA_TYPE::DOUBLE)
+            {
+                std::uniform_real_distribution<double> d(
+                    dynamic_cast<const Double *>(range->lower())
+                        ->getValue(),
+                    dynamic_cast<const Double *>(range->upper())
+                        ->getValue());
+                for (auto &v : c.doubles)
+                    v = d(random);
+                continue;
+            }
+            // the bounds by type, the other columns stay zero
+            int64_t lower, upper;
+            auto e = dynamic_cast<const StringEnum *>(range->lower());
+            auto n = dynamic_cast<const Integer *>(range->lower());
+            if (e)
+            {
+                lower = e->getIndex();
+                upper = dynamic_cast<const StringEnum *>(range->upper())
+                            ->getIndex();
+            }
+            else if (n)
+            {
+                lower = n->getValue();
+                upper = dynamic_cast<const Integer *>(range->upper())
+                            ->getValue();
+            }
+            else if (type == DATA_TYPE::BOOLEAN)
+            {
+                lower = 0;
+                upper = 1;
+            }
+            else
+                continue;
+            std::uniform_int_distribution<int64_t> d(lower, upper);
+            for (auto &v : c.ints)
+                v = d(random);
+        }
+
+    printf("query\tinstructions\tselectivity\testimate\tns_per_row\n");
+    for (int i = 0; i < queries.size(); i++)
+    {
+        auto program = PredicateProgram::compile(
+            queries[i]->getFilter(), table_schema);
+        auto start = std::chrono::steady_clock::now();
+        size_t n = program->count(batch);
+        double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+        // the attributes are independent and uniform
+        double estimate = 1;
+        for (const auto &it :
+             queries[i]->getFilterBoundary()->getIntervals())
+        {
+            auto range = statistics->getRange(it.first);
+            double width = range->upper()->distance(range->lower());
+            double covered = 0;
+            for (const auto &interval : it.second)
+                covered +=
+                    interval->upper()->distance(interval->lower());
+            estimate *= covered / width;
+        }
+        printf("q%d\t%d\t%.4f\t%.4f\t%.3f\n", i,
+               program->numOfInstructions(), (double)n / kRows,
+               estimate, ns / kRows);
+    }
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return 0;
+}
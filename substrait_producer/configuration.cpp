@@ -4,45 +4,6 @@
 
 using namespace std;
 
-unordered_map<string, shared_ptr<const DataType>> MinValues;
-unordered_map<string, shared_ptr<const DataType>> MaxValues;
-
-unordered_set<string> getMinMaxAttributes()
-{
-    unordered_set<string> ans;
-    for (auto &s : MinValues)
-        ans.insert(s.first);
-    return ans;
-}
-
-void setMinMax(const string &attribute,
-               shared_ptr<const DataType> min_value,
-               shared_ptr<const DataType> max_value)
-{
-    MinValues[attribute] = min_value;
-    MaxValues[attribute] = max_value;
-}
-
-shared_ptr<const DataType> getMinValue(const string &attribute)
-{
-    auto it = MinValues.find(attribute);
-    if (it == MinValues.end())
-        throw Exception(
-            "getMinValue: Miss the min value of attribute " +
-            attribute);
-    return it->second;
-}
-
-shared_ptr<const DataType> getMaxValue(const string &attribute)
-{
-    auto it = MaxValues.find(attribute);
-    if (it == MaxValues.end())
-        throw Exception(
-            "getMaxValue: Miss the max value of attribute " +
-            attribute);
-    return it->second;
-}
-
 shared_ptr<InputParameter> InputParameter::parameter = nullptr;
 
 shared_ptr<const InputParameter> InputParameter::parse(
@@ -61,10 +22,36 @@ shared_ptr<const InputParameter> InputParameter::parse(
             parameter->table_range_path = argv[idx++];
         else if (op == "--partition_path")
             parameter->partition_path = argv[idx++];
+        else if (op == "--catalog_path")
+            parameter->catalog_path = argv[idx++];
         else if (op == "--query_path")
             parameter->query_path = argv[idx++];
+        else if (op == "--query_log")
+            parameter->query_log_path = argv[idx++];
+        else if (op == "--sample_path")
+            parameter->sample_path = argv[idx++];
         else if (op == "--plan_dir")
             parameter->plan_dir = argv[idx++];
+        else if (op == "--plan_format")
+        {
+            string format = argv[idx++];
+            std::transform(format.begin(), format.end(), format.begin(),
+                           ::tolower);
+            if (format == "binary")
+                parameter->plan_format = PlanFormat::Binary;
+            else if (format == "text")
+                parameter->plan_format = PlanFormat::Text;
+            else if (format == "json")
+                parameter->plan_format = PlanFormat::Json;
+            else
+                throw Exception("Invalid plan_format " + format);
+        }
+        else if (op == "--plan_stream")
+            parameter->plan_stream_path = argv[idx++];
+        else if (op == "--plan_cache")
+            parameter->plan_cache_dir = argv[idx++];
+        else if (op == "--socket")
+            parameter->socket_path = argv[idx++];
         else if (op == "--engine")
         {
             string engine = argv[idx++];
@@ -86,11 +73,26 @@ shared_ptr<const InputParameter> InputParameter::parse(
                 parameter->reconstruct = ReconstructType::Join;
             else if (type == "aggregate")
                 parameter->reconstruct = ReconstructType::Aggregate;
+            else if (type == "merge")
+                parameter->reconstruct = ReconstructType::Merge;
+            else if (type == "positional")
+                parameter->reconstruct = ReconstructType::Positional;
+            else if (type == "auto")
+                parameter->reconstruct = ReconstructType::Auto;
             else
                 throw Exception("Invalid reconstruct-type " + type);
         }
         else if (op == "--parallel-partition")
             parameter->parallel = AggParallelMethod::Partition;
+        else if (op == "--verbose")
+            parameter->verbose = true;
+        else if (op == "--workers")
+        {
+            parameter->workers = std::stoi(argv[idx++]);
+            if (parameter->workers < 1)
+                throw Exception("Invalid workers " +
+                                std::to_string(parameter->workers));
+        }
         else
             throw Exception("Unknow input parameter " + op);
     }
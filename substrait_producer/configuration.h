@@ -1,6 +1,7 @@
 #pragma once
 
 #include "data_type/data_type.h"
+#include "protobuf_io.h"
 #include "substrait/partition.pb.h"
 #include <fstream>
 #include <string>
@@ -19,6 +20,21 @@ enum SET_RELATION
     DISJOINT
 };
 
+/**
+ * @brief Get the relationship of B to A from the relationship of A to B
+ *
+ * @param r
+ * @return SET_RELATION
+ */
+inline SET_RELATION reverseRelationship(SET_RELATION r)
+{
+    if (r == SET_RELATION::SUBSET)
+        return SET_RELATION::SUPERSET;
+    else if (r == SET_RELATION::SUPERSET)
+        return SET_RELATION::SUBSET;
+    return r;
+}
+
 const std::string kUDFURI =
     "file:///home/user/code/hierarchical-partitioning/"
     "substrait_arrow_producer/udf.yaml";
@@ -28,6 +44,9 @@ const std::string kComparisonURI =
 const std::string kBooleanURI =
     "https://github.com/substrait-io/substrait/blob/main/extensions/"
     "functions_boolean.yaml";
+const std::string kStringURI =
+    "https://github.com/substrait-io/substrait/blob/main/extensions/"
+    "functions_string.yaml";
 const std::string kArithmeticURI =
     "https://github.com/substrait-io/substrait/blob/main/extensions/"
     "functions_arithmetic.yaml";
@@ -39,18 +58,9 @@ const string possible_measures_name = "possible_measures";
 const string valid_attribute_name = "valid_attributes";
 const string tuple_id_name = "tid";
 
-void setMinMax(const string &attribute,
-               shared_ptr<const DataType> min_value,
-               shared_ptr<const DataType> max_value);
-shared_ptr<const DataType> getMinValue(const string &attribute);
-shared_ptr<const DataType> getMaxValue(const string &attribute);
-unordered_set<string> getMinMaxAttributes();
-
 template <typename T> void readSubstrait(T *serialized, string path)
 {
-    std::ifstream ifile(path, ios::in | ios::binary);
-    serialized->ParseFromIstream(&ifile);
-    ifile.close();
+    readMessage(serialized, path);
 }
 
 struct InputParameter
@@ -73,7 +83,21 @@ struct InputParameter
     enum ReconstructType
     {
         Join,
-        Aggregate
+        Aggregate,
+        Merge, // the aggregate reconstruction on the input sorted by
+               // the tuple id
+        Positional, // the aggregate reconstruction keyed by the
+                    // position of the tuple id in the tuple ids of
+                    // the blocks
+        Auto // the cheapest of the aggregate, the early, the join and
+             // the merge reconstruction of each query by the cost model
+    };
+
+    enum PlanFormat
+    {
+        Binary,
+        Text,
+        Json
     };
 
     // the path of the data folder. Should be started with \"file://\""
@@ -84,9 +108,32 @@ struct InputParameter
     string table_range_path;
     // the file storing the metadata of partitions
     string partition_path;
+    // the block catalog of the partitions, read instead of
+    // partition_path if set. Optional
+    string catalog_path;
     string query_path;
+    // a log of length-delimited substrait::Plan messages, read one
+    // message at a time instead of query_path if set. Optional
+    string query_log_path;
+    // the row sample of the table to estimate row numbers. Optional
+    string sample_path;
     // the output dir
     string plan_dir;
+    // the format of the plan files in plan_dir
+    PlanFormat plan_format = PlanFormat::Binary;
+    // the file all plans are written to as a stream of length-delimited
+    // messages in the order of the queries, instead of one file per
+    // query in plan_dir. Optional
+    string plan_stream_path;
+    // the number of threads that plan the queries concurrently
+    int workers = 1;
+    // the dir of the plan cache, where the plan of a query is kept
+    // for the same query on the same layout. Optional
+    string plan_cache_dir;
+    // the Unix domain socket of the plan server
+    string socket_path;
+    // print the scan parameters of each query to stdout
+    bool verbose = false;
 
     ReconstructType reconstruct = ReconstructType::Aggregate;
 
@@ -0,0 +1,318 @@
+#pragma once
+#include "configuration.h"
+#include "exceptions.h"
+#include <boost/dynamic_bitset.hpp>
+#include <boost/functional/hash.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief A bitmap of up to capacity bits stored inline in 64-bit
+ * words, e.g. a set of table attributes keyed by their offsets in the
+ * table schema, or the bits of a fixed binary literal. Bit i is bit i %
+ * 64 of word i / 64. The size is the number of bits of the bitmap,
+ * capacity by default; the bits beyond the size are always 0, so the
+ * set algebra, count and comparison work on whole words and compare the
+ * bits only. The serialized bytes are the words in little-endian order,
+ * i.e. bit i is bit i % 8 of byte i / 8, the layout of the fixed binary
+ * literals consumed by the engines.
+ */
+class Bitmap
+{
+  public:
+    static constexpr int capacity = 256;
+    static constexpr int npos = -1;
+
+    Bitmap() : words{}, num_bits(capacity)
+    {
+    }
+
+    explicit Bitmap(size_t size) : words{}, num_bits(0)
+    {
+        resize(size);
+    }
+
+    /**
+     * @brief Convert a boost bitmap of the same size
+     *
+     * @param bits
+     */
+    explicit Bitmap(const boost::dynamic_bitset<> &bits)
+        : words{}, num_bits(0)
+    {
+        resize(bits.size());
+        for (auto i = bits.find_first(); i != bits.npos;
+             i = bits.find_next(i))
+            set(i);
+    }
+
+    size_t size() const
+    {
+        return num_bits;
+    }
+
+    /**
+     * @brief Change the number of bits. The new bits are set to value
+     *
+     * @param size
+     * @param value
+     */
+    void resize(size_t size, bool value = false)
+    {
+        if (size > capacity)
+            throw Exception("Bitmap: the size " + std::to_string(size) +
+                            " exceeds the capacity " +
+                            std::to_string(capacity));
+        if (value)
+            for (size_t i = num_bits; i < size; i++)
+                words[i / kWordBits] |= uint64_t(1) << (i % kWordBits);
+        num_bits = size;
+        clearTail();
+    }
+
+    void set(int offset, bool value = true)
+    {
+        check(offset);
+        if (value)
+            words[offset / kWordBits] |= uint64_t(1)
+                                         << (offset % kWordBits);
+        else
+            words[offset / kWordBits] &=
+                ~(uint64_t(1) << (offset % kWordBits));
+    }
+
+    void reset(int offset)
+    {
+        set(offset, false);
+    }
+
+    // false for an offset beyond the size
+    bool test(int offset) const
+    {
+        if (offset < 0 || offset >= (int)num_bits)
+            return false;
+        return (words[offset / kWordBits] >> (offset % kWordBits)) & 1;
+    }
+
+    bool empty() const
+    {
+        for (int i = 0; i < kWords; i++)
+            if (words[i])
+                return false;
+        return true;
+    }
+
+    bool any() const
+    {
+        return !empty();
+    }
+
+    int count() const
+    {
+        int n = 0;
+        for (int i = 0; i < kWords; i++)
+            n += __builtin_popcountll(words[i]);
+        return n;
+    }
+
+    int findFirst() const
+    {
+        return findFrom(0);
+    }
+
+    int findNext(int offset) const
+    {
+        return findFrom(offset + 1);
+    }
+
+    bool intersects(const Bitmap &other) const
+    {
+        for (int i = 0; i < kWords; i++)
+            if (words[i] & other.words[i])
+                return true;
+        return false;
+    }
+
+    bool isSubsetOf(const Bitmap &other) const
+    {
+        for (int i = 0; i < kWords; i++)
+            if (words[i] & ~other.words[i])
+                return false;
+        return true;
+    }
+
+    /**
+     * @brief Compute the relationship between this set and the other
+     * set. A non-empty set is disjoint with the empty set.
+     *
+     * @param other
+     * @return SET_RELATION
+     */
+    SET_RELATION relationship(const Bitmap &other) const
+    {
+        if (!empty() && !intersects(other))
+            return SET_RELATION::DISJOINT;
+        bool sub = isSubsetOf(other), super = other.isSubsetOf(*this);
+        if (sub && super)
+            return SET_RELATION::EQUAL;
+        else if (super)
+            return SET_RELATION::SUPERSET;
+        else if (sub)
+            return SET_RELATION::SUBSET;
+        else
+            return SET_RELATION::INTERSECT;
+    }
+
+    // the union has the larger size of the two
+    Bitmap &operator|=(const Bitmap &other)
+    {
+        for (int i = 0; i < kWords; i++)
+            words[i] |= other.words[i];
+        num_bits = std::max(num_bits, other.num_bits);
+        return *this;
+    }
+
+    Bitmap &operator&=(const Bitmap &other)
+    {
+        for (int i = 0; i < kWords; i++)
+            words[i] &= other.words[i];
+        return *this;
+    }
+
+    // set difference
+    Bitmap &operator-=(const Bitmap &other)
+    {
+        for (int i = 0; i < kWords; i++)
+            words[i] &= ~other.words[i];
+        return *this;
+    }
+
+    Bitmap operator|(const Bitmap &other) const
+    {
+        Bitmap r(*this);
+        return r |= other;
+    }
+
+    Bitmap operator&(const Bitmap &other) const
+    {
+        Bitmap r(*this);
+        return r &= other;
+    }
+
+    Bitmap operator-(const Bitmap &other) const
+    {
+        Bitmap r(*this);
+        return r -= other;
+    }
+
+    bool operator==(const Bitmap &other) const
+    {
+        for (int i = 0; i < kWords; i++)
+            if (words[i] != other.words[i])
+                return false;
+        return true;
+    }
+
+    bool operator!=(const Bitmap &other) const
+    {
+        return !(*this == other);
+    }
+
+    // compare as unsigned numbers whose bit 0 is the least significant
+    bool operator<(const Bitmap &other) const
+    {
+        for (int i = kWords; i-- > 0;)
+            if (words[i] != other.words[i])
+                return words[i] < other.words[i];
+        return false;
+    }
+
+    /**
+     * @brief Convert to a boost bitmap of the given size
+     *
+     * @param size
+     * @return boost::dynamic_bitset<>
+     */
+    boost::dynamic_bitset<> toBitset(size_t size) const
+    {
+        boost::dynamic_bitset<> bits(size, false);
+        for (int i = findFirst(); i != npos; i = findNext(i))
+        {
+            if (i >= size)
+                throw Exception("Bitmap::toBitset: offset " +
+                                std::to_string(i) +
+                                " exceeds the size " +
+                                std::to_string(size));
+            bits.set(i);
+        }
+        return bits;
+    }
+
+    // the (size + 7) / 8 bytes of the fixed binary literal
+    std::string toBytes() const
+    {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                      "Bitmap::toBytes: expect a little-endian target");
+        std::string bytes((num_bits + 7) / 8, '\0');
+        if (!bytes.empty())
+            memcpy(&bytes[0], words, bytes.size());
+        return bytes;
+    }
+
+    // one '0' or '1' per bit, bit 0 first
+    std::string toString() const
+    {
+        std::string result(num_bits, '0');
+        for (int i = findFirst(); i != npos; i = findNext(i))
+            result[i] = '1';
+        return result;
+    }
+
+    friend size_t hash_value(const Bitmap &bitmap)
+    {
+        size_t seed = 0;
+        boost::hash_range(seed, bitmap.words, bitmap.words + kWords);
+        return seed;
+    }
+
+  private:
+    static constexpr int kWordBits = 64;
+    static constexpr int kWords = capacity / kWordBits;
+    uint64_t words[kWords];
+    size_t num_bits;
+
+    void clearTail()
+    {
+        for (int w = num_bits / kWordBits; w < kWords; w++)
+            if (w == num_bits / kWordBits)
+                words[w] &= ~(~uint64_t(0) << (num_bits % kWordBits));
+            else
+                words[w] = 0;
+    }
+
+    void check(int offset) const
+    {
+        if (offset < 0 || offset >= (int)num_bits)
+            throw Exception("Bitmap: offset " + std::to_string(offset) +
+                            " exceeds the size " +
+                            std::to_string(num_bits));
+    }
+
+    int findFrom(int offset) const
+    {
+        if (offset >= (int)num_bits)
+            return npos;
+        int w = offset / kWordBits;
+        uint64_t word =
+            words[w] & (~uint64_t(0) << (offset % kWordBits));
+        while (true)
+        {
+            if (word)
+                return w * kWordBits + __builtin_ctzll(word);
+            if (++w == kWords)
+                return npos;
+            word = words[w];
+        }
+    }
+};
@@ -68,6 +68,9 @@ DATA_TYPE parseSubstraitType(const substrait::Type *type,
     case kind_case::kBool:
         nullability = type->bool_().nullability() == nullable;
         return DATA_TYPE::BOOLEAN;
+    case kind_case::kString:
+        nullability = type->string().nullability() == nullable;
+        return DATA_TYPE::STRING;
     default:
         throw Exception("parseSubstraitType: Unimplemented data type");
     }
@@ -102,6 +105,9 @@ shared_ptr<DataType> DataType::parseSubstraitLiteral(
     case Literal::kBoolean:
         return make_shared<Boolean>(serialized->boolean());
         break;
+    case Literal::kString:
+        return make_shared<String>(serialized->string());
+        break;
     default:
         throw Exception(
             "DataType::parseSubstraitLiteral: Unimplemented data type");
@@ -55,6 +55,11 @@ class Double : public DataType
         return value * pow(0.1, precision);
     }
 
+    int getPrecision() const
+    {
+        return precision;
+    }
+
     DataType *clone() const
     {
         return new Double(this->getValue(), this->precision);
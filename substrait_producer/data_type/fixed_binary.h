@@ -1,9 +1,8 @@
 #pragma once
 #include "configuration.h"
+#include "data_type/bitmap.h"
 #include "data_type/data_type.h"
 #include "exceptions.h"
-#include <boost/dynamic_bitset.hpp>
-#include <math.h>
 #include <string>
 
 class FixedBinary : public DataType
@@ -11,11 +10,11 @@ class FixedBinary : public DataType
   public:
     FixedBinary(int length)
     {
-        this->value = boost::dynamic_bitset<>(length);
+        this->value = Bitmap(length);
         this->type = DATA_TYPE::FIXEDBINARY;
     }
 
-    FixedBinary(boost::dynamic_bitset<> value)
+    FixedBinary(const Bitmap &value)
     {
         this->value = value;
         this->type = DATA_TYPE::FIXEDBINARY;
@@ -31,29 +30,14 @@ class FixedBinary : public DataType
         this->value.set(offset, false);
     }
 
-    boost::dynamic_bitset<> getValue() const
+    const Bitmap &getValue() const
     {
         return this->value;
     }
 
     string getValueString() const
     {
-        int num = std::ceil(value.size() / 8.0);
-        uint8_t data[num];
-        memset(data, 0, num);
-        auto set_bit = [&](int offset) {
-            data[offset / 8] |= (1 << (offset % 8));
-        };
-        for (int i = 0; i < value.size(); i++)
-        {
-            if (value.test(i))
-                set_bit(i);
-        }
-        const char *c_data = reinterpret_cast<const char *>(data);
-        std::string str;
-        for (int i = 0; i < num; i++)
-            str.push_back(c_data[i]);
-        return str;
+        return value.toBytes();
     }
 
     int cmp(const DataType *other) const
@@ -101,9 +85,7 @@ class FixedBinary : public DataType
 
     DataType *clone() const
     {
-        auto o = new FixedBinary(value.size());
-        o->value = this->value;
-        return o;
+        return new FixedBinary(value);
     }
 
     void makeSubstraitLiteral(
@@ -127,5 +109,5 @@ class FixedBinary : public DataType
     }
 
   private:
-    boost::dynamic_bitset<> value;
+    Bitmap value;
 };
\ No newline at end of file
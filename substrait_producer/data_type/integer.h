@@ -56,6 +56,12 @@ class Integer : public DataType
         return value;
     }
 
+    // the width in bits of the serialized literal
+    int getSize() const
+    {
+        return size;
+    }
+
     void makeSubstraitLiteral(
         substrait::Expression_Literal *mutable_out) const
     {
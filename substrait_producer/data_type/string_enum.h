@@ -2,8 +2,8 @@
 #include "data_type/data_type.h"
 #include "exceptions.h"
 
+#include <algorithm>
 #include <string>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 using namespace std;
@@ -11,41 +11,86 @@ using namespace std;
 class StringEnum : public DataType
 {
   public:
+    /**
+     * @brief A sorted dictionary of the distinct strings of an
+     * attribute. The code of a string is its rank, so comparing codes
+     * is comparing the strings lexicographically and a range or prefix
+     * predicate maps to a range of codes.
+     */
     class StringEnumList
     {
       public:
-        StringEnumList(const unordered_set<string> &allStrings)
+        StringEnumList(vector<string> allStrings)
+            : allStrings(std::move(allStrings))
         {
-            for (auto it = allStrings.begin(); it != allStrings.end();
-                 ++it)
-                this->allStrings.push_back(*it);
+            std::sort(this->allStrings.begin(), this->allStrings.end());
+            this->allStrings.erase(std::unique(this->allStrings.begin(),
+                                               this->allStrings.end()),
+                                   this->allStrings.end());
+        }
 
-            for (int i = 0; i < this->allStrings.size(); i++)
-                indexes.insert({this->allStrings[i], i});
+        StringEnumList(const unordered_set<string> &allStrings)
+            : StringEnumList(
+                  vector<string>(allStrings.begin(), allStrings.end()))
+        {
         }
+
+        // the code of the string, or -1 if it is not in the dictionary
         inline int indexOf(const string &str) const;
+
+        // the code of the first string that is not less than str
+        int lowerBound(const string &str) const
+        {
+            return std::lower_bound(allStrings.begin(),
+                                    allStrings.end(), str) -
+                   allStrings.begin();
+        }
+
+        // the code of the first string that is greater than str
+        int upperBound(const string &str) const
+        {
+            return std::upper_bound(allStrings.begin(),
+                                    allStrings.end(), str) -
+                   allStrings.begin();
+        }
+
+        /**
+         * @brief Get the codes of the strings that start with the
+         * prefix
+         *
+         * @param prefix
+         * @return pair<int, int> the closed range [first, last] of
+         * codes. first > last if no string has the prefix
+         */
+        inline pair<int, int> prefixRange(const string &prefix) const;
+
         int size() const
         {
             return allStrings.size();
         }
-        string get(int index) const
+        const string &get(int index) const
         {
             return allStrings[index];
         }
 
       private:
         vector<string> allStrings;
-        unordered_map<string, int> indexes;
     };
 
-    StringEnum(StringEnumList *allStrings)
+    StringEnum(const StringEnumList *allStrings)
+        : StringEnum(-1, allStrings)
+    {
+    }
+
+    StringEnum(int index, const StringEnumList *allStrings)
     {
         this->allStrings = allStrings;
-        this->index = -1;
+        this->index = index;
         this->type = DATA_TYPE::STRINGENUM;
     }
 
-    StringEnum(const std::string &value, StringEnumList *allStrings)
+    StringEnum(const std::string &value,
+               const StringEnumList *allStrings)
     {
         this->allStrings = allStrings;
         this->index = allStrings->indexOf(value);
@@ -77,7 +122,7 @@ class StringEnum : public DataType
 
     string toString() const
     {
-        return "string_enum(" + this->toString() + ")";
+        return "string_enum(" + this->getValue() + ")";
     }
 
     DataType *clone() const
@@ -92,6 +137,16 @@ class StringEnum : public DataType
         return allStrings->get(index);
     }
 
+    int getIndex() const
+    {
+        return index;
+    }
+
+    const StringEnumList *getList() const
+    {
+        return allStrings;
+    }
+
     void makeSubstraitLiteral(
         substrait::Expression_Literal *mutable_out) const
     {
@@ -102,15 +157,31 @@ class StringEnum : public DataType
     inline void checkType(const DataType *other) const;
 
   private:
-    StringEnumList *allStrings;
+    const StringEnumList *allStrings;
     int index;
 };
 
 int StringEnum::StringEnumList::indexOf(const string &str) const
 {
-    if (indexes.find(str) == indexes.end())
+    int i = lowerBound(str);
+    if (i == allStrings.size() || allStrings[i] != str)
         return -1;
-    return indexes.at(str);
+    return i;
+}
+
+pair<int, int> StringEnum::StringEnumList::prefixRange(
+    const string &prefix) const
+{
+    // the strings with the prefix are the first strings that are not
+    // less than the prefix
+    auto first =
+        std::lower_bound(allStrings.begin(), allStrings.end(), prefix);
+    auto last = std::partition_point(
+        first, allStrings.end(), [&prefix](const string &s) {
+            return s.compare(0, prefix.size(), prefix) == 0;
+        });
+    return make_pair(int(first - allStrings.begin()),
+                     int(last - allStrings.begin()) - 1);
 }
 
 void StringEnum::checkType(const DataType *other) const
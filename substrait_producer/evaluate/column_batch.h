@@ -0,0 +1,87 @@
+#pragma once
+
+#include "data_type/data_type.h"
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief A column of a ColumnBatch. Integers, booleans and the codes of
+ * string attributes with a dictionary are stored in ints, doubles in
+ * doubles, and fixed binaries (e.g. the passed predicate bitmaps) as
+ * words_per_row words per row in bits. valid is empty if the column
+ * has no null; otherwise a row is null when its byte is 0.
+ */
+struct Column
+{
+    DATA_TYPE type;
+    vector<int64_t> ints;
+    vector<double> doubles;
+    vector<uint64_t> bits;
+    int words_per_row = 0;
+    vector<uint8_t> valid;
+
+    bool isNull(size_t row) const
+    {
+        return !valid.empty() && valid[row] == 0;
+    }
+};
+
+/**
+ * @brief A set of named columns of the same length, the input of a
+ * PredicateProgram
+ */
+class ColumnBatch
+{
+  public:
+    explicit ColumnBatch(size_t num_rows) : num_rows(num_rows)
+    {
+    }
+
+    size_t numOfRows() const
+    {
+        return num_rows;
+    }
+
+    /**
+     * @brief Add a column of num_rows zero values without null
+     *
+     * @param name
+     * @param type
+     * @param bits_per_row the width of a FIXEDBINARY column
+     * @return Column& the column to fill
+     */
+    Column &addColumn(const string &name, DATA_TYPE type,
+                      int bits_per_row = 0)
+    {
+        if (columns.count(name))
+            throw Exception(
+                "ColumnBatch::addColumn: duplicate column " + name);
+        Column &c = columns[name];
+        c.type = type;
+        if (type == DATA_TYPE::DOUBLE)
+            c.doubles.resize(num_rows, 0);
+        else if (type == DATA_TYPE::FIXEDBINARY)
+        {
+            c.words_per_row = (bits_per_row + 63) / 64;
+            c.bits.resize(num_rows * c.words_per_row, 0);
+        }
+        else
+            c.ints.resize(num_rows, 0);
+        return c;
+    }
+
+    // nullptr if the batch does not have the column
+    const Column *getColumn(const string &name) const
+    {
+        auto it = columns.find(name);
+        return it == columns.end() ? nullptr : &it->second;
+    }
+
+  private:
+    size_t num_rows;
+    unordered_map<string, Column> columns;
+};
@@ -0,0 +1,909 @@
+#include "evaluate/predicate_program.h"
+#include "data_type/data_type_api.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// the rows evaluated by one pass over the instructions. The registers
+// of a chunk stay in the cache
+constexpr size_t kChunkRows = 1024;
+
+constexpr int64_t kIntMin = std::numeric_limits<int64_t>::min();
+constexpr int64_t kIntMax = std::numeric_limits<int64_t>::max();
+constexpr double kInf = std::numeric_limits<double>::infinity();
+// 2^63, the first double above the range of int64
+constexpr double kTwo63 = 9223372036854775808.0;
+
+const unordered_map<string, string> flipped_comparisons = {
+    {"equal", "equal"},
+    {"gt", "lt"},
+    {"gte", "lte"},
+    {"lt", "gt"},
+    {"lte", "gte"}};
+
+// a closed range of values on one column
+struct Range
+{
+    int column;
+    bool is_double;
+    int64_t lower, upper;
+    double double_lower, double_upper;
+
+    void intersect(const Range &other)
+    {
+        lower = std::max(lower, other.lower);
+        upper = std::min(upper, other.upper);
+        double_lower = std::max(double_lower, other.double_lower);
+        double_upper = std::min(double_upper, other.double_upper);
+    }
+};
+
+// an integral double converted to int64, saturating outside its range
+// where the conversion is undefined
+int64_t clampToInt(double v)
+{
+    if (v >= kTwo63)
+        return kIntMax;
+    if (v <= -kTwo63)
+        return kIntMin;
+    return (int64_t)v;
+}
+
+// the identity operand that connectExpression appends to a chain
+bool isIdentity(const Expression &e, bool conjunctive)
+{
+    auto l = dynamic_cast<const Literal *>(&e);
+    if (l == nullptr || l->getType() != DATA_TYPE::BOOLEAN)
+        return false;
+    return dynamic_pointer_cast<const Boolean>(l->getValue())
+               ->getValue() == conjunctive;
+}
+
+void collectConjuncts(const Expression &e,
+                      vector<const Expression *> &conjuncts)
+{
+    auto f = dynamic_cast<const FunctionExpression *>(&e);
+    if (f && f->getFunction() == "and")
+    {
+        for (const auto &c : e.getChildren())
+            collectConjuncts(*c, conjuncts);
+        return;
+    }
+    if (!isIdentity(e, true))
+        conjuncts.push_back(&e);
+}
+}; // namespace
+
+class PredicateProgram::Compiler
+{
+  public:
+    Compiler(PredicateProgram &program,
+             shared_ptr<const Schema> table_schema)
+        : program(program), table_schema(table_schema)
+    {
+    }
+
+    struct Operand
+    {
+        int reg;
+        RegisterKind kind;
+    };
+
+    Operand compile(const Expression &e)
+    {
+        if (auto l = dynamic_cast<const Literal *>(&e))
+            return compileLiteral(*l);
+        if (auto a = dynamic_cast<const Attribute *>(&e))
+            return compileAttribute(*a);
+        auto f = dynamic_cast<const FunctionExpression *>(&e);
+        if (f == nullptr)
+            throw Exception("PredicateProgram::compile: unsupported "
+                            "expression " +
+                            e.toString());
+
+        string op = f->getFunction();
+        auto children = f->getChildren();
+        if (op == "and")
+            return compileConjunction(*f);
+        if (op == "or")
+        {
+            int acc = -1;
+            for (const auto &c : children)
+            {
+                if (isIdentity(*c, false))
+                    continue;
+                int r = toBool(compile(*c));
+                if (acc < 0)
+                    acc = r;
+                else
+                    emit(OR, acc, {acc, r});
+            }
+            if (acc < 0)
+                return constBool(false);
+            return {acc, BOOL_REGISTER};
+        }
+        if (op == "not")
+        {
+            expectChildren(*f, 1);
+            int r = toBool(compile(*children[0]));
+            int dst = newRegister(BOOL_REGISTER);
+            emit(NOT, dst, {r});
+            return {dst, BOOL_REGISTER};
+        }
+        if (op == "is_null" || op == "is_not_null")
+        {
+            expectChildren(*f, 1);
+            auto a = dynamic_cast<const Attribute *>(children[0].get());
+            if (a == nullptr)
+                throw Exception("PredicateProgram::compile: " + op +
+                                " expects an attribute but got " +
+                                e.toString());
+            int dst = newRegister(BOOL_REGISTER);
+            Instruction &ins =
+                emit(op == "is_null" ? IS_NULL : IS_NOT_NULL, dst, {});
+            ins.column = columnIndex(a->getName());
+            return {dst, BOOL_REGISTER};
+        }
+        if (op == "bitmap_get")
+            return compileBitmapGet(*f);
+        if (flipped_comparisons.count(op) || op == "starts_with")
+            return compileComparison(*f);
+        if (op == "add" || op == "subtract" || op == "multiply" ||
+            op == "divide")
+            return compileArithmetic(*f);
+        if (op == "if_then_else")
+            return compileIf(*f);
+        throw Exception("PredicateProgram::compile: unsupported "
+                        "function " +
+                        op);
+    }
+
+    int toBool(Operand o)
+    {
+        if (o.kind == BOOL_REGISTER)
+            return o.reg;
+        if (o.kind == DOUBLE_REGISTER)
+            throw Exception("PredicateProgram::compile: expect a "
+                            "boolean operand");
+        int dst = newRegister(BOOL_REGISTER);
+        emit(TO_BOOL, dst, {o.reg});
+        return dst;
+    }
+
+  private:
+    PredicateProgram &program;
+    shared_ptr<const Schema> table_schema;
+
+    int newRegister(RegisterKind kind)
+    {
+        program.registers.push_back(kind);
+        program.slots.push_back(program.num_slots[kind]++);
+        return program.registers.size() - 1;
+    }
+
+    Instruction &emit(OpCode op, int dst, const vector<int> &src)
+    {
+        Instruction ins;
+        ins.op = op;
+        ins.dst = dst;
+        for (int i = 0; i < src.size(); i++)
+            ins.src[i] = src[i];
+        program.code.push_back(ins);
+        return program.code.back();
+    }
+
+    int columnIndex(const string &name)
+    {
+        auto &columns = program.columns;
+        auto it = std::find(columns.begin(), columns.end(), name);
+        if (it != columns.end())
+            return it - columns.begin();
+        columns.push_back(name);
+        return columns.size() - 1;
+    }
+
+    void expectChildren(const FunctionExpression &f, int n)
+    {
+        if (f.getChildren().size() != n)
+            throw Exception("PredicateProgram::compile: expect " +
+                            std::to_string(n) + " operands but got " +
+                            f.toString());
+    }
+
+    shared_ptr<const StringEnum::StringEnumList> dictionaryOf(
+        const Attribute &a)
+    {
+        if (a.getDictionary())
+            return a.getDictionary();
+        if (table_schema && table_schema->getOffset(a.getName()) >= 0)
+            return table_schema->get(a.getName())->getDictionary();
+        return nullptr;
+    }
+
+    Operand constBool(bool value)
+    {
+        int dst = newRegister(BOOL_REGISTER);
+        emit(CONST_BOOL, dst, {}).int_imm[0] = value;
+        return {dst, BOOL_REGISTER};
+    }
+
+    Operand compileLiteral(const Literal &l)
+    {
+        auto v = l.getValue().get();
+        switch (v->getType())
+        {
+        case DATA_TYPE::BOOLEAN:
+            return constBool(
+                dynamic_cast<const Boolean *>(v)->getValue());
+        case DATA_TYPE::INTEGER:
+        case DATA_TYPE::STRINGENUM:
+        {
+            int dst = newRegister(INT_REGISTER);
+            emit(CONST_INT, dst, {}).int_imm[0] = intValue(*v);
+            return {dst, INT_REGISTER};
+        }
+        case DATA_TYPE::DOUBLE:
+        {
+            int dst = newRegister(DOUBLE_REGISTER);
+            emit(CONST_DOUBLE, dst, {}).double_imm[0] =
+                dynamic_cast<const Double *>(v)->getValue();
+            return {dst, DOUBLE_REGISTER};
+        }
+        default:
+            throw Exception("PredicateProgram::compile: unsupported "
+                            "literal " +
+                            l.toString());
+        }
+    }
+
+    static int64_t intValue(const DataType &v)
+    {
+        if (v.getType() == DATA_TYPE::INTEGER)
+            return dynamic_cast<const Integer &>(v).getValue();
+        return dynamic_cast<const StringEnum &>(v).getIndex();
+    }
+
+    Operand compileAttribute(const Attribute &a)
+    {
+        DATA_TYPE type = a.getType();
+        if (type == DATA_TYPE::FIXEDBINARY ||
+            (type == DATA_TYPE::STRING && !dictionaryOf(a)))
+            throw Exception("PredicateProgram::compile: cannot load "
+                            "attribute " +
+                            a.getName());
+        bool is_double = type == DATA_TYPE::DOUBLE;
+        int dst =
+            newRegister(is_double ? DOUBLE_REGISTER : INT_REGISTER);
+        emit(is_double ? LOAD_DOUBLE : LOAD_INT, dst, {}).column =
+            columnIndex(a.getName());
+        return {dst, is_double ? DOUBLE_REGISTER : INT_REGISTER};
+    }
+
+    Operand compileBitmapGet(const FunctionExpression &f)
+    {
+        expectChildren(f, 2);
+        auto children = f.getChildren();
+        auto a = dynamic_cast<const Attribute *>(children[0].get());
+        auto l = dynamic_cast<const Literal *>(children[1].get());
+        if (a == nullptr || l == nullptr ||
+            l->getType() != DATA_TYPE::INTEGER)
+            throw Exception("PredicateProgram::compile: expect "
+                            "bitmap_get(attribute, offset) but got " +
+                            f.toString());
+        int dst = newRegister(BOOL_REGISTER);
+        Instruction &ins = emit(BITMAP_GET, dst, {});
+        ins.column = columnIndex(a->getName());
+        ins.int_imm[0] = intValue(*l->getValue());
+        return {dst, BOOL_REGISTER};
+    }
+
+    /**
+     * @brief Map "attribute op literal" to a range on the column
+     *
+     * @param f
+     * @param range OUTPUT
+     * @return false if f is not a comparison between an attribute and
+     * a literal of a supported type
+     */
+    bool toRange(const FunctionExpression &f, Range &range)
+    {
+        auto children = f.getChildren();
+        string op = f.getFunction();
+        if (children.size() != 2 ||
+            (!flipped_comparisons.count(op) && op != "starts_with"))
+            return false;
+        auto a = dynamic_cast<const Attribute *>(children[0].get());
+        auto l = dynamic_cast<const Literal *>(children[1].get());
+        if (a == nullptr)
+        {
+            // literal op attribute
+            if (op == "starts_with")
+                return false;
+            a = dynamic_cast<const Attribute *>(children[1].get());
+            l = dynamic_cast<const Literal *>(children[0].get());
+            op = flipped_comparisons.at(op);
+        }
+        if (a == nullptr || l == nullptr)
+            return false;
+
+        auto value = l->getValue().get();
+        auto dictionary = dictionaryOf(*a);
+        range = {-1, false, kIntMin, kIntMax, -kInf, kInf};
+        if (a->getType() == DATA_TYPE::DOUBLE)
+        {
+            if (op == "starts_with" ||
+                (value->getType() != DATA_TYPE::DOUBLE &&
+                 value->getType() != DATA_TYPE::INTEGER))
+                return false;
+            double v = value->getType() == DATA_TYPE::DOUBLE
+                           ? dynamic_cast<const Double *>(value)
+                                 ->getValue()
+                           : intValue(*value);
+            range.is_double = true;
+            if (op == "equal" || op == "gte" || op == "gt")
+                range.double_lower =
+                    op == "gt" ? std::nextafter(v, kInf) : v;
+            if (op == "equal" || op == "lte" || op == "lt")
+                range.double_upper =
+                    op == "lt" ? std::nextafter(v, -kInf) : v;
+        }
+        else if (dictionary && value->getType() == DATA_TYPE::STRING)
+        {
+            // compare the codes, see Query::produceFilterBoundary
+            string s = dynamic_cast<const String *>(value)->getValue();
+            if (op == "equal")
+            {
+                range.lower = dictionary->lowerBound(s);
+                range.upper = dictionary->upperBound(s) - 1;
+            }
+            else if (op == "gt")
+                range.lower = dictionary->upperBound(s);
+            else if (op == "gte")
+                range.lower = dictionary->lowerBound(s);
+            else if (op == "lt")
+                range.upper = dictionary->lowerBound(s) - 1;
+            else if (op == "lte")
+                range.upper = dictionary->upperBound(s) - 1;
+            else
+            {
+                auto prefix = dictionary->prefixRange(s);
+                range.lower = prefix.first;
+                range.upper = prefix.second;
+            }
+        }
+        else if (a->getType() != DATA_TYPE::FIXEDBINARY &&
+                 a->getType() != DATA_TYPE::STRING &&
+                 op != "starts_with")
+        {
+            int64_t lower, upper;
+            bool has_lower = op == "equal" || op == "gt" || op == "gte";
+            bool has_upper = op == "equal" || op == "lt" || op == "lte";
+            // no integer passes the comparison
+            bool empty = false;
+            if (value->getType() == DATA_TYPE::DOUBLE)
+            {
+                // the integers in the range of the double
+                double v =
+                    dynamic_cast<const Double *>(value)->getValue();
+                double l =
+                    op == "gt" ? std::floor(v) + 1 : std::ceil(v);
+                double u =
+                    op == "lt" ? std::ceil(v) - 1 : std::floor(v);
+                empty = std::isnan(v) || (has_lower && l >= kTwo63) ||
+                        (has_upper && u < -kTwo63);
+                lower = empty ? 0 : clampToInt(l);
+                upper = empty ? 0 : clampToInt(u);
+            }
+            else if (value->getType() == DATA_TYPE::INTEGER ||
+                     value->getType() == DATA_TYPE::STRINGENUM)
+            {
+                int64_t v = intValue(*value);
+                empty = (op == "gt" && v == kIntMax) ||
+                        (op == "lt" && v == kIntMin);
+                lower = op == "gt" && !empty ? v + 1 : v;
+                upper = op == "lt" && !empty ? v - 1 : v;
+            }
+            else if (value->getType() == DATA_TYPE::BOOLEAN)
+                lower = upper =
+                    dynamic_cast<const Boolean *>(value)->getValue();
+            else
+                return false;
+            if (has_lower)
+                range.lower = lower;
+            if (has_upper)
+                range.upper = upper;
+            if (empty)
+            {
+                range.lower = kIntMax;
+                range.upper = kIntMin;
+            }
+        }
+        else
+            return false;
+        range.column = columnIndex(a->getName());
+        return true;
+    }
+
+    void emitRange(const Range &range, int dst, bool in_place)
+    {
+        OpCode op;
+        if (range.is_double)
+            op = in_place ? AND_RANGE_DOUBLE : RANGE_DOUBLE;
+        else
+            op = in_place ? AND_RANGE_INT : RANGE_INT;
+        Instruction &ins = emit(op, dst, {});
+        ins.column = range.column;
+        ins.int_imm[0] = range.lower;
+        ins.int_imm[1] = range.upper;
+        ins.double_imm[0] = range.double_lower;
+        ins.double_imm[1] = range.double_upper;
+    }
+
+    Operand compileConjunction(const FunctionExpression &f)
+    {
+        vector<const Expression *> conjuncts;
+        collectConjuncts(f, conjuncts);
+
+        // merge the ranges on the same column, in the order of their
+        // first appearance
+        vector<Range> ranges;
+        vector<const Expression *> others;
+        for (auto c : conjuncts)
+        {
+            auto cf = dynamic_cast<const FunctionExpression *>(c);
+            Range r;
+            if (cf == nullptr || !toRange(*cf, r))
+            {
+                others.push_back(c);
+                continue;
+            }
+            auto it = std::find_if(ranges.begin(), ranges.end(),
+                                   [&](const Range &x) {
+                                       return x.column == r.column &&
+                                              x.is_double ==
+                                                  r.is_double;
+                                   });
+            if (it == ranges.end())
+                ranges.push_back(r);
+            else
+                it->intersect(r);
+        }
+
+        int acc = -1;
+        for (const auto &r : ranges)
+        {
+            bool in_place = acc >= 0;
+            if (!in_place)
+                acc = newRegister(BOOL_REGISTER);
+            emitRange(r, acc, in_place);
+        }
+        for (auto c : others)
+        {
+            int r = toBool(compile(*c));
+            if (acc < 0)
+                acc = r;
+            else
+                emit(AND, acc, {acc, r});
+        }
+        if (acc < 0)
+            return constBool(true);
+        return {acc, BOOL_REGISTER};
+    }
+
+    Operand toDouble(Operand o)
+    {
+        if (o.kind == DOUBLE_REGISTER)
+            return o;
+        int dst = newRegister(DOUBLE_REGISTER);
+        emit(CAST_DOUBLE, dst, {o.reg});
+        return {dst, DOUBLE_REGISTER};
+    }
+
+    Operand compileComparison(const FunctionExpression &f)
+    {
+        Range range;
+        if (toRange(f, range))
+        {
+            int dst = newRegister(BOOL_REGISTER);
+            emitRange(range, dst, false);
+            return {dst, BOOL_REGISTER};
+        }
+        if (f.getFunction() == "starts_with")
+            throw Exception("PredicateProgram::compile: starts_with "
+                            "needs an attribute with a dictionary: " +
+                            f.toString());
+        expectChildren(f, 2);
+        auto children = f.getChildren();
+        Operand left = compile(*children[0]);
+        Operand right = compile(*children[1]);
+        string op = f.getFunction();
+        if (op == "gt" || op == "gte")
+        {
+            // a > b is b < a
+            std::swap(left, right);
+            op = flipped_comparisons.at(op);
+        }
+        bool is_double = left.kind == DOUBLE_REGISTER ||
+                         right.kind == DOUBLE_REGISTER;
+        if (is_double)
+        {
+            left = toDouble(left);
+            right = toDouble(right);
+        }
+        OpCode code;
+        if (op == "equal")
+            code = is_double ? EQ_DOUBLE : EQ_INT;
+        else if (op == "lt")
+            code = is_double ? LT_DOUBLE : LT_INT;
+        else
+            code = is_double ? LE_DOUBLE : LE_INT;
+        int dst = newRegister(BOOL_REGISTER);
+        emit(code, dst, {left.reg, right.reg});
+        return {dst, BOOL_REGISTER};
+    }
+
+    Operand compileArithmetic(const FunctionExpression &f)
+    {
+        expectChildren(f, 2);
+        auto children = f.getChildren();
+        Operand left = compile(*children[0]);
+        Operand right = compile(*children[1]);
+        bool is_double = left.kind == DOUBLE_REGISTER ||
+                         right.kind == DOUBLE_REGISTER;
+        if (is_double)
+        {
+            left = toDouble(left);
+            right = toDouble(right);
+        }
+        string op = f.getFunction();
+        OpCode code;
+        if (op == "add")
+            code = is_double ? ADD_DOUBLE : ADD_INT;
+        else if (op == "subtract")
+            code = is_double ? SUB_DOUBLE : SUB_INT;
+        else if (op == "multiply")
+            code = is_double ? MUL_DOUBLE : MUL_INT;
+        else
+            code = is_double ? DIV_DOUBLE : DIV_INT;
+        RegisterKind kind = is_double ? DOUBLE_REGISTER : INT_REGISTER;
+        int dst = newRegister(kind);
+        emit(code, dst, {left.reg, right.reg});
+        return {dst, kind};
+    }
+
+    Operand compileIf(const FunctionExpression &f)
+    {
+        expectChildren(f, 3);
+        auto children = f.getChildren();
+        int condition = toBool(compile(*children[0]));
+        Operand then_value = compile(*children[1]);
+        Operand else_value = compile(*children[2]);
+        if (then_value.kind != else_value.kind)
+        {
+            if (then_value.kind == BOOL_REGISTER ||
+                else_value.kind == BOOL_REGISTER)
+                throw Exception("PredicateProgram::compile: clauses "
+                                "must have the same type in " +
+                                f.toString());
+            then_value = toDouble(then_value);
+            else_value = toDouble(else_value);
+        }
+        OpCode code = then_value.kind == INT_REGISTER ? SELECT_INT
+                      : then_value.kind == DOUBLE_REGISTER
+                          ? SELECT_DOUBLE
+                          : SELECT_BOOL;
+        int dst = newRegister(then_value.kind);
+        emit(code, dst, {condition, then_value.reg, else_value.reg});
+        return {dst, then_value.kind};
+    }
+};
+
+shared_ptr<const PredicateProgram> PredicateProgram::compile(
+    shared_ptr<const Expression> predicate,
+    shared_ptr<const Schema> table_schema)
+{
+    auto program = make_shared<PredicateProgram>();
+    Compiler compiler(*program, table_schema);
+    program->result = compiler.toBool(compiler.compile(*predicate));
+    return program;
+}
+
+void PredicateProgram::execute(const Instruction &ins,
+                               const vector<const Column *> &bound,
+                               size_t begin, size_t n, int64_t *ints,
+                               double *doubles, uint8_t *bools) const
+{
+    auto reg_int = [&](int r) {
+        return ints + (size_t)slots[r] * kChunkRows;
+    };
+    auto reg_double = [&](int r) {
+        return doubles + (size_t)slots[r] * kChunkRows;
+    };
+    auto reg_bool = [&](int r) {
+        return bools + (size_t)slots[r] * kChunkRows;
+    };
+    const Column *column =
+        ins.column >= 0 ? bound[ins.column] : nullptr;
+
+// apply a binary operator to two registers
+#define BINARY(dst_reg, src_reg, expr)                                 \
+    {                                                                  \
+        auto d = dst_reg(ins.dst);                                     \
+        auto a = src_reg(ins.src[0]);                                  \
+        auto b = src_reg(ins.src[1]);                                  \
+        for (size_t i = 0; i < n; i++)                                 \
+            d[i] = (expr);                                             \
+        break;                                                         \
+    }
+
+    switch (ins.op)
+    {
+    case LOAD_INT:
+        std::copy_n(column->ints.data() + begin, n, reg_int(ins.dst));
+        break;
+    case LOAD_DOUBLE:
+        std::copy_n(column->doubles.data() + begin, n,
+                    reg_double(ins.dst));
+        break;
+    case CONST_INT:
+        std::fill_n(reg_int(ins.dst), n, ins.int_imm[0]);
+        break;
+    case CONST_DOUBLE:
+        std::fill_n(reg_double(ins.dst), n, ins.double_imm[0]);
+        break;
+    case CONST_BOOL:
+        std::fill_n(reg_bool(ins.dst), n, (uint8_t)ins.int_imm[0]);
+        break;
+    case CAST_DOUBLE:
+    {
+        auto d = reg_double(ins.dst);
+        auto a = reg_int(ins.src[0]);
+        for (size_t i = 0; i < n; i++)
+            d[i] = a[i];
+        break;
+    }
+    case TO_BOOL:
+    {
+        auto d = reg_bool(ins.dst);
+        auto a = reg_int(ins.src[0]);
+        for (size_t i = 0; i < n; i++)
+            d[i] = a[i] != 0;
+        break;
+    }
+    case EQ_INT:
+        BINARY(reg_bool, reg_int, a[i] == b[i])
+    case LT_INT:
+        BINARY(reg_bool, reg_int, a[i] < b[i])
+    case LE_INT:
+        BINARY(reg_bool, reg_int, a[i] <= b[i])
+    case EQ_DOUBLE:
+        BINARY(reg_bool, reg_double, a[i] == b[i])
+    case LT_DOUBLE:
+        BINARY(reg_bool, reg_double, a[i] < b[i])
+    case LE_DOUBLE:
+        BINARY(reg_bool, reg_double, a[i] <= b[i])
+    case RANGE_INT:
+    case AND_RANGE_INT:
+    {
+        auto d = reg_bool(ins.dst);
+        const int64_t *v = column->ints.data() + begin;
+        // unsigned arithmetic turns the two comparisons into one
+        uint64_t lower = ins.int_imm[0];
+        uint64_t width = (uint64_t)ins.int_imm[1] - lower;
+        if (ins.int_imm[0] > ins.int_imm[1])
+            std::fill_n(d, n, 0);
+        else if (ins.op == RANGE_INT)
+            for (size_t i = 0; i < n; i++)
+                d[i] = (uint64_t)v[i] - lower <= width;
+        else
+            for (size_t i = 0; i < n; i++)
+                d[i] &= (uint64_t)v[i] - lower <= width;
+        break;
+    }
+    case RANGE_DOUBLE:
+    case AND_RANGE_DOUBLE:
+    {
+        auto d = reg_bool(ins.dst);
+        const double *v = column->doubles.data() + begin;
+        double lower = ins.double_imm[0], upper = ins.double_imm[1];
+        if (ins.op == RANGE_DOUBLE)
+            for (size_t i = 0; i < n; i++)
+                d[i] = (v[i] >= lower) & (v[i] <= upper);
+        else
+            for (size_t i = 0; i < n; i++)
+                d[i] &= (v[i] >= lower) & (v[i] <= upper);
+        break;
+    }
+    case AND:
+        BINARY(reg_bool, reg_bool, a[i] & b[i])
+    case OR:
+        BINARY(reg_bool, reg_bool, a[i] | b[i])
+    case NOT:
+    {
+        auto d = reg_bool(ins.dst);
+        auto a = reg_bool(ins.src[0]);
+        for (size_t i = 0; i < n; i++)
+            d[i] = !a[i];
+        break;
+    }
+    case IS_NULL:
+    case IS_NOT_NULL:
+    {
+        auto d = reg_bool(ins.dst);
+        uint8_t is_null = ins.op == IS_NULL;
+        if (column->valid.empty())
+            std::fill_n(d, n, !is_null);
+        else
+            for (size_t i = 0; i < n; i++)
+                d[i] = (column->valid[begin + i] == 0) == is_null;
+        break;
+    }
+    case BITMAP_GET:
+    {
+        auto d = reg_bool(ins.dst);
+        int64_t bit = ins.int_imm[0];
+        if (bit < 0 || bit >= (int64_t)column->words_per_row * 64)
+            throw Exception("PredicateProgram: bitmap_get offset " +
+                            std::to_string(bit) + " out of range");
+        const uint64_t *w = column->bits.data() +
+                            begin * column->words_per_row + bit / 64;
+        for (size_t i = 0; i < n; i++)
+            d[i] = (w[i * column->words_per_row] >> (bit % 64)) & 1;
+        break;
+    }
+    case ADD_INT:
+        BINARY(reg_int, reg_int, a[i] + b[i])
+    case SUB_INT:
+        BINARY(reg_int, reg_int, a[i] - b[i])
+    case MUL_INT:
+        BINARY(reg_int, reg_int, a[i] * b[i])
+    case DIV_INT:
+        BINARY(reg_int, reg_int, b[i] == 0 ? 0 : a[i] / b[i])
+    case ADD_DOUBLE:
+        BINARY(reg_double, reg_double, a[i] + b[i])
+    case SUB_DOUBLE:
+        BINARY(reg_double, reg_double, a[i] - b[i])
+    case MUL_DOUBLE:
+        BINARY(reg_double, reg_double, a[i] * b[i])
+    case DIV_DOUBLE:
+        BINARY(reg_double, reg_double, a[i] / b[i])
+    case SELECT_INT:
+    case SELECT_DOUBLE:
+    case SELECT_BOOL:
+    {
+        auto c = reg_bool(ins.src[0]);
+        auto select = [&](auto d, auto a, auto b) {
+            for (size_t i = 0; i < n; i++)
+                d[i] = c[i] ? a[i] : b[i];
+        };
+        if (ins.op == SELECT_INT)
+            select(reg_int(ins.dst), reg_int(ins.src[1]),
+                   reg_int(ins.src[2]));
+        else if (ins.op == SELECT_DOUBLE)
+            select(reg_double(ins.dst), reg_double(ins.src[1]),
+                   reg_double(ins.src[2]));
+        else
+            select(reg_bool(ins.dst), reg_bool(ins.src[1]),
+                   reg_bool(ins.src[2]));
+        break;
+    }
+    }
+#undef BINARY
+}
+
+void PredicateProgram::run(
+    const ColumnBatch &batch,
+    const std::function<void(size_t, size_t, const uint8_t *)> &consume)
+    const
+{
+    vector<const Column *> bound;
+    for (const auto &name : columns)
+    {
+        auto c = batch.getColumn(name);
+        if (c == nullptr)
+            throw Exception("PredicateProgram::evaluate: the batch "
+                            "misses column " +
+                            name);
+        bound.push_back(c);
+    }
+    for (const auto &ins : code)
+    {
+        // the null tests read any column
+        if (ins.column < 0 || ins.op == IS_NULL ||
+            ins.op == IS_NOT_NULL)
+            continue;
+        const Column *c = bound[ins.column];
+        bool type_matches;
+        if (ins.op == BITMAP_GET)
+            type_matches = c->type == DATA_TYPE::FIXEDBINARY;
+        else if (ins.op == LOAD_DOUBLE || ins.op == RANGE_DOUBLE ||
+                 ins.op == AND_RANGE_DOUBLE)
+            type_matches = c->type == DATA_TYPE::DOUBLE;
+        else
+            type_matches = c->type != DATA_TYPE::DOUBLE &&
+                           c->type != DATA_TYPE::FIXEDBINARY;
+        if (!type_matches)
+            throw Exception("PredicateProgram::evaluate: column " +
+                            columns[ins.column] +
+                            " has a different type");
+    }
+
+    vector<int64_t> ints(num_slots[INT_REGISTER] * kChunkRows);
+    vector<double> doubles(num_slots[DOUBLE_REGISTER] * kChunkRows);
+    vector<uint8_t> bools(num_slots[BOOL_REGISTER] * kChunkRows);
+    const uint8_t *out =
+        bools.data() + (size_t)slots[result] * kChunkRows;
+    size_t rows = batch.numOfRows();
+    for (size_t begin = 0; begin < rows; begin += kChunkRows)
+    {
+        size_t n = std::min(kChunkRows, rows - begin);
+        for (const auto &ins : code)
+            execute(ins, bound, begin, n, ints.data(), doubles.data(),
+                    bools.data());
+        consume(begin, n, out);
+    }
+}
+
+void PredicateProgram::evaluate(const ColumnBatch &batch,
+                                vector<uint8_t> &selected) const
+{
+    selected.resize(batch.numOfRows());
+    run(batch, [&](size_t begin, size_t n, const uint8_t *out) {
+        std::copy_n(out, n, selected.data() + begin);
+    });
+}
+
+size_t PredicateProgram::count(const ColumnBatch &batch) const
+{
+    size_t total = 0;
+    run(batch, [&](size_t begin, size_t n, const uint8_t *out) {
+        for (size_t i = 0; i < n; i++)
+            total += out[i];
+    });
+    return total;
+}
+
+string PredicateProgram::toString() const
+{
+    static const char *names[] = {
+        "load_int",      "load_double",      "const_int",
+        "const_double",  "const_bool",       "cast_double",
+        "to_bool",       "eq_int",           "lt_int",
+        "le_int",        "eq_double",        "lt_double",
+        "le_double",     "range_int",        "and_range_int",
+        "range_double",  "and_range_double", "and",
+        "or",            "not",              "is_null",
+        "is_not_null",   "bitmap_get",       "add_int",
+        "sub_int",       "mul_int",          "div_int",
+        "add_double",    "sub_double",       "mul_double",
+        "div_double",    "select_int",       "select_double",
+        "select_bool"};
+    string result_str;
+    for (const auto &ins : code)
+    {
+        result_str += string(names[ins.op]) + " r" +
+                      std::to_string(ins.dst);
+        for (int s : ins.src)
+            if (s >= 0)
+                result_str += ", r" + std::to_string(s);
+        if (ins.column >= 0)
+            result_str += ", " + columns[ins.column];
+        if (ins.op == RANGE_INT || ins.op == AND_RANGE_INT)
+            result_str += ", [" + std::to_string(ins.int_imm[0]) +
+                          ", " + std::to_string(ins.int_imm[1]) + "]";
+        else if (ins.op == RANGE_DOUBLE || ins.op == AND_RANGE_DOUBLE)
+            result_str += ", [" + std::to_string(ins.double_imm[0]) +
+                          ", " + std::to_string(ins.double_imm[1]) +
+                          "]";
+        else if (ins.op == CONST_INT || ins.op == CONST_BOOL ||
+                 ins.op == BITMAP_GET)
+            result_str += ", " + std::to_string(ins.int_imm[0]);
+        else if (ins.op == CONST_DOUBLE)
+            result_str += ", " + std::to_string(ins.double_imm[0]);
+        result_str += "\n";
+    }
+    result_str += "return r" + std::to_string(result);
+    return result_str;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "evaluate/column_batch.h"
+#include "metadata/expression.h"
+#include "metadata/schema.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief A predicate compiled to a flat register-based bytecode. The
+ * interpreter runs the instructions over chunks of a ColumnBatch, so
+ * each instruction is a tight loop over the rows of a chunk.
+ *
+ * Comparisons between an attribute and a literal, including the string
+ * predicates on attributes with a dictionary, are compiled to range
+ * kernels on the column, and the ranges in an and chain are merged per
+ * attribute and evaluated in place into one register. Null values are
+ * visible only to is_null and is_not_null; the other instructions read
+ * the stored values.
+ */
+class PredicateProgram
+{
+  public:
+    /**
+     * @brief Compile a boolean expression
+     *
+     * @param predicate a tree of FunctionExpression,
+     * IfFunctionExpression, Attribute and Literal nodes
+     * @param table_schema the dictionaries of string attributes are
+     * looked up by name in the schema
+     * @return shared_ptr<const PredicateProgram>
+     */
+    static shared_ptr<const PredicateProgram> compile(
+        shared_ptr<const Expression> predicate,
+        shared_ptr<const Schema> table_schema);
+
+    /**
+     * @brief Evaluate the predicate on every row of the batch
+     *
+     * @param batch must have the columns in getColumns()
+     * @param selected OUTPUT: 1 if the row passes the predicate,
+     * otherwise 0
+     */
+    void evaluate(const ColumnBatch &batch,
+                  vector<uint8_t> &selected) const;
+
+    // the number of rows in the batch that pass the predicate
+    size_t count(const ColumnBatch &batch) const;
+
+    // the names of the columns read by the program
+    const vector<string> &getColumns() const
+    {
+        return columns;
+    }
+
+    int numOfInstructions() const
+    {
+        return code.size();
+    }
+
+    // the disassembled program, one instruction per line
+    string toString() const;
+
+  private:
+    enum OpCode
+    {
+        LOAD_INT,
+        LOAD_DOUBLE,
+        CONST_INT,
+        CONST_DOUBLE,
+        CONST_BOOL,
+        CAST_DOUBLE,
+        TO_BOOL,
+        EQ_INT,
+        LT_INT,
+        LE_INT,
+        EQ_DOUBLE,
+        LT_DOUBLE,
+        LE_DOUBLE,
+        RANGE_INT,
+        AND_RANGE_INT,
+        RANGE_DOUBLE,
+        AND_RANGE_DOUBLE,
+        AND,
+        OR,
+        NOT,
+        IS_NULL,
+        IS_NOT_NULL,
+        BITMAP_GET,
+        ADD_INT,
+        SUB_INT,
+        MUL_INT,
+        DIV_INT,
+        ADD_DOUBLE,
+        SUB_DOUBLE,
+        MUL_DOUBLE,
+        DIV_DOUBLE,
+        SELECT_INT,
+        SELECT_DOUBLE,
+        SELECT_BOOL
+    };
+
+    enum RegisterKind
+    {
+        INT_REGISTER,
+        DOUBLE_REGISTER,
+        BOOL_REGISTER
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int dst = -1;
+        int src[3] = {-1, -1, -1};
+        int column = -1;
+        // the bounds of range kernels, or the value of constants
+        int64_t int_imm[2] = {0, 0};
+        double double_imm[2] = {0, 0};
+    };
+
+    class Compiler;
+
+    vector<Instruction> code;
+    vector<RegisterKind> registers;
+    // the offset of each register in the storage of its kind
+    vector<int> slots;
+    int num_slots[3] = {0, 0, 0};
+    vector<string> columns;
+    int result = -1;
+
+    // evaluate the chunks of the batch and pass the result of each
+    // chunk to consume(first row, number of rows, result)
+    void run(const ColumnBatch &batch,
+             const std::function<void(size_t, size_t, const uint8_t *)>
+                 &consume) const;
+
+    void execute(const Instruction &ins,
+                 const vector<const Column *> &bound, size_t begin,
+                 size_t n, int64_t *ints, double *doubles,
+                 uint8_t *bools) const;
+};
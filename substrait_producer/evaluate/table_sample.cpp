@@ -0,0 +1,259 @@
+#include "evaluate/table_sample.h"
+#include "metadata/boundary.h"
+#include "metadata/complex_boundary.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+const char kMagic[8] = {'H', 'P', 'S', 'A', 'M', 'P', 'L', 'E'};
+const uint32_t kVersion = 1;
+
+enum ColumnKind : uint8_t
+{
+    INT64_COLUMN = 0,
+    DOUBLE_COLUMN = 1
+};
+
+template <typename T>
+void readValue(std::ifstream &in, T *out, size_t n, const string &path)
+{
+    in.read(reinterpret_cast<char *>(out), sizeof(T) * n);
+    if (!in)
+        throw Exception("TableSample::readSample: truncated file " +
+                        path);
+}
+} // namespace
+
+shared_ptr<const TableSample> TableSample::readSample(
+    const string &path, shared_ptr<const Schema> table_schema)
+{
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                  "TableSample: expect a little-endian target");
+    std::ifstream in(path, ios::in | ios::binary);
+    if (!in)
+        throw Exception("TableSample::readSample: cannot open " + path);
+
+    char magic[sizeof(kMagic)];
+    uint32_t version, num_columns;
+    uint64_t num_rows;
+    readValue(in, magic, sizeof(magic), path);
+    readValue(in, &version, 1, path);
+    if (memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        version != kVersion)
+        throw Exception("TableSample::readSample: " + path +
+                        " is not a sample file of version " +
+                        std::to_string(kVersion));
+    readValue(in, &num_rows, 1, path);
+    readValue(in, &num_columns, 1, path);
+
+    auto rows = make_shared<ColumnBatch>(num_rows);
+    unordered_set<string> attributes;
+    for (uint32_t i = 0; i < num_columns; i++)
+    {
+        uint32_t length;
+        readValue(in, &length, 1, path);
+        string name(length, '\0');
+        readValue(in, &name[0], length, path);
+        uint8_t kind;
+        readValue(in, &kind, 1, path);
+
+        if (table_schema->getOffset(name) < 0)
+            throw Exception("TableSample::readSample: attribute " +
+                            name + " is not in the table schema");
+        auto attribute = table_schema->get(name);
+        DATA_TYPE type = attribute->getType();
+        bool is_int = type == DATA_TYPE::INTEGER ||
+                      type == DATA_TYPE::BOOLEAN ||
+                      type == DATA_TYPE::STRINGENUM ||
+                      (type == DATA_TYPE::STRING &&
+                       attribute->getDictionary());
+        if ((kind == INT64_COLUMN && !is_int) ||
+            (kind == DOUBLE_COLUMN && type != DATA_TYPE::DOUBLE) ||
+            kind > DOUBLE_COLUMN)
+            throw Exception("TableSample::readSample: column " + name +
+                            " does not match the attribute type");
+
+        Column &c = rows->addColumn(name, type);
+        if (kind == INT64_COLUMN)
+            readValue(in, c.ints.data(), num_rows, path);
+        else
+            readValue(in, c.doubles.data(), num_rows, path);
+        attributes.insert(name);
+    }
+    return make_shared<TableSample>(table_schema, rows,
+                                    std::move(attributes));
+}
+
+bool TableSample::covers(const unordered_set<string> &names) const
+{
+    for (const auto &name : names)
+        if (!attributes.count(name))
+            return false;
+    return true;
+}
+
+double TableSample::estimateRatio(const Boundary &block,
+                                  const Boundary &boundary) const
+{
+    // the rows of the block satisfy the intervals that cover the block
+    const auto &block_intervals = block.getIntervals();
+    IntervalMap narrower;
+    for (const auto &it : boundary.getIntervals())
+    {
+        auto b = block_intervals.find(it.first);
+        if (b != block_intervals.end())
+        {
+            auto r = b->second->relationship(*it.second);
+            if (r == SET_RELATION::SUBSET || r == SET_RELATION::EQUAL)
+                continue;
+        }
+        narrower[it.first] = it.second;
+    }
+    Boundary rest(narrower, boundary.getStatistics());
+    if (!covers(block.getAttributes()) ||
+        !covers(rest.getAttributes()))
+        return -1;
+    return estimateRatio(block.makeExpression(), rest.makeExpression());
+}
+
+double TableSample::estimateRatio(const Boundary &block,
+                                  const ComplexBoundary &boundary) const
+{
+    // drop the attributes with an interval that covers the block
+    const auto &block_intervals = block.getIntervals();
+    IntervalListMap narrower;
+    for (const auto &it : boundary.getIntervals())
+    {
+        auto b = block_intervals.find(it.first);
+        if (b != block_intervals.end() &&
+            interval_list::relationship(it.second, *b->second) ==
+                SET_RELATION::SUPERSET)
+            continue;
+        narrower[it.first] = it.second;
+    }
+    ComplexBoundary rest(narrower, boundary.getStatistics());
+    if (!covers(block.getAttributes()) ||
+        !covers(rest.getAttributes()))
+        return -1;
+    return estimateRatio(block.makeExpression(), rest.makeExpression());
+}
+
+double TableSample::estimateRatio(
+    shared_ptr<const Expression> block,
+    shared_ptr<const Expression> boundary) const
+{
+    // equal boundaries share one node and one cache entry
+    if (block)
+        block = Expression::intern(block);
+    if (boundary)
+        boundary = Expression::intern(boundary);
+
+    size_t in_block = rowsIn(block)->numOfRows();
+    if (in_block < kMinRows)
+        return -1;
+    if (!boundary)
+        return 1;
+    return (double)countRows(block, boundary) / in_block;
+}
+
+vector<int64_t> TableSample::tupleIDs(const Boundary &block) const
+{
+    if (!attributes.count(tuple_id_name) ||
+        !covers(block.getAttributes()))
+        return {};
+    // the rows are evaluated in place rather than gathered by rowsIn,
+    // which would cache every column of the block
+    const auto &tid = rows->getColumn(tuple_id_name)->ints;
+    auto expression = block.makeExpression();
+    vector<int64_t> tids;
+    if (!expression)
+        tids = tid;
+    else
+    {
+        vector<uint8_t> selected;
+        PredicateProgram::compile(expression, table_schema)
+            ->evaluate(*rows, selected);
+        for (size_t i = 0; i < selected.size(); i++)
+            if (selected[i])
+                tids.push_back(tid[i]);
+    }
+    std::sort(tids.begin(), tids.end());
+    return tids;
+}
+
+shared_ptr<const ColumnBatch> TableSample::rowsIn(
+    shared_ptr<const Expression> block) const
+{
+    if (!block)
+        return rows;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = block_rows.find(block.get());
+        if (it != block_rows.end())
+            return it->second.rows;
+    }
+
+    vector<uint8_t> selected;
+    PredicateProgram::compile(block, table_schema)
+        ->evaluate(*rows, selected);
+    vector<size_t> positions;
+    for (size_t i = 0; i < selected.size(); i++)
+        if (selected[i])
+            positions.push_back(i);
+
+    auto gathered = make_shared<ColumnBatch>(positions.size());
+    for (const auto &name : attributes)
+    {
+        const Column *from = rows->getColumn(name);
+        Column &to = gathered->addColumn(name, from->type);
+        if (from->type == DATA_TYPE::DOUBLE)
+            for (size_t i = 0; i < positions.size(); i++)
+                to.doubles[i] = from->doubles[positions[i]];
+        else
+            for (size_t i = 0; i < positions.size(); i++)
+                to.ints[i] = from->ints[positions[i]];
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    size_t values = positions.size() * attributes.size();
+    if (cached_values + values > kMaxCachedValues)
+    {
+        block_rows.clear();
+        cached_values = 0;
+    }
+    if (block_rows.emplace(block.get(), BlockRows{block, gathered})
+            .second)
+        cached_values += values;
+    return gathered;
+}
+
+size_t TableSample::countRows(
+    shared_ptr<const Expression> block,
+    shared_ptr<const Expression> boundary) const
+{
+    auto key = std::make_pair(block.get(), boundary.get());
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = counts.find(key);
+        if (it != counts.end())
+            return it->second;
+    }
+
+    auto in_block = rowsIn(block);
+    size_t n = PredicateProgram::compile(boundary, table_schema)
+                   ->count(*in_block);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (counts.size() >= kMaxCachedCounts)
+    {
+        counts.clear();
+        pinned.clear();
+    }
+    counts.emplace(key, n);
+    if (block)
+        pinned.insert(block);
+    pinned.insert(boundary);
+    return n;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "evaluate/column_batch.h"
+#include "evaluate/predicate_program.h"
+#include "metadata/schema.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class Boundary;
+class ComplexBoundary;
+
+/**
+ * @brief A uniform row sample of a table, stored by column. The rows of
+ * the sample that fall in a block boundary stand for the rows of the
+ * block, so the rows of the block in a query boundary are estimated by
+ * evaluating the query boundary with a PredicateProgram on the sample
+ * rows of the block. The sample rows of each block are gathered once
+ * and cached, so that the many boundaries estimated against one block,
+ * e.g. the split candidates of the partitioner, only scan the rows of
+ * the block. The counts are cached per pair of block and boundary,
+ * both keyed by the interned expressions of the boundaries.
+ *
+ * The sample file is little-endian:
+ *   "HPSAMPLE" uint32 version uint64 num_rows uint32 num_columns
+ * followed by each column:
+ *   uint32 name_length, name, uint8 kind, num_rows values
+ * where kind 0 is int64 values (integers, booleans and the dictionary
+ * codes of strings) and kind 1 is double values. Nulls are not sampled.
+ */
+class TableSample
+{
+  public:
+    // the fewest sample rows in a block to estimate its selectivity
+    static constexpr size_t kMinRows = 64;
+
+    /**
+     * @brief Read a sample file
+     *
+     * @param path
+     * @param table_schema each column must be an attribute of the
+     * table, and its kind must match the type of the attribute
+     * @return shared_ptr<const TableSample>
+     */
+    static shared_ptr<const TableSample> readSample(
+        const string &path, shared_ptr<const Schema> table_schema);
+
+    TableSample(shared_ptr<const Schema> table_schema,
+                shared_ptr<const ColumnBatch> rows,
+                unordered_set<string> attributes)
+        : table_schema(table_schema), rows(rows),
+          attributes(std::move(attributes))
+    {
+    }
+
+    size_t numOfRows() const
+    {
+        return rows->numOfRows();
+    }
+
+    /**
+     * @brief Estimate the fraction of the rows in a block that are in
+     * a boundary
+     *
+     * @param block the boundary of the block
+     * @param boundary
+     * @return double -1 if the sample misses an attribute of the
+     * boundaries, or fewer than kMinRows sample rows are in the block
+     */
+    double estimateRatio(const Boundary &block,
+                         const Boundary &boundary) const;
+
+    double estimateRatio(const Boundary &block,
+                         const ComplexBoundary &boundary) const;
+
+    /**
+     * @brief The tuple ids of the rows in a block. They are the tuple
+     * ids of the block only if the sample holds every row of the table
+     *
+     * @param block the boundary of the block
+     * @return vector<int64_t> the tuple ids in ascending order, empty
+     * if the sample misses the tuple id or an attribute of the block
+     */
+    vector<int64_t> tupleIDs(const Boundary &block) const;
+
+  private:
+    // the caches are dropped once they hold more than these
+    static constexpr size_t kMaxCachedCounts = 1 << 16;
+    static constexpr size_t kMaxCachedValues = 1 << 24;
+
+    shared_ptr<const Schema> table_schema;
+    shared_ptr<const ColumnBatch> rows;
+    unordered_set<string> attributes;
+
+    struct PairHash
+    {
+        size_t operator()(
+            const pair<const Expression *, const Expression *> &p) const
+        {
+            return std::hash<const Expression *>()(p.first) * 31 +
+                   std::hash<const Expression *>()(p.second);
+        }
+    };
+
+    struct BlockRows
+    {
+        // keep the key alive so that it stays unique
+        shared_ptr<const Expression> block;
+        shared_ptr<const ColumnBatch> rows;
+    };
+
+    mutable std::mutex cache_mutex;
+    // the number of sample rows in (block, boundary)
+    mutable unordered_map<pair<const Expression *, const Expression *>,
+                          size_t, PairHash>
+        counts;
+    // keep the keys of counts alive
+    mutable unordered_set<shared_ptr<const Expression>> pinned;
+    // the sample rows in each block, and the number of values in them
+    mutable unordered_map<const Expression *, BlockRows> block_rows;
+    mutable size_t cached_values = 0;
+
+    bool covers(const unordered_set<string> &names) const;
+
+    double estimateRatio(shared_ptr<const Expression> block,
+                         shared_ptr<const Expression> boundary) const;
+
+    // the sample rows in a block; all rows if block is nullptr
+    shared_ptr<const ColumnBatch> rowsIn(
+        shared_ptr<const Expression> block) const;
+
+    size_t countRows(shared_ptr<const Expression> block,
+                     shared_ptr<const Expression> boundary) const;
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include "data_type/bitmap.h"
+
+/**
+ * @brief A set of table attributes. Each bit is the offset of an
+ * attribute in the table schema. The set lives inline, so the set
+ * algebra is a few word operations.
+ */
+typedef Bitmap AttributeSet;
@@ -0,0 +1,525 @@
+#include "metadata/block_catalog.h"
+#include "data_type/data_type_api.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+const char kMagic[8] = {'H', 'P', 'B', 'L', 'K', 'C', 'A', 'T'};
+const uint32_t kVersion = 3;
+
+enum ValueKind : uint32_t
+{
+    NO_VALUE = 0,
+    INTEGER_VALUE = 1,
+    DOUBLE_VALUE = 2,
+    BOOLEAN_VALUE = 3,
+    STRING_VALUE = 4
+};
+
+// the value of a filter end point to compare with the min/max cells of
+// an attribute of the kind; false if the end point has another type
+bool toNumber(const DataType &value, uint32_t kind, double &out)
+{
+    if (kind == INTEGER_VALUE && value.getType() == DATA_TYPE::INTEGER)
+        out = static_cast<const Integer &>(value).getValue();
+    else if (kind == DOUBLE_VALUE &&
+             value.getType() == DATA_TYPE::DOUBLE)
+        out = static_cast<const Double &>(value).getValue();
+    else if (kind == BOOLEAN_VALUE &&
+             value.getType() == DATA_TYPE::BOOLEAN)
+        out = static_cast<const Boolean &>(value).getValue();
+    else
+        return false;
+    return true;
+}
+
+template <typename T>
+void writeSection(std::ofstream &out, const vector<T> &section)
+{
+    out.write(reinterpret_cast<const char *>(section.data()),
+              sizeof(T) * section.size());
+}
+} // namespace
+
+void BlockCatalog::writeCatalog(
+    const string &path,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    shared_ptr<const Schema> table_schema)
+{
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                  "BlockCatalog: expect a little-endian target");
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(Cell) == 8,
+                  "BlockCatalog: unaligned sections");
+
+    Header header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_attributes = table_schema->size();
+    header.num_partitions = partitions.size();
+    header.words_per_block = (header.num_attributes + 63) / 64;
+    for (auto p : partitions)
+        header.num_blocks += p->getBlocks().size();
+
+    string string_table;
+    auto addString = [&string_table](const string &s) {
+        Cell cell{};
+        cell.text.offset = string_table.size();
+        cell.text.length = s.size();
+        string_table += s;
+        return cell;
+    };
+
+    vector<AttributeEntry> attribute_entries(header.num_attributes);
+    for (uint32_t a = 0; a < header.num_attributes; a++)
+    {
+        Cell name = addString(table_schema->get(a)->getName());
+        attribute_entries[a] = {name.text.offset, name.text.length,
+                                NO_VALUE, 0};
+    }
+
+    // the cell of an end point, and check that the end points of an
+    // attribute have one type
+    auto makeCell = [&](uint32_t a, const DataType &value) {
+        Cell cell{};
+        uint32_t kind;
+        int32_t param = 0;
+        switch (value.getType())
+        {
+        case DATA_TYPE::INTEGER:
+            kind = INTEGER_VALUE;
+            param = static_cast<const Integer &>(value).getSize();
+            cell.integer =
+                static_cast<const Integer &>(value).getValue();
+            break;
+        case DATA_TYPE::DOUBLE:
+            kind = DOUBLE_VALUE;
+            param = static_cast<const Double &>(value).getPrecision();
+            cell.real = static_cast<const Double &>(value).getValue();
+            break;
+        case DATA_TYPE::BOOLEAN:
+            kind = BOOLEAN_VALUE;
+            cell.integer =
+                static_cast<const Boolean &>(value).getValue();
+            break;
+        case DATA_TYPE::STRING:
+            kind = STRING_VALUE;
+            cell = addString(
+                static_cast<const String &>(value).getValue());
+            break;
+        case DATA_TYPE::STRINGENUM:
+            kind = STRING_VALUE;
+            cell = addString(
+                static_cast<const StringEnum &>(value).getValue());
+            break;
+        default:
+            throw Exception("BlockCatalog::writeCatalog: unsupported "
+                            "value " +
+                            value.toString());
+        }
+
+        AttributeEntry &entry = attribute_entries[a];
+        if (entry.kind == NO_VALUE)
+        {
+            entry.kind = kind;
+            entry.param = param;
+        }
+        else if (entry.kind != kind || entry.param != param)
+            throw Exception("BlockCatalog::writeCatalog: the intervals "
+                            "on " +
+                            table_schema->get(a)->getName() +
+                            " have different types");
+        return cell;
+    };
+
+    size_t num_blocks = header.num_blocks;
+    size_t words_per_block = header.words_per_block;
+    vector<PartitionEntry> partition_entries;
+    vector<int64_t> row_nums;
+    vector<uint64_t> sorted_words((num_blocks + 63) / 64, 0);
+    vector<uint64_t> tid_buckets;
+    vector<uint64_t> schema_words(num_blocks * words_per_block, 0),
+        interval_words(num_blocks * words_per_block, 0);
+    vector<Cell> min_cells(header.num_attributes * num_blocks, Cell{}),
+        max_cells(header.num_attributes * num_blocks, Cell{});
+    for (auto p : partitions)
+    {
+        auto blocks = p->getBlocks();
+        vector<shared_ptr<const BlockMeta>> ordered(blocks.size());
+        for (auto b : blocks)
+        {
+            if (b->block_id < 0 || b->block_id >= (int)ordered.size() ||
+                ordered[b->block_id])
+                throw Exception("BlockCatalog::writeCatalog: invalid "
+                                "block ids in partition " +
+                                p->getPath());
+            ordered[b->block_id] = b;
+        }
+
+        Cell path_cell = addString(p->getPath());
+        partition_entries.push_back({path_cell.text.offset,
+                                     path_cell.text.length,
+                                     (uint32_t)row_nums.size(),
+                                     (uint32_t)ordered.size()});
+        for (auto b : ordered)
+        {
+            size_t index = row_nums.size();
+            row_nums.push_back(b->row_num);
+            if (b->sorted_by_tid)
+                sorted_words[index / 64] |= uint64_t(1) << (index % 64);
+            tid_buckets.push_back(b->tid_buckets);
+
+            uint64_t *words = &schema_words[index * words_per_block];
+            const auto &attribute_set = b->schema->getAttributeSet();
+            for (int a = attribute_set.findFirst();
+                 a != AttributeSet::npos; a = attribute_set.findNext(a))
+                words[a / 64] |= uint64_t(1) << (a % 64);
+
+            words = &interval_words[index * words_per_block];
+            for (const auto &it : b->boundary->getIntervals())
+            {
+                int a = it.first;
+                if (a < 0 || a >= (int)header.num_attributes)
+                    throw Exception("BlockCatalog::writeCatalog: " +
+                                    std::to_string(a) +
+                                    " is not in the table schema");
+                words[a / 64] |= uint64_t(1) << (a % 64);
+                min_cells[a * num_blocks + index] =
+                    makeCell(a, *it.second->getMin());
+                max_cells[a * num_blocks + index] =
+                    makeCell(a, *it.second->getMax());
+            }
+        }
+    }
+    if (string_table.size() > UINT32_MAX)
+        throw Exception("BlockCatalog::writeCatalog: the strings "
+                        "exceed 4GB");
+    header.string_table_size = string_table.size();
+
+    std::ofstream out(path, ios::out | ios::trunc | ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(out, attribute_entries);
+    writeSection(out, partition_entries);
+    writeSection(out, row_nums);
+    writeSection(out, sorted_words);
+    writeSection(out, tid_buckets);
+    writeSection(out, schema_words);
+    writeSection(out, interval_words);
+    writeSection(out, min_cells);
+    writeSection(out, max_cells);
+    out.write(string_table.data(), string_table.size());
+    out.close();
+    if (!out)
+        throw Exception("BlockCatalog::writeCatalog: cannot write " +
+                        path);
+}
+
+shared_ptr<const BlockCatalog> BlockCatalog::openCatalog(
+    const string &path, shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics,
+    const string &root_path, bool find_file)
+{
+    shared_ptr<BlockCatalog> catalog(new BlockCatalog());
+    catalog->file_path = path;
+    catalog->file = make_unique<MappedFile>(path);
+    const char *data = catalog->file->data();
+    if (catalog->file->size() < sizeof(Header))
+        throw Exception("BlockCatalog::openCatalog: " + path +
+                        " is not a block catalog");
+
+    const Header *header = (const Header *)data;
+    if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        header->version != kVersion)
+        throw Exception("BlockCatalog::openCatalog: " + path +
+                        " is not a block catalog of version " +
+                        std::to_string(kVersion));
+
+    size_t num_blocks = header->num_blocks;
+    size_t num_words = num_blocks * header->words_per_block;
+    size_t num_cells = header->num_attributes * num_blocks;
+    size_t offset = sizeof(Header);
+    auto section = [&](size_t bytes) {
+        const char *begin = data + offset;
+        offset += bytes;
+        return begin;
+    };
+    catalog->header = header;
+    catalog->attributes = (const AttributeEntry *)section(
+        sizeof(AttributeEntry) * header->num_attributes);
+    catalog->partitions = (const PartitionEntry *)section(
+        sizeof(PartitionEntry) * header->num_partitions);
+    catalog->row_nums =
+        (const int64_t *)section(sizeof(int64_t) * num_blocks);
+    catalog->sorted_words = (const uint64_t *)section(
+        sizeof(uint64_t) * ((num_blocks + 63) / 64));
+    catalog->tid_buckets =
+        (const uint64_t *)section(sizeof(uint64_t) * num_blocks);
+    catalog->schema_words =
+        (const uint64_t *)section(sizeof(uint64_t) * num_words);
+    catalog->interval_words =
+        (const uint64_t *)section(sizeof(uint64_t) * num_words);
+    catalog->min_cells =
+        (const Cell *)section(sizeof(Cell) * num_cells);
+    catalog->max_cells =
+        (const Cell *)section(sizeof(Cell) * num_cells);
+    catalog->strings = section(header->string_table_size);
+    if (offset != catalog->file->size())
+        throw Exception("BlockCatalog::openCatalog: " + path +
+                        " has a wrong size");
+
+    if (header->num_attributes != table_schema->size())
+        throw Exception("BlockCatalog::openCatalog: " + path +
+                        " does not match the table schema");
+    for (uint32_t a = 0; a < header->num_attributes; a++)
+    {
+        const auto &entry = catalog->attributes[a];
+        if (table_schema->get(a)->getName() !=
+            string(catalog->strings + entry.name_offset,
+                   entry.name_length))
+            throw Exception("BlockCatalog::openCatalog: " + path +
+                            " does not match the table schema");
+    }
+
+    catalog->table_schema = table_schema;
+    catalog->statistics = statistics;
+    catalog->root_path = root_path;
+    catalog->find_file = find_file;
+    catalog->blocks.resize(num_blocks);
+    catalog->owners.resize(header->num_partitions);
+    catalog->buildIndexes();
+    return catalog;
+}
+
+void BlockCatalog::buildIndexes()
+{
+    size_t num_blocks = header->num_blocks;
+    size_t words_per_block = header->words_per_block;
+    indexes.resize(header->num_attributes);
+    for (uint32_t a = 0; a < header->num_attributes; a++)
+    {
+        uint32_t kind = attributes[a].kind;
+        if (kind != INTEGER_VALUE && kind != DOUBLE_VALUE &&
+            kind != BOOLEAN_VALUE)
+            continue;
+        auto &index = indexes[a];
+        index.unbounded.assign((num_blocks + 63) / 64, 0);
+        for (size_t i = 0; i < num_blocks; i++)
+            if (testBit(interval_words + i * words_per_block, a))
+                index.blocks.push_back(i);
+            else
+                index.unbounded[i / 64] |= uint64_t(1) << (i % 64);
+
+        auto value = [&](const Cell &cell) -> double {
+            return kind == DOUBLE_VALUE ? cell.real : cell.integer;
+        };
+        const Cell *mins = min_cells + a * num_blocks;
+        const Cell *maxs = max_cells + a * num_blocks;
+        std::stable_sort(index.blocks.begin(), index.blocks.end(),
+                         [&](uint32_t x, uint32_t y) {
+                             return value(mins[x]) < value(mins[y]);
+                         });
+        for (uint32_t b : index.blocks)
+        {
+            index.mins.push_back(value(mins[b]));
+            index.maxs.push_back(value(maxs[b]));
+            if (index.mins.size() % kIndexRun == 1)
+                index.run_maxs.push_back(index.maxs.back());
+            else
+                index.run_maxs.back() =
+                    std::max(index.run_maxs.back(), index.maxs.back());
+        }
+    }
+}
+
+void BlockCatalog::AttributeIndex::find(double low, double high,
+                                        vector<uint64_t> &out) const
+{
+    size_t end = std::upper_bound(mins.begin(), mins.end(), high) -
+                 mins.begin();
+    for (size_t run = 0; run * kIndexRun < end; run++)
+    {
+        if (run_maxs[run] < low)
+            continue;
+        size_t last = std::min(end, (run + 1) * kIndexRun);
+        for (size_t i = run * kIndexRun; i < last; i++)
+            if (maxs[i] >= low)
+                out[blocks[i] / 64] |= uint64_t(1) << (blocks[i] % 64);
+    }
+}
+
+string BlockCatalog::getString(const Cell &cell) const
+{
+    return string(strings + cell.text.offset, cell.text.length);
+}
+
+shared_ptr<DataType> BlockCatalog::makeValue(int attribute,
+                                             const Cell &cell) const
+{
+    const AttributeEntry &entry = attributes[attribute];
+    switch (entry.kind)
+    {
+    case INTEGER_VALUE:
+        return make_shared<Integer>(cell.integer, entry.param);
+    case DOUBLE_VALUE:
+        return make_shared<Double>(cell.real, entry.param);
+    case BOOLEAN_VALUE:
+        return make_shared<Boolean>(cell.integer != 0);
+    case STRING_VALUE:
+        return make_shared<String>(getString(cell));
+    default:
+        throw Exception("BlockCatalog: invalid value kind of " +
+                        table_schema->get(attribute)->getName() +
+                        " in " + file_path);
+    }
+}
+
+shared_ptr<const BlockMeta> BlockCatalog::getBlock(
+    uint32_t p, uint32_t position) const
+{
+    size_t index = partitions[p].first_block + position;
+    if (blocks[index])
+        return blocks[index];
+    if (!owners[p])
+    {
+        string path = root_path + "/" +
+                      string(strings + partitions[p].path_offset,
+                             partitions[p].path_length);
+        if (find_file)
+            path = findParquet(path, ".parquet");
+        owners[p] = make_shared<PartitionMeta>(path);
+    }
+
+    size_t words_per_block = header->words_per_block;
+    size_t num_blocks = header->num_blocks;
+    auto schema = make_shared<Schema>();
+    const uint64_t *words = schema_words + index * words_per_block;
+    for (size_t w = 0; w < words_per_block; w++)
+        for (uint64_t word = words[w]; word; word &= word - 1)
+            schema->add(
+                table_schema->get(w * 64 + __builtin_ctzll(word)));
+
+    IntervalMap intervals;
+    words = interval_words + index * words_per_block;
+    for (size_t w = 0; w < words_per_block; w++)
+        for (uint64_t word = words[w]; word; word &= word - 1)
+        {
+            int a = w * 64 + __builtin_ctzll(word);
+            size_t cell = a * num_blocks + index;
+            auto low = makeValue(a, min_cells[cell]);
+            auto high = makeValue(a, max_cells[cell]);
+            string name = table_schema->get(a)->getName();
+            auto dictionary = table_schema->get(a)->getDictionary();
+            if (dictionary)
+            {
+                // encode the end points as
+                // BlockMeta::parseSubstraitBlock does
+                auto codes = BlockMeta::encodeStrings(
+                    dictionary.get(), *low, *high, name, position,
+                    *table_schema, statistics.get());
+                low = codes.first;
+                high = codes.second;
+            }
+            intervals.emplace(
+                a, make_shared<Interval>(low, false, high, false));
+        }
+
+    auto block = make_shared<BlockMeta>(
+        position, make_shared<Boundary>(intervals, statistics), schema,
+        owners[p].get(), row_nums[index]);
+    block->sorted_by_tid = testBit(sorted_words, index);
+    if (block->hasTidRange())
+        block->tid_buckets = tid_buckets[index];
+    blocks[index] = block;
+    return blocks[index];
+}
+
+vector<shared_ptr<const PartitionMeta>> BlockCatalog::selectPartitions(
+    const ComplexBoundary &filter, const AttributeSet &attributes) const
+{
+    // the filter intervals on the attributes whose min/max cells are
+    // numbers
+    struct Range
+    {
+        int attribute;
+        vector<pair<double, double>> intervals;
+    };
+    vector<Range> ranges;
+    for (const auto &it : filter.getIntervals())
+    {
+        int a = it.first;
+        if (a >= (int)header->num_attributes || it.second.empty())
+            continue;
+        uint32_t kind = this->attributes[a].kind;
+        Range range{a, {}};
+        bool numeric = true;
+        for (const auto &interval : it.second)
+        {
+            double low, high;
+            numeric = toNumber(*interval->getMin(), kind, low) &&
+                      toNumber(*interval->getMax(), kind, high);
+            if (!numeric)
+                break;
+            range.intervals.emplace_back(low, high);
+        }
+        if (numeric)
+            ranges.push_back(std::move(range));
+    }
+
+    size_t words_per_block = header->words_per_block;
+    size_t num_blocks = header->num_blocks;
+    vector<int> referred;
+    for (int a = attributes.findFirst(); a != AttributeSet::npos;
+         a = attributes.findNext(a))
+        if (a < (int)header->num_attributes)
+            referred.push_back(a);
+
+    // the blocks whose min/max intersect an interval of every range,
+    // or that have no interval on the attribute of the range
+    vector<uint64_t> candidates((num_blocks + 63) / 64, ~uint64_t(0));
+    vector<uint64_t> hits;
+    for (const auto &range : ranges)
+    {
+        const auto &index = indexes[range.attribute];
+        hits = index.unbounded;
+        for (const auto &interval : range.intervals)
+            index.find(interval.first, interval.second, hits);
+        for (size_t w = 0; w < candidates.size(); w++)
+            candidates[w] &= hits[w];
+    }
+
+    // a block is skipped only if BlockMeta::relationship would find it
+    // disjoint with the query
+    auto skip = [&](size_t index) {
+        if (!testBit(candidates.data(), index))
+            return true;
+        const uint64_t *words = schema_words + index * words_per_block;
+        bool has_attribute = false, intersects = false;
+        for (size_t w = 0; w < words_per_block; w++)
+            has_attribute |= words[w] != 0;
+        for (int a : referred)
+            intersects |= testBit(words, a);
+        return has_attribute && !intersects;
+    };
+
+    // the scan only reads the mapped file, so the lock is held only to
+    // build or look up the selected blocks
+    vector<shared_ptr<const PartitionMeta>> result;
+    for (uint32_t p = 0; p < header->num_partitions; p++)
+    {
+        vector<shared_ptr<const BlockMeta>> selected;
+        for (uint32_t i = 0; i < partitions[p].num_blocks; i++)
+        {
+            if (skip(partitions[p].first_block + i))
+                continue;
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            selected.push_back(getBlock(p, i));
+        }
+        // owners[p] is set once by getBlock, so it can be read once a
+        // block of p is built
+        if (!selected.empty())
+            result.push_back(make_shared<PartitionMeta>(
+                owners[p]->getPath(), std::move(selected)));
+    }
+    return result;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "metadata/attribute_set.h"
+#include "metadata/boundary.h"
+#include "metadata/complex_boundary.h"
+#include "protobuf_io.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief A flat, read-only catalog of the blocks of a partitioning
+ * layout, the binary alternative to the protobuf PartitionList. The
+ * file is mapped into memory and read in place: the blocks are
+ * pre-filtered on the per-attribute min/max columns, looked up in an
+ * index built when the catalog is opened, and on the schema bitmaps,
+ * and a BlockMeta is only built for a block that passes the
+ * pre-filter. The built blocks are cached, so a block is the same
+ * object in every query.
+ *
+ * The file is little-endian and each section starts at a multiple of 8
+ * bytes:
+ *   header      "HPBLKCAT" uint32 version uint32 num_attributes
+ *               uint32 num_partitions uint32 num_blocks
+ *               uint32 words_per_block uint32 0
+ *               uint64 string_table_size
+ *   attributes  num_attributes * {uint32 name_offset,
+ *               uint32 name_length, uint32 kind, int32 param}
+ *   partitions  num_partitions * {uint32 path_offset,
+ *               uint32 path_length, uint32 first_block,
+ *               uint32 num_blocks}
+ *   row numbers num_blocks * int64, -1 if unknown
+ *   sorted      (num_blocks + 63) / 64 * uint64
+ *   tid buckets num_blocks * uint64
+ *   schemas     num_blocks * words_per_block * uint64
+ *   intervals   num_blocks * words_per_block * uint64
+ *   min, max    2 * num_attributes * num_blocks * 8 bytes
+ *   strings     string_table_size bytes
+ * The attributes are the table schema in order, and bit i of the
+ * schema (interval) words of a block is set if the block has (an
+ * interval on) attribute i. Bit i of the sorted words is set if the
+ * tuples of block i are stored in the order of their tuple ids. The
+ * tid buckets of a block are BlockMeta's buckets of its tuple ids, and
+ * its tuple id range is its min/max on the tuple id. The
+ * blocks of a partition are stored in the order of their ids. A
+ * min/max cell is an int64 for integers and booleans, a double for
+ * doubles and {uint32 offset, uint32 length} in the string table for
+ * strings. The kind of an attribute is the type
+ * of its intervals, and the param is the width of an integer or the
+ * precision of a double.
+ */
+class BlockCatalog
+{
+  public:
+    static constexpr const char *suffix = ".catalog";
+
+    /**
+     * @brief Write the blocks of a layout
+     *
+     * @param path
+     * @param partitions
+     * @param table_schema
+     */
+    static void writeCatalog(
+        const string &path,
+        const vector<shared_ptr<const PartitionMeta>> &partitions,
+        shared_ptr<const Schema> table_schema);
+
+    /**
+     * @brief Map a catalog into memory
+     *
+     * @param path
+     * @param table_schema the schema the catalog was written with
+     * @param statistics the value range of the table
+     * @param root_path prepended to the partition paths
+     * @param find_file True if the partition paths are resolved to
+     * their parquet files, as PartitionMeta::parseSubstraitPartition
+     * does
+     * @return shared_ptr<const BlockCatalog>
+     */
+    static shared_ptr<const BlockCatalog> openCatalog(
+        const string &path, shared_ptr<const Schema> table_schema,
+        shared_ptr<const TableStatistics> statistics,
+        const string &root_path, bool find_file = false);
+
+    BlockCatalog(const BlockCatalog &) = delete;
+    BlockCatalog &operator=(const BlockCatalog &) = delete;
+
+    size_t numOfPartitions() const
+    {
+        return header->num_partitions;
+    }
+
+    size_t numOfBlocks() const
+    {
+        return header->num_blocks;
+    }
+
+    /**
+     * @brief Select the blocks of a query. A block is skipped if its
+     * schema is disjoint with the attributes, or if the min/max of an
+     * integer, double or boolean attribute is out of every interval of
+     * the filter on the attribute. The test is conservative, so the
+     * selected blocks still go through BlockMeta::relationship.
+     *
+     * @param filter
+     * @param attributes the attributes referred by the query
+     * @return vector<shared_ptr<const PartitionMeta>> the partitions
+     * with a selected block, listing the selected blocks in order. The
+     * blocks keep their ids and refer to the catalog partitions.
+     */
+    vector<shared_ptr<const PartitionMeta>> selectPartitions(
+        const ComplexBoundary &filter,
+        const AttributeSet &attributes) const;
+
+  private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t num_attributes;
+        uint32_t num_partitions;
+        uint32_t num_blocks;
+        uint32_t words_per_block;
+        uint32_t reserved;
+        uint64_t string_table_size;
+    };
+
+    struct AttributeEntry
+    {
+        uint32_t name_offset;
+        uint32_t name_length;
+        uint32_t kind;
+        int32_t param;
+    };
+
+    struct PartitionEntry
+    {
+        uint32_t path_offset;
+        uint32_t path_length;
+        uint32_t first_block;
+        uint32_t num_blocks;
+    };
+
+    union Cell {
+        int64_t integer;
+        double real;
+        struct
+        {
+            uint32_t offset;
+            uint32_t length;
+        } text;
+    };
+
+    // the blocks with an interval on an attribute whose min/max cells
+    // are numbers, in the order of their minimums. They are grouped in
+    // runs of kIndexRun blocks with the largest maximum of each run, so
+    // that a lookup skips the runs below the range and stops at the
+    // first minimum above it
+    struct AttributeIndex
+    {
+        vector<uint32_t> blocks;
+        vector<double> mins;
+        vector<double> maxs;
+        vector<double> run_maxs;
+        // bit i is set if block i has no interval on the attribute, so
+        // the index cannot skip it
+        vector<uint64_t> unbounded;
+
+        // set the bits of the indexed blocks that intersect [low, high]
+        void find(double low, double high,
+                  vector<uint64_t> &out) const;
+    };
+    static constexpr size_t kIndexRun = 64;
+
+    BlockCatalog() = default;
+
+    string file_path;
+    unique_ptr<MappedFile> file;
+
+    const Header *header = nullptr;
+    const AttributeEntry *attributes = nullptr;
+    const PartitionEntry *partitions = nullptr;
+    const int64_t *row_nums = nullptr;
+    const uint64_t *sorted_words = nullptr;
+    const uint64_t *tid_buckets = nullptr;
+    const uint64_t *schema_words = nullptr;
+    const uint64_t *interval_words = nullptr;
+    const Cell *min_cells = nullptr;
+    const Cell *max_cells = nullptr;
+    const char *strings = nullptr;
+
+    shared_ptr<const Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
+    string root_path;
+    bool find_file = false;
+    // by attribute offset, empty for the attributes of other kinds
+    vector<AttributeIndex> indexes;
+
+    mutable std::mutex cache_mutex;
+    // the built blocks, indexed by the block position in the catalog
+    mutable vector<shared_ptr<const BlockMeta>> blocks;
+    // the partitions the built blocks refer to, created on demand
+    mutable vector<shared_ptr<PartitionMeta>> owners;
+
+    static bool testBit(const uint64_t *words, int offset)
+    {
+        return (words[offset / 64] >> (offset % 64)) & 1;
+    }
+
+    string getString(const Cell &cell) const;
+
+    void buildIndexes();
+
+    shared_ptr<DataType> makeValue(int attribute,
+                                   const Cell &cell) const;
+
+    // build the block at a position of partition p, or get it from
+    // the cache. The caller holds cache_mutex
+    shared_ptr<const BlockMeta> getBlock(uint32_t p,
+                                         uint32_t position) const;
+};
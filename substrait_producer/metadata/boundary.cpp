@@ -1,14 +1,26 @@
 #include "metadata/boundary.h"
+#include "arena.h"
+#include "evaluate/table_sample.h"
 #include "metadata/complex_boundary.h"
+#include <algorithm>
 #include <filesystem>
 #include <string>
 
 namespace fs = std::filesystem;
 
-Boundary::Boundary(
-    const unordered_map<string, shared_ptr<const Interval>> &intervals)
+Boundary::Boundary(IntervalMap intervals,
+                   shared_ptr<const TableStatistics> statistics)
+    : intervals(std::move(intervals)), statistics(statistics)
 {
-    this->intervals = intervals;
+}
+
+string Boundary::attributeName(int offset) const
+{
+    if (!statistics)
+        throw Exception("Boundary: the boundary does not have the "
+                        "table statistics to name attribute " +
+                        std::to_string(offset));
+    return statistics->getSchema()->get(offset)->getName();
 }
 
 string Boundary::toString() const
@@ -17,54 +29,32 @@ string Boundary::toString() const
     for (auto it = this->intervals.begin(); it != this->intervals.end();
          it++)
     {
-        result += it->first + ": " + it->second->toString() + ", ";
+        result += (statistics ? attributeName(it->first)
+                              : std::to_string(it->first)) +
+                  ": " + it->second->toString() + ", ";
     }
     result += "}";
     return result;
 }
 
-Boundary *Boundary::clone() const
+Boundary *Boundary::clone(std::pmr::memory_resource *resource) const
 {
-    unordered_map<string, shared_ptr<const Interval>> new_intervals;
-    for (auto it : this->intervals)
-        new_intervals[it.first] =
-            shared_ptr<const Interval>(it.second->clone());
-    return new Boundary(new_intervals);
+    // intervals are immutable once they are in a boundary, so the clone
+    // shares them instead of copying each one
+    return new Boundary(IntervalMap(this->intervals, resource),
+                        this->statistics);
 }
 
 SET_RELATION Boundary::relationship(const Boundary &other) const
 {
-    // fill the missing attributes of the two boundaries
-    auto b = this->intervals;
-    auto b_other = other.intervals;
-    for (auto it = b.begin(); it != b.end(); it++)
-    {
-        auto it_o = b_other.find(it->first);
-        if (it_o == b_other.end())
-            b_other[it->first] = make_shared<const Interval>(
-                getMinValue(it->first), false, getMaxValue(it->first),
-                false);
-        else if (it->second->getType() != it_o->second->getType())
-            throw Exception(
-                "Boundaries do not have the same type at attribute " +
-                it->first);
-    }
-    for (auto it_o = b_other.begin(); it_o != b_other.end(); it_o++)
-        if (b.find(it_o->first) == b.end())
-            b[it_o->first] = make_shared<const Interval>(
-                getMinValue(it_o->first), false,
-                getMaxValue(it_o->first), false);
-
-    // compare each attribute in both boundaries
+    // an attribute missing in one boundary spans the full value range
+    // of the attribute
     SET_RELATION relation = SET_RELATION::EQUAL;
-    for (auto it = b.begin(); it != b.end(); it++)
-    {
-        auto it_o = b_other.find(it->first);
-        auto r = it->second->relationship(*it_o->second);
+    auto merge = [&relation](SET_RELATION r) {
         switch (r)
         {
         case SET_RELATION::DISJOINT:
-            return SET_RELATION::DISJOINT;
+            relation = SET_RELATION::DISJOINT;
             break;
         case SET_RELATION::EQUAL:
             break;
@@ -90,32 +80,67 @@ SET_RELATION Boundary::relationship(const Boundary &other) const
                 "Boundary::relationship: Unknow interval relation");
             break;
         }
+    };
+
+    // compare each attribute in both boundaries
+    for (auto it = intervals.begin(); it != intervals.end(); it++)
+    {
+        auto it_o = other.intervals.find(it->first);
+        if (it_o == other.intervals.end())
+            merge(it->second->relationship(TableStatistics::findRange(
+                it->first, statistics.get(), other.statistics.get())));
+        else if (it->second->getType() != it_o->second->getType())
+            throw Exception(
+                "Boundaries do not have the same type at attribute " +
+                std::to_string(it->first));
+        else
+            merge(it->second->relationship(*it_o->second));
+        if (relation == SET_RELATION::DISJOINT)
+            return relation;
+    }
+    for (auto it_o = other.intervals.begin();
+         it_o != other.intervals.end(); it_o++)
+    {
+        if (intervals.find(it_o->first) != intervals.end())
+            continue;
+        merge(TableStatistics::findRange(it_o->first, statistics.get(),
+                                         other.statistics.get())
+                  .relationship(*it_o->second));
+        if (relation == SET_RELATION::DISJOINT)
+            return relation;
     }
     return relation;
 }
 
-Boundary Boundary::intersect(const Boundary &other) const
+SET_RELATION Boundary::relationship(const ComplexBoundary &other) const
+{
+    return reverseRelationship(other.relationship(*this));
+}
+
+Boundary Boundary::intersect(const Boundary &other,
+                             std::pmr::memory_resource *resource) const
 {
     if (this->relationship(other) == SET_RELATION::DISJOINT)
         throw Exception(
             "Boundary::intersect: two bondaries are disjoint");
 
-    unordered_map<string, shared_ptr<const Interval>> m;
+    IntervalMap m(resource);
     for (auto it = intervals.begin(); it != intervals.end(); it++)
     {
         auto it1 = other.intervals.find(it->first);
         if (it1 == other.intervals.end())
             m[it->first] = it->second;
         else
-            m[it->first] = make_shared<const Interval>(
-                it->second->interesct(*it1->second));
+            m[it->first] = makeArenaShared<Interval>(
+                resource, it->second->interesct(*it1->second));
     }
 
     for (auto it1 = other.intervals.begin();
          it1 != other.intervals.end(); it1++)
         if (this->intervals.find(it1->first) == this->intervals.end())
             m[it1->first] = it1->second;
-    return Boundary(m);
+    return Boundary(std::move(m),
+                    statistics ? statistics : other.statistics);
 }
 
 double Boundary::intersectionRatio(const Boundary &other) const
@@ -127,12 +152,10 @@ double Boundary::intersectionRatio(const Boundary &other) const
     {
         auto it_this = this->intervals.find(it->first);
         if (it_this == this->intervals.end())
-        {
-            auto min_val = getMinValue(it->first);
-            auto max_val = getMaxValue(it->first);
-            Interval i(min_val, false, max_val, false);
-            ratio *= i.intersectionRatio(*it->second);
-        }
+            ratio *= TableStatistics::findRange(it->first,
+                                                statistics.get(),
+                                                other.statistics.get())
+                         .intersectionRatio(*it->second);
         else
             ratio *= it_this->second->intersectionRatio(*it->second);
     }
@@ -147,13 +170,13 @@ double Boundary::intersectionRatio(const ComplexBoundary &other) const
     for (auto it = other_inters.begin(); it != other_inters.end(); it++)
     {
         auto it_this = this->intervals.find(it->first);
-        shared_ptr<const Interval> this_i;
+        const Interval *this_i;
         if (it_this == this->intervals.end())
-            this_i =
-                make_shared<Interval>(getMinValue(it->first), false,
-                                      getMaxValue(it->first), false);
+            this_i = &TableStatistics::findRange(
+                it->first, statistics.get(),
+                other.getStatistics().get());
         else
-            this_i = it_this->second;
+            this_i = it_this->second.get();
 
         double r = 0;
         for (auto i : it->second)
@@ -172,16 +195,16 @@ vector<shared_ptr<Boundary>> Boundary::split(string attribute,
                                              shared_ptr<DataType> point,
                                              bool point_target) const
 {
-    shared_ptr<const Interval> point_interval;
-    if (intervals.count(attribute))
-        point_interval = intervals.at(attribute);
+    if (!statistics)
+        throw Exception("Boundary::split: the boundary does not have "
+                        "the table statistics");
+    int offset = statistics->getSchema()->getOffset(attribute);
+    const Interval *point_interval;
+    if (intervals.count(offset))
+        point_interval = intervals.at(offset).get();
     else
-    {
-        auto min_val = getMinValue(attribute);
-        auto max_val = getMaxValue(attribute);
-        point_interval =
-            make_shared<Interval>(min_val, false, max_val, false);
-    }
+        point_interval = &TableStatistics::findRange(
+            offset, statistics.get(), nullptr);
 
     // split the interval
     auto split_interval = point_interval->split(point, point_target);
@@ -190,8 +213,8 @@ vector<shared_ptr<Boundary>> Boundary::split(string attribute,
 
     auto b1 = shared_ptr<Boundary>(this->clone()),
          b2 = shared_ptr<Boundary>(this->clone());
-    b1->intervals[attribute] = split_interval[0];
-    b2->intervals[attribute] = split_interval[1];
+    b1->intervals[offset] = split_interval[0];
+    b2->intervals[offset] = split_interval[1];
     return {b1, b2};
 }
 
@@ -199,7 +222,15 @@ unordered_set<string> Boundary::getAttributes() const
 {
     unordered_set<string> attributes;
     for (auto it = intervals.begin(); it != intervals.end(); it++)
-        attributes.insert(it->first);
+        attributes.insert(attributeName(it->first));
+    return attributes;
+}
+
+AttributeSet Boundary::getAttributeSet() const
+{
+    AttributeSet attributes;
+    for (auto it = intervals.begin(); it != intervals.end(); it++)
+        attributes.set(it->first);
     return attributes;
 }
 
@@ -209,7 +240,7 @@ Boundary Boundary::Union(
     if (boundaries.size() == 0)
         throw Exception("Boundary::Union: the input must at least have "
                         "one boundary");
-    unordered_map<string, vector<shared_ptr<const Interval>>> intervals;
+    map<int, vector<shared_ptr<const Interval>>> intervals;
     for (auto b : boundaries)
     {
         auto &i = b->intervals;
@@ -221,7 +252,7 @@ Boundary Boundary::Union(
         }
     }
 
-    unordered_map<string, shared_ptr<const Interval>> result_interval;
+    IntervalMap result_interval;
     for (auto it = intervals.begin(); it != intervals.end(); it++)
     {
         if (it->second.size() != boundaries.size())
@@ -232,14 +263,14 @@ Boundary Boundary::Union(
         result_interval[it->first] =
             make_shared<Interval>(Interval::Union(it->second));
     }
-    return Boundary(result_interval);
+    return Boundary(result_interval, boundaries[0]->statistics);
 }
 
-void Boundary::keepAttributes(const unordered_set<string> &attributes)
+void Boundary::keepAttributes(const AttributeSet &attributes)
 {
     for (auto it = intervals.begin(); it != intervals.end();)
     {
-        if (attributes.count(it->first) == 0)
+        if (!attributes.test(it->first))
             it = intervals.erase(it);
         else
             it++;
@@ -251,11 +282,11 @@ shared_ptr<FunctionExpression> Boundary::makeExpression() const
     if (intervals.size() == 0)
         return nullptr;
     auto it = intervals.begin();
-    auto baseExp = it->second->makeExpression(it->first);
+    auto baseExp = it->second->makeExpression(attributeName(it->first));
     it++;
     for (; it != intervals.end(); it++)
     {
-        auto e = it->second->makeExpression(it->first);
+        auto e = it->second->makeExpression(attributeName(it->first));
         baseExp = make_shared<FunctionExpression>(
             "filter_exp", "and",
             vector<shared_ptr<const Expression>>{baseExp, e},
@@ -264,16 +295,44 @@ shared_ptr<FunctionExpression> Boundary::makeExpression() const
     return baseExp;
 }
 
-size_t BlockMeta::estimateIOSize(
-    const unordered_set<string> &attributes) const
+int64_t BlockMeta::estimateRowNum(const Boundary &boundary) const
+{
+    if (row_num == -1)
+        return -1;
+    auto statistics = this->boundary->getStatistics();
+    if (statistics && statistics->getSample())
+    {
+        double ratio = statistics->getSample()->estimateRatio(
+            *this->boundary, boundary);
+        if (ratio >= 0)
+            return row_num * ratio;
+    }
+    return row_num * this->boundary->intersectionRatio(boundary);
+}
+
+int64_t BlockMeta::estimateRowNum(const ComplexBoundary &boundary) const
+{
+    if (row_num == -1)
+        return -1;
+    auto statistics = this->boundary->getStatistics();
+    if (statistics && statistics->getSample())
+    {
+        double ratio = statistics->getSample()->estimateRatio(
+            *this->boundary, boundary);
+        if (ratio >= 0)
+            return row_num * ratio;
+    }
+    return row_num * this->boundary->intersectionRatio(boundary);
+}
+
+size_t BlockMeta::estimateIOSize(const AttributeSet &attributes) const
 {
     size_t row_size = 0;
-    for (const string &a : attributes)
+    for (int i = 0; i < schema->size(); i++)
     {
-        if (!schema->contains(a))
-            continue;
-        auto attr = schema->get(a);
-        row_size += attr->getSize();
+        auto attr = schema->get(i);
+        if (attributes.test(attr->getTableOffset()))
+            row_size += attr->getSize();
     }
     if (row_num < 0)
         throw Exception(
@@ -297,20 +356,24 @@ vector<shared_ptr<BlockMeta>> BlockMeta::split(
                                 b1_tnum + b2_tnum != this->row_num))
         throw Exception(
             "BlockMeta::split: row_num computation is not valid");
-    return {make_shared<BlockMeta>(0, split_boundary[0], this->schema,
-                                   nullptr, b1_tnum),
-            make_shared<BlockMeta>(0, split_boundary[1], this->schema,
-                                   nullptr, b2_tnum)};
+    vector<shared_ptr<BlockMeta>> blocks = {
+        make_shared<BlockMeta>(0, split_boundary[0], this->schema,
+                               nullptr, b1_tnum),
+        make_shared<BlockMeta>(0, split_boundary[1], this->schema,
+                               nullptr, b2_tnum)};
+    // a part of a sorted block keeps the order of its tuples
+    for (auto &b : blocks)
+        b->sorted_by_tid = this->sorted_by_tid;
+    return blocks;
 }
 
-SET_RELATION BlockMeta::relationship(
-    shared_ptr<const Boundary> other_boundary,
-    const unordered_set<string> &other_attributes) const
+namespace
+{
+// combine the relationships on the boundary and on the schema into the
+// relationship of two blocks
+SET_RELATION mergeBlockRelationship(SET_RELATION boundary_relation,
+                                    SET_RELATION attribute_relation)
 {
-    auto boundary_relation =
-        this->boundary->relationship(*other_boundary);
-    auto attribute_relation =
-        this->schema->relationship(other_attributes);
     if (boundary_relation == SET_RELATION::DISJOINT ||
         attribute_relation == SET_RELATION::DISJOINT)
         return SET_RELATION::DISJOINT;
@@ -330,6 +393,144 @@ SET_RELATION BlockMeta::relationship(
     else
         return SET_RELATION::INTERSECT;
 }
+}; // namespace
+
+SET_RELATION BlockMeta::relationship(
+    shared_ptr<const Boundary> other_boundary,
+    const AttributeSet &other_attributes) const
+{
+    return mergeBlockRelationship(
+        this->boundary->relationship(*other_boundary),
+        this->schema->relationship(other_attributes));
+}
+
+SET_RELATION BlockMeta::relationship(
+    shared_ptr<const ComplexBoundary> other_boundary,
+    const AttributeSet &other_attributes) const
+{
+    return mergeBlockRelationship(
+        this->boundary->relationship(*other_boundary),
+        this->schema->relationship(other_attributes));
+}
+
+namespace
+{
+// the buckets of the table range of the tuple id that [low, high]
+// falls in. Every bucket if the table range is unknown or does not
+// hold [low, high], so that a block is never disjoint by its buckets
+// from the blocks it shares tuples with
+uint64_t tidBuckets(int64_t low, int64_t high,
+                    const TableStatistics *statistics)
+{
+    if (!statistics)
+        return ~0ULL;
+    int offset = statistics->getSchema()->getOffset(tuple_id_name);
+    if (!statistics->hasRange(offset))
+        return ~0ULL;
+    const auto &range = statistics->getRange(offset);
+    if (range->getType() != DATA_TYPE::INTEGER)
+        return ~0ULL;
+    int64_t min =
+        static_cast<const Integer *>(range->lower())->getValue();
+    int64_t max =
+        static_cast<const Integer *>(range->upper())->getValue();
+    if (low > high || low < min || high > max)
+        return ~0ULL;
+    // the bucket of a tuple id, computed in double so that the range
+    // of the table does not overflow
+    double width = ((double)max - min + 1) / 64;
+    auto bucket = [&](int64_t tid) {
+        return std::min(63, (int)((tid - min) / width));
+    };
+    int first = bucket(low), last = bucket(high);
+    uint64_t buckets = ~0ULL << first;
+    if (last < 63)
+        buckets &= ~(~0ULL << (last + 1));
+    return buckets;
+}
+}; // namespace
+
+void BlockMeta::readTidRange()
+{
+    tid_min = tid_max = -1;
+    tid_buckets = ~0ULL;
+    tid_runs.clear();
+    if (!boundary)
+        return;
+    auto statistics = boundary->getStatistics();
+    if (!statistics)
+        return;
+    const auto &intervals = boundary->getIntervals();
+    auto it =
+        intervals.find(statistics->getSchema()->getOffset(tuple_id_name));
+    if (it == intervals.end() ||
+        it->second->getType() != DATA_TYPE::INTEGER)
+        return;
+    tid_min = static_cast<const Integer *>(it->second->lower())
+                  ->getValue();
+    tid_max = static_cast<const Integer *>(it->second->upper())
+                  ->getValue();
+    tid_buckets = tidBuckets(tid_min, tid_max, statistics.get());
+}
+
+void BlockMeta::setTupleIDs(const vector<int64_t> &tids)
+{
+    if (tids.empty())
+        return;
+    auto statistics = boundary->getStatistics();
+    if (!statistics)
+        throw Exception("BlockMeta::setTupleIDs: the table range is "
+                        "unknown");
+
+    vector<pair<int64_t, int64_t>> runs;
+    for (int64_t tid : tids)
+    {
+        if (!runs.empty() && tid <= runs.back().second + 1)
+            runs.back().second = std::max(runs.back().second, tid);
+        else
+            runs.emplace_back(tid, tid);
+    }
+    if (runs.size() > kMaxTidRuns)
+    {
+        // keep the largest gaps, the gap before run i splits the runs
+        vector<size_t> gaps(runs.size() - 1);
+        for (size_t i = 0; i < gaps.size(); i++)
+            gaps[i] = i + 1;
+        std::nth_element(gaps.begin(), gaps.begin() + kMaxTidRuns - 1,
+                         gaps.end(), [&](size_t a, size_t b) {
+                             return runs[a].first - runs[a - 1].second >
+                                    runs[b].first - runs[b - 1].second;
+                         });
+        gaps.resize(kMaxTidRuns - 1);
+        std::sort(gaps.begin(), gaps.end());
+        vector<pair<int64_t, int64_t>> merged;
+        size_t begin = 0;
+        for (size_t i = 0; i <= gaps.size(); i++)
+        {
+            size_t end = i < gaps.size() ? gaps[i] : runs.size();
+            merged.emplace_back(runs[begin].first,
+                                runs[end - 1].second);
+            begin = end;
+        }
+        runs = std::move(merged);
+    }
+
+    IntervalMap intervals = boundary->getIntervals();
+    intervals.erase(statistics->getSchema()->getOffset(tuple_id_name));
+    intervals.emplace(
+        statistics->getSchema()->getOffset(tuple_id_name),
+        make_shared<Interval>(
+            make_shared<Integer>(runs.front().first, 64), false,
+            make_shared<Integer>(runs.back().second, 64), false));
+    setBoundary(make_shared<Boundary>(intervals, statistics));
+
+    tid_buckets = 0;
+    for (const auto &run : runs)
+        tid_buckets |=
+            tidBuckets(run.first, run.second, statistics.get());
+    if (runs.size() > 1)
+        tid_runs = std::move(runs);
+}
 
 string BlockMeta::toString() const
 {
@@ -352,9 +553,56 @@ string PartitionMeta::toString() const
     return result;
 }
 
+namespace
+{
+string stringValue(const DataType &value)
+{
+    auto s = dynamic_cast<const String *>(&value);
+    if (s == nullptr)
+        throw Exception("BlockMeta::parseSubstraitBlock: expect a "
+                        "string but got " +
+                        value.toString());
+    return s->getValue();
+}
+}; // namespace
+
+pair<shared_ptr<DataType>, shared_ptr<DataType>>
+BlockMeta::encodeStrings(const StringEnum::StringEnumList *dictionary,
+                         const DataType &low, const DataType &high,
+                         const string &attribute, int block_id,
+                         const Schema &table_schema,
+                         const TableStatistics *statistics)
+{
+    int lower = dictionary->lowerBound(stringValue(low));
+    int upper = dictionary->upperBound(stringValue(high)) - 1;
+    int offset = table_schema.getOffset(attribute);
+    if (statistics && statistics->hasRange(offset))
+    {
+        auto &range = *statistics->getRange(offset);
+        auto range_lower =
+            dynamic_cast<const StringEnum *>(range.lower());
+        auto range_upper =
+            dynamic_cast<const StringEnum *>(range.upper());
+        if (range_lower && range_upper)
+        {
+            lower = std::max(lower, range_lower->getIndex());
+            upper = std::min(upper, range_upper->getIndex());
+        }
+    }
+    if (lower > upper)
+        throw Exception("BlockMeta::encodeStrings: the range [" +
+                        low.toString() + ", " + high.toString() +
+                        "] of attribute " + attribute + " in block " +
+                        std::to_string(block_id) +
+                        " holds no string of the dictionary");
+    return {make_shared<StringEnum>(lower, dictionary),
+            make_shared<StringEnum>(upper, dictionary)};
+}
+
 shared_ptr<BlockMeta> BlockMeta::parseSubstraitBlock(
     const substrait::Partition_Block *serialized,
-    shared_ptr<const Schema> table_schema)
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics)
 {
     int bid = serialized->block_id();
     shared_ptr<Schema> block_schema = make_shared<Schema>();
@@ -364,23 +612,67 @@ shared_ptr<BlockMeta> BlockMeta::parseSubstraitBlock(
         block_schema->add(table_schema->get(a));
     }
 
-    unordered_map<string, shared_ptr<const Interval>> intervals;
+    IntervalMap intervals;
+    // the tuple ids may be listed as several intervals, the runs of
+    // tuple ids in the block. The boundary takes their hull, and the
+    // buckets are set by each run
+    int64_t tid_low = INT64_MAX, tid_high = INT64_MIN;
+    uint64_t tid_buckets = 0;
+    vector<pair<int64_t, int64_t>> tid_runs;
     for (int i = 0; i < serialized->boundary_size(); i++)
     {
         auto &interval = serialized->boundary(i);
-        auto &low = interval.low();
-        auto &high = interval.high();
-        shared_ptr<Interval> si = make_shared<Interval>(
-            DataType::parseSubstraitLiteral(&low), false,
-            DataType::parseSubstraitLiteral(&high), false);
-        intervals.emplace(interval.attribute(), std::move(si));
+        int offset = table_schema->getOffset(interval.attribute());
+        if (offset < 0)
+            throw Exception("BlockMeta::parseSubstraitBlock: attribute " +
+                            interval.attribute() +
+                            " is not in the table schema");
+        auto low = DataType::parseSubstraitLiteral(&interval.low());
+        auto high = DataType::parseSubstraitLiteral(&interval.high());
+        if (interval.attribute() == tuple_id_name &&
+            low->getType() == DATA_TYPE::INTEGER)
+        {
+            auto &l = static_cast<const Integer &>(*low);
+            auto &h = static_cast<const Integer &>(*high);
+            tid_low = std::min(tid_low, l.getValue());
+            tid_high = std::max(tid_high, h.getValue());
+            tid_buckets |= tidBuckets(l.getValue(), h.getValue(),
+                                      statistics.get());
+            tid_runs.emplace_back(l.getValue(), h.getValue());
+            if (intervals.erase(offset))
+            {
+                low = make_shared<Integer>(tid_low, l.getSize());
+                high = make_shared<Integer>(tid_high, h.getSize());
+            }
+        }
+        auto dictionary = table_schema->get(offset)->getDictionary();
+        if (dictionary)
+        {
+            auto codes =
+                encodeStrings(dictionary.get(), *low, *high,
+                              interval.attribute(), bid,
+                              *table_schema, statistics.get());
+            low = codes.first;
+            high = codes.second;
+        }
+        shared_ptr<Interval> si =
+            make_shared<Interval>(low, false, high, false);
+        intervals.emplace(offset, std::move(si));
     }
 
     int64_t row_num = -1;
     if (serialized->has_rows_num())
         row_num = serialized->rows_num();
-    return make_shared<BlockMeta>(bid, make_shared<Boundary>(intervals),
-                                  block_schema, nullptr, row_num);
+    auto block = make_shared<BlockMeta>(
+        bid, make_shared<Boundary>(intervals, statistics), block_schema,
+        nullptr, row_num);
+    if (block->hasTidRange())
+    {
+        block->tid_buckets = tid_buckets;
+        if (tid_runs.size() > 1)
+            block->tid_runs = std::move(tid_runs);
+    }
+    return block;
 }
 
 void BlockMeta::makeSubstraitBlock(
@@ -407,11 +699,32 @@ void BlockMeta::makeSubstraitBlock(
     if (this->row_num >= 0)
         mutable_out->set_rows_num(this->row_num);
 
-    auto intervals = this->boundary->getIntervals();
+    // the intervals are keyed by the table offsets of the attributes
+    if (!table_schema && this->boundary->getStatistics())
+        table_schema = this->boundary->getStatistics()->getSchema();
+    const auto &intervals = this->boundary->getIntervals();
+    if (!intervals.empty() && !table_schema)
+        throw Exception("BlockMeta::makeSubstraitBlock: the table "
+                        "schema is unknown");
     for (auto it = intervals.begin(); it != intervals.end(); it++)
     {
+        string name = table_schema->get(it->first)->getName();
+        if (name == tuple_id_name && !this->tid_runs.empty())
+        {
+            // one interval per run, parseSubstraitBlock takes the hull
+            for (const auto &run : this->tid_runs)
+            {
+                auto interval_out = mutable_out->add_boundary();
+                interval_out->set_attribute(name);
+                Integer(run.first, 64).makeSubstraitLiteral(
+                    interval_out->mutable_low());
+                Integer(run.second, 64).makeSubstraitLiteral(
+                    interval_out->mutable_high());
+            }
+            continue;
+        }
         auto interval_out = mutable_out->add_boundary();
-        interval_out->set_attribute(it->first);
+        interval_out->set_attribute(name);
         it->second->getMin()->makeSubstraitLiteral(
             interval_out->mutable_low());
         it->second->getMax()->makeSubstraitLiteral(
@@ -465,7 +778,8 @@ string findParquet(const string &path, const string &suffix)
 
 shared_ptr<PartitionMeta> PartitionMeta::parseSubstraitPartition(
     const substrait::Partition *serialized,
-    shared_ptr<const Schema> table_schema, string root_path,
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics, string root_path,
     bool find_file)
 {
     string path = serialized->path();
@@ -473,8 +787,8 @@ shared_ptr<PartitionMeta> PartitionMeta::parseSubstraitPartition(
     for (int i = 0; i < serialized->blocks_size(); i++)
     {
         auto &serialized_block = serialized->blocks(i);
-        auto b = BlockMeta::parseSubstraitBlock(&serialized_block,
-                                                table_schema);
+        auto b = BlockMeta::parseSubstraitBlock(
+            &serialized_block, table_schema, statistics);
         if (b->block_id < 0 || blocks[b->block_id])
             throw Exception("PartitionMeta::parseSubstraitPartition: "
                             "Invalid blocks");
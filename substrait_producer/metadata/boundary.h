@@ -2,21 +2,46 @@
 #include "metadata/expression.h"
 #include "metadata/interval.h"
 #include "metadata/schema.h"
+#include "metadata/statistics.h"
 #include "substrait/partition.pb.h"
 #include <cstring>
+#include <map>
+#include <memory_resource>
 #include <unordered_map>
 
 using namespace std;
 
 class ComplexBoundary;
 
+// the interval of each attribute of a boundary, keyed by the offset of
+// the attribute in the table schema
+typedef std::pmr::map<int, shared_ptr<const Interval>> IntervalMap;
+
 class Boundary
 {
   public:
-    Boundary(const unordered_map<string, shared_ptr<const Interval>>
-                 &intervals);
+    /**
+     * @brief Construct a boundary
+     *
+     * @param intervals the constraint on each attribute
+     * @param statistics the value range of the table. An attribute
+     * without an interval spans its full value range. Could be nullptr
+     * if the boundary is only compared with boundaries that have the
+     * statistics; the names of its attributes are then unknown.
+     */
+    Boundary(IntervalMap intervals,
+             shared_ptr<const TableStatistics> statistics);
 
-    Boundary *clone() const;
+    /**
+     * @brief Clone the boundary. The intervals are immutable and
+     * shared with the clone
+     *
+     * @param resource the memory resource of the interval map of the
+     * clone
+     * @return Boundary*
+     */
+    Boundary *clone(std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource()) const;
 
     string toString() const;
     /**
@@ -34,14 +59,27 @@ class Boundary
      */
     SET_RELATION relationship(const Boundary &other) const;
 
+    /**
+     * @brief compute the set relationship of this boundary to a complex
+     * boundary, see ComplexBoundary::relationship
+     *
+     * @param other
+     * @return SET_RELATION
+     */
+    SET_RELATION relationship(const ComplexBoundary &other) const;
+
     /**
      * @brief compute the intersection of two boundaries that are not
      * disjoint.
      *
      * @param other
+     * @param resource the memory resource of the result and its new
+     * intervals
      * @return Boundary
      */
-    Boundary intersect(const Boundary &other) const;
+    Boundary intersect(const Boundary &other,
+                       std::pmr::memory_resource *resource =
+                           std::pmr::get_default_resource()) const;
 
     double intersectionRatio(const Boundary &other) const;
 
@@ -62,25 +100,38 @@ class Boundary
                                        shared_ptr<DataType> point,
                                        bool point_target) const;
 
-    unordered_map<string, shared_ptr<const Interval>> getIntervals()
-        const
+    const IntervalMap &getIntervals() const
     {
         return intervals;
     }
 
+    shared_ptr<const TableStatistics> getStatistics() const
+    {
+        return statistics;
+    }
+
+    // the names of the attributes that have an interval
     unordered_set<string> getAttributes() const;
 
+    /**
+     * @brief Get the attributes that have an interval, keyed by their
+     * offsets in the table schema
+     *
+     * @return AttributeSet
+     */
+    AttributeSet getAttributeSet() const;
+
     bool isEmpty() const
     {
         return intervals.size() == 0;
     }
 
-    void erase(const string &attribute_name)
+    void erase(int offset)
     {
-        intervals.erase(attribute_name);
+        intervals.erase(offset);
     }
 
-    void keepAttributes(const unordered_set<string> &attributes);
+    void keepAttributes(const AttributeSet &attributes);
 
     shared_ptr<FunctionExpression> makeExpression() const;
 
@@ -99,7 +150,11 @@ class Boundary
         const vector<shared_ptr<const Boundary>> &boundaries);
 
   private:
-    unordered_map<string, shared_ptr<const Interval>> intervals;
+    IntervalMap intervals;
+    shared_ptr<const TableStatistics> statistics;
+
+    // the name of an attribute by its offset, from the statistics
+    string attributeName(int offset) const;
 };
 
 class PartitionMeta;
@@ -116,17 +171,23 @@ class BlockMeta
         this->schema = schema;
         this->partition = partition;
         this->row_num = row_num;
+        readTidRange();
     }
 
     BlockMeta *clone() const
     {
-        return new BlockMeta(this->block_id, this->boundary,
-                             this->schema, nullptr, this->row_num);
+        auto b = new BlockMeta(this->block_id, this->boundary,
+                               this->schema, nullptr, this->row_num);
+        b->sorted_by_tid = this->sorted_by_tid;
+        b->tid_runs = this->tid_runs;
+        b->tid_buckets = this->tid_buckets;
+        return b;
     }
 
     void setBoundary(shared_ptr<const Boundary> boundary)
     {
         this->boundary = boundary;
+        readTidRange();
     }
 
     void setSchema(shared_ptr<const Schema> schema)
@@ -144,9 +205,12 @@ class BlockMeta
      * @param attributes
      * @return SET_RELATION
      */
+    SET_RELATION relationship(shared_ptr<const Boundary> boundary,
+                              const AttributeSet &attributes) const;
+
     SET_RELATION relationship(
-        shared_ptr<const Boundary> boundary,
-        const unordered_set<string> &attributes) const;
+        shared_ptr<const ComplexBoundary> boundary,
+        const AttributeSet &attributes) const;
 
     shared_ptr<const Boundary> getBoundary() const
     {
@@ -168,28 +232,100 @@ class BlockMeta
         return block_id;
     }
 
+    bool hasRowNum() const
+    {
+        return row_num >= 0;
+    }
+
     int64_t getRowNum() const
     {
         assert(row_num >= 0);
         return row_num;
     }
 
-    int64_t estimateRowNum(const Boundary &boundary) const
+    /**
+     * @brief Check if the tuple ids of the block are known. The
+     * partition file carries them as the interval of the block on the
+     * tuple id, as the table range does for the table
+     */
+    bool hasTidRange() const
     {
-        if (row_num == -1)
-            return -1;
-        return row_num * this->boundary->intersectionRatio(boundary);
+        return tid_min >= 0;
     }
 
-    int64_t estimateRowNum(const ComplexBoundary &boundary) const
+    // the least and the greatest tuple id in the block
+    int64_t getTidMin() const
     {
-        if (row_num == -1)
-            return -1;
-        return row_num * this->boundary->intersectionRatio(boundary);
+        assert(hasTidRange());
+        return tid_min;
     }
 
-    size_t estimateIOSize(
-        const unordered_set<string> &attributes) const;
+    int64_t getTidMax() const
+    {
+        assert(hasTidRange());
+        return tid_max;
+    }
+
+    /**
+     * @brief Check if the tuples of the block are stored in the order
+     * of their tuple ids. The partition file has no field for the
+     * order, so only the block catalog records it; a block read from a
+     * partition file is taken as unordered
+     */
+    bool isSortedByTid() const
+    {
+        return sorted_by_tid;
+    }
+
+    void setSortedByTid(bool sorted)
+    {
+        sorted_by_tid = sorted;
+    }
+
+    /**
+     * @brief Set the tuple ids of the block from the tuple ids of its
+     * rows. The tuple ids are kept as at most kMaxTidRuns runs, closing
+     * the smallest gaps between the runs of consecutive ids. The hull
+     * of the runs becomes the interval of the boundary on the tuple id,
+     * and the partition file lists each run.
+     *
+     * @param tids the tuple ids of every row of the block in ascending
+     * order. The block is left unchanged if it has no row
+     */
+    void setTupleIDs(const vector<int64_t> &tids);
+
+    /**
+     * @brief Check if the block and the other block have no tuple in
+     * common, by their tuple id ranges and tuple id buckets. The table
+     * range of the tuple id is split into 64 buckets, and a block is in
+     * every bucket one of its tuple ids falls in. Two blocks whose
+     * ranges overlap are still disjoint if they share no bucket.
+     *
+     * @param other a block of the same layout
+     * @return bool false if either block has no tuple id range
+     */
+    bool tidDisjoint(const BlockMeta &other) const
+    {
+        if (!hasTidRange() || !other.hasTidRange())
+            return false;
+        return tid_max < other.tid_min || other.tid_max < tid_min ||
+               (tid_buckets & other.tid_buckets) == 0;
+    }
+
+    /**
+     * @brief Estimate the rows of the block in a boundary. The rows
+     * are counted on the row sample of the table if the statistics
+     * have one that covers the boundaries, otherwise the values are
+     * assumed to be uniform and independent.
+     *
+     * @param boundary
+     * @return int64_t -1 if the row number of the block is unknown
+     */
+    int64_t estimateRowNum(const Boundary &boundary) const;
+
+    int64_t estimateRowNum(const ComplexBoundary &boundary) const;
+
+    size_t estimateIOSize(const AttributeSet &attributes) const;
 
     /**
      * @brief split the block into two blocks by the input value
@@ -208,21 +344,63 @@ class BlockMeta
 
     static shared_ptr<BlockMeta> parseSubstraitBlock(
         const substrait::Partition_Block *serialized,
-        shared_ptr<const Schema> table_schema);
+        shared_ptr<const Schema> table_schema,
+        shared_ptr<const TableStatistics> statistics);
+
+    /**
+     * @brief Encode the string end points of a block with the
+     * dictionary of the attribute. The lower end point is mapped to the
+     * first string that is not less than it, and the upper end point to
+     * the last string that is not greater than it; the codes are
+     * clamped to the table range. A range that holds no string of the
+     * dictionary is rejected.
+     *
+     * @param dictionary
+     * @param low the lower end point as a string
+     * @param high the upper end point as a string
+     * @param attribute
+     * @param block_id
+     * @param table_schema
+     * @param statistics the value range of the table, can be null
+     * @return pair<shared_ptr<DataType>, shared_ptr<DataType>> the
+     * encoded end points
+     */
+    static pair<shared_ptr<DataType>, shared_ptr<DataType>>
+    encodeStrings(const StringEnum::StringEnumList *dictionary,
+                  const DataType &low, const DataType &high,
+                  const string &attribute, int block_id,
+                  const Schema &table_schema,
+                  const TableStatistics *statistics);
 
     void makeSubstraitBlock(
         substrait::Partition_Block *mutable_out,
         shared_ptr<const Schema> table_schema = nullptr) const;
 
+    // the most runs of tuple ids that a block lists
+    static constexpr size_t kMaxTidRuns = 64;
+
   private:
     shared_ptr<const Boundary> boundary;
     shared_ptr<const Schema> schema;
     int block_id;
     int64_t row_num = -1;
+    // -1 if the boundary has no interval on the tuple id
+    int64_t tid_min = -1;
+    int64_t tid_max = -1;
+    // bit i is set if a tuple id of the block is in bucket i of the
+    // table range
+    uint64_t tid_buckets = ~0ULL;
+    // the runs of tuple ids within [tid_min, tid_max], empty if the
+    // block only has the range
+    vector<pair<int64_t, int64_t>> tid_runs;
+    bool sorted_by_tid = false;
 
     const PartitionMeta *partition;
 
+    void readTidRange();
+
     friend class PartitionMeta;
+    friend class BlockCatalog;
 };
 
 class PartitionMeta
@@ -233,6 +411,20 @@ class PartitionMeta
         this->file_path = path;
     }
 
+    /**
+     * @brief A partition that lists some blocks of another partition,
+     * e.g. the blocks of a query selected from a BlockCatalog. The
+     * blocks keep their ids and their partition.
+     *
+     * @param path
+     * @param blocks
+     */
+    PartitionMeta(const string &path,
+                  vector<shared_ptr<const BlockMeta>> blocks)
+        : blocks(std::move(blocks)), file_path(path)
+    {
+    }
+
     vector<shared_ptr<const BlockMeta>> getBlocks() const
     {
         return blocks;
@@ -257,6 +449,7 @@ class PartitionMeta
      *
      * @param serialized
      * @param table_schema
+     * @param statistics the value range of the table
      * @param root_path
      * @param find_file True if the function checks the boundary path is
      * a parquet file or a directory that only contains one parquet
@@ -265,7 +458,8 @@ class PartitionMeta
      */
     static shared_ptr<PartitionMeta> parseSubstraitPartition(
         const substrait::Partition *serialized,
-        shared_ptr<const Schema> table_schema, string root_path,
+        shared_ptr<const Schema> table_schema,
+        shared_ptr<const TableStatistics> statistics, string root_path,
         bool find_file = false);
 
     void makeSubstraitPartition(
@@ -275,4 +469,14 @@ class PartitionMeta
   private:
     vector<shared_ptr<const BlockMeta>> blocks;
     string file_path;
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Resolve the path of a partition to its data file
+ *
+ * @param path a file with the suffix, or a directory that only contains
+ * one file with the suffix
+ * @param suffix
+ * @return string the path of the file
+ */
+string findParquet(const string &path, const string &suffix);
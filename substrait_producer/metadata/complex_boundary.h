@@ -1,21 +1,66 @@
 #pragma once
 #include "metadata/boundary.h"
+#include "metadata/interval_list.h"
 
 using namespace std;
 
+// the interval list of each attribute of a complex boundary, keyed by
+// the offset of the attribute in the table schema
+typedef std::pmr::map<int, IntervalList> IntervalListMap;
+
 class ComplexBoundary
 {
   public:
+    // the default number of intervals per attribute kept when
+    // unioning the filters requested from a block
+    static constexpr int kMaxIntervalsPerAttribute = 16;
+
+    /**
+     * @brief Union a set of boundaries. The intervals on each attribute
+     * are normalized in O(n log n); if an attribute still has more than
+     * max_intervals_per_attribute intervals, the smallest gaps between
+     * them are filled.
+     *
+     * @param boundaries
+     * @param max_intervals_per_attribute
+     * @param resource the memory resource of the result
+     * @return shared_ptr<ComplexBoundary>
+     */
     static shared_ptr<ComplexBoundary> makeComplexBoundary(
-        const vector<shared_ptr<const Boundary>> &boundaries,
-        int max_intervals_per_attribute);
+        const vector<shared_ptr<const ComplexBoundary>> &boundaries,
+        int max_intervals_per_attribute,
+        std::pmr::memory_resource *resource =
+            std::pmr::get_default_resource());
 
-    ComplexBoundary(const Boundary &b);
-    ComplexBoundary(const ComplexBoundary &b) : intervals(b.intervals)
+    /**
+     * @brief Construct a complex boundary
+     *
+     * @param intervals the normalized interval list on each
+     * attribute. An empty list admits no value, so the boundary is
+     * disjoint with every other boundary. The boundary keeps its
+     * memory resource
+     * @param statistics the value range of the table
+     */
+    ComplexBoundary(IntervalListMap intervals,
+                    shared_ptr<const TableStatistics> statistics)
+        : intervals(std::move(intervals)), statistics(statistics)
     {
     }
 
-    void keepAttributes(const unordered_set<string> &attributes);
+    ComplexBoundary(const Boundary &b,
+                    std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource());
+    ComplexBoundary(const ComplexBoundary &b) = default;
+    ComplexBoundary(ComplexBoundary &&b) = default;
+
+    // copy a boundary into a memory resource
+    ComplexBoundary(const ComplexBoundary &b,
+                    std::pmr::memory_resource *resource)
+        : intervals(b.intervals, resource), statistics(b.statistics)
+    {
+    }
+
+    void keepAttributes(const AttributeSet &attributes);
 
     /**
      * @brief Compute the set relationship of complex and plain
@@ -32,45 +77,69 @@ class ComplexBoundary
      */
     SET_RELATION relationship(const Boundary &boundary) const;
 
+    /**
+     * @brief Compute the exact set relationship of two complex
+     * boundaries. Each attribute is compared as a set of values.
+     *
+     * @param other
+     * @return SET_RELATION
+     */
+    SET_RELATION relationship(const ComplexBoundary &other) const;
+
     shared_ptr<FunctionExpression> makeExpression() const;
 
-    ComplexBoundary intersect(const Boundary &other) const;
+    ComplexBoundary intersect(
+        const Boundary &other,
+        std::pmr::memory_resource *resource =
+            std::pmr::get_default_resource()) const;
 
-    unordered_map<string, vector<shared_ptr<const Interval>>>
-    getIntervals() const
+    /**
+     * @brief compute the intersection of two boundaries that are not
+     * disjoint.
+     *
+     * @param other
+     * @param resource the memory resource of the result and its new
+     * intervals
+     * @return ComplexBoundary
+     */
+    ComplexBoundary intersect(
+        const ComplexBoundary &other,
+        std::pmr::memory_resource *resource =
+            std::pmr::get_default_resource()) const;
+
+    string toString() const;
+
+    // the names of the attributes that have intervals
+    unordered_set<string> getAttributes() const;
+
+    /**
+     * @brief Get the attributes that have intervals, keyed by their
+     * offsets in the table schema
+     *
+     * @return AttributeSet
+     */
+    AttributeSet getAttributeSet() const;
+
+    const IntervalListMap &getIntervals() const
     {
         return intervals;
     }
 
-  private:
-    ComplexBoundary()
+    shared_ptr<const TableStatistics> getStatistics() const
     {
+        return statistics;
     }
-    ComplexBoundary(
-        const unordered_map<string, vector<shared_ptr<const Interval>>>
-            &intervals)
-        : intervals(intervals)
+
+  private:
+    explicit ComplexBoundary(std::pmr::memory_resource *resource)
+        : intervals(resource)
     {
     }
 
-    // each attribute has a set of disjoint intervals
-    unordered_map<string, vector<shared_ptr<const Interval>>> intervals;
+    // each attribute has a normalized list of intervals
+    IntervalListMap intervals;
+    shared_ptr<const TableStatistics> statistics;
 
-    /**
-     * @brief compute the relationship between an interval and a vector
-     * of interval
-     *
-     * @param complex
-     * @param plain
-     * @return SET_RELATION DISJOINT: all intervals in the vector are
-     * disjoint with the plain; EQUAL: the vector has a single interval
-     * and the interval is equal to the plain; SUBSET: all intervals in
-     * the vector are the subset of the plain; SUPERSET: an interval is
-     * the superset of the plain; or the vector has at least two
-     * intervals and one interval is equal to the plain; INTERSECT:
-     * other cases
-     */
-    SET_RELATION relationship(
-        const vector<shared_ptr<const Interval>> &complex,
-        shared_ptr<const Interval> plain) const;
+    // the name of an attribute by its offset, from the statistics
+    string attributeName(int offset) const;
 };
\ No newline at end of file
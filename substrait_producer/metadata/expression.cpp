@@ -2,6 +2,138 @@
 #include "exceptions.h"
 #include "metadata/schema.h"
 #include "produce_plan/build_substrait.h"
+#include <boost/functional/hash.hpp>
+#include <mutex>
+#include <typeinfo>
+
+namespace
+{
+// the live interned nodes by their hashes, split by the hashes into
+// shards so that the threads planning queries rarely wait for each
+// other. Equal nodes have equal hashes, so they meet in one shard.
+// Expired entries are swept when a shard doubles
+struct PoolShard
+{
+    std::mutex mutex;
+    unordered_multimap<size_t, weak_ptr<const Expression>> nodes;
+    size_t sweep_size = 64;
+
+    void sweep()
+    {
+        for (auto it = nodes.begin(); it != nodes.end();)
+            if (it->second.expired())
+                it = nodes.erase(it);
+            else
+                it++;
+        sweep_size = std::max((size_t)64, nodes.size() * 2);
+    }
+};
+constexpr size_t kPoolShards = 64;
+PoolShard expression_pool[kPoolShards];
+}; // namespace
+
+shared_ptr<const Expression> Expression::internNode(
+    shared_ptr<const Expression> e)
+{
+    if (!e)
+        return e;
+
+    // share the children first and build the node on them, so that
+    // the node is compared to the pooled nodes by its own fields and
+    // the pointers of its children
+    vector<shared_ptr<const Expression>> children;
+    bool changed = false;
+    for (const auto &c : e->children)
+    {
+        children.push_back(internNode(c));
+        changed |= children.back() != c;
+    }
+    if (changed)
+    {
+        shared_ptr<Expression> copy(e->clone());
+        copy->children = std::move(children);
+        e = copy;
+    }
+
+    auto &shard = expression_pool[e->hash_value % kPoolShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.nodes.equal_range(e->hash_value);
+    for (auto it = range.first; it != range.second; it++)
+    {
+        auto pooled = it->second.lock();
+        if (pooled && typeid(*pooled) == typeid(*e) &&
+            pooled->children == e->children && pooled->equalTo(*e))
+            return pooled;
+    }
+
+    if (shard.nodes.size() >= shard.sweep_size)
+        shard.sweep();
+    shard.nodes.emplace(e->hash_value, e);
+    e->interned.store(true, std::memory_order_relaxed);
+    return e;
+}
+
+bool Expression::matchShape(const shared_ptr<const Expression> &e,
+                            const Expression &pattern,
+                            vector<shared_ptr<const Expression>> &nodes)
+{
+    if (e->shape_hash != pattern.shape_hash ||
+        !e->equalShapeTo(pattern) ||
+        e->children.size() != pattern.children.size())
+        return false;
+    nodes.push_back(e);
+    for (int i = 0; i < e->children.size(); i++)
+        if (!matchShape(e->children[i], *pattern.children[i], nodes))
+            return false;
+    return true;
+}
+
+size_t Attribute::computeHash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, name);
+    boost::hash_combine(seed, (int)type);
+    return seed;
+}
+
+size_t FunctionExpression::computeHash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, op);
+    boost::hash_combine(seed, (int)type);
+    boost::hash_combine(seed, nullable);
+    for (const auto &c : children)
+        boost::hash_combine(seed, c->getHash());
+    return seed;
+}
+
+size_t FunctionExpression::computeShapeHash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, op);
+    boost::hash_combine(seed, (int)type);
+    boost::hash_combine(seed, nullable);
+    for (const auto &c : children)
+        boost::hash_combine(seed, c->getShapeHash());
+    return seed;
+}
+
+size_t Literal::computeHash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, (int)type);
+    boost::hash_combine(seed, value->toString());
+    return seed;
+}
+
+size_t Literal::computeShapeHash() const
+{
+    if (type == DATA_TYPE::BOOLEAN)
+        return computeHash();
+    size_t seed = 0;
+    boost::hash_combine(seed, (int)type);
+    return seed;
+}
 
 void Attribute::makeSubstraitExpression(
     substrait::Expression *mutable_out,
@@ -76,16 +208,10 @@ void FunctionExpression::makeSubstraitExpression(
 
 bool FunctionExpression::isAndOnly(const string &and_op) const
 {
+    // any predicate that is not connected by and_op is a leaf, e.g. a
+    // comparison or a disjunction of comparisons
     if (this->op != and_op)
-    {
-        for (auto e : children)
-        {
-            if (dynamic_cast<const Attribute *>(e.get()) == nullptr &&
-                dynamic_cast<const Literal *>(e.get()) == nullptr)
-                return false;
-        }
         return true;
-    }
 
     for (auto e : children)
     {
@@ -185,6 +311,8 @@ Literal::Literal(const string &name, DATA_TYPE type)
                         type);
         break;
     }
+    hash_value = computeHash();
+    shape_hash = computeShapeHash();
 }
 
 void Literal::makeSubstraitExpression(
@@ -214,6 +342,10 @@ shared_ptr<Expression> Expression::parseSubstraitExpression(
         return FunctionExpression::parseSubstraitExpression(
             serialized, table_schema, function_anchor);
         break;
+    case rex_type::kSingularOrList:
+        return FunctionExpression::parseSubstraitOrList(
+            serialized, table_schema, function_anchor);
+        break;
     default:
         throw Exception("Expression::parseSubstraitExpression: unknown "
                         "expression type " +
@@ -240,10 +372,12 @@ shared_ptr<Attribute> Attribute::parseSubstraitExpression(
             "direct_reference.struct_field and root_reference");
     int index = a.direct_reference().struct_field().field();
     auto attr = table_schema->get(index);
-    return make_shared<Attribute>(attr->getName(), attr->getType());
+    auto ret = make_shared<Attribute>(attr->getName(), attr->getType());
+    ret->setTableOffset(attr->getTableOffset());
+    return ret;
 }
 
-int Literal::substrait_op_id = 0;
+std::atomic<int> Literal::substrait_op_id(0);
 
 shared_ptr<Literal> Literal::parseSubstraitExpression(
     const substrait::Expression *serialized,
@@ -259,7 +393,7 @@ shared_ptr<Literal> Literal::parseSubstraitExpression(
                                 DataType::parseSubstraitLiteral(&l));
 }
 
-int FunctionExpression::substrait_op_id = 0;
+std::atomic<int> FunctionExpression::substrait_op_id(0);
 
 shared_ptr<FunctionExpression> FunctionExpression::
     parseSubstraitExpression(
@@ -292,12 +426,69 @@ shared_ptr<FunctionExpression> FunctionExpression::
     bool nullability;
     DATA_TYPE out_type = parseSubstraitType(&t, nullability);
 
+    if (op == "between")
+    {
+        // rewrite between(x, low, high) to gte(x, low) and lte(x, high)
+        // so that the consumers only see the comparisons they support
+        if (args.size() != 3)
+            throw Exception(
+                "FunctionExpression::parseSubstraitExpression: "
+                "between expects 3 arguments");
+        vector<shared_ptr<const Expression>> bounds{
+            make_shared<FunctionExpression>(
+                "gte_" + std::to_string(substrait_op_id++), "gte",
+                vector<shared_ptr<const Expression>>{args[0], args[1]},
+                out_type, nullability),
+            make_shared<FunctionExpression>(
+                "lte_" + std::to_string(substrait_op_id++), "lte",
+                vector<shared_ptr<const Expression>>{args[0], args[2]},
+                out_type, nullability)};
+        return make_shared<FunctionExpression>(
+            "and_" + std::to_string(substrait_op_id++), "and", bounds,
+            out_type, nullability);
+    }
+
     return make_shared<FunctionExpression>(
         op + "_" + std::to_string(substrait_op_id++), op, args,
         out_type, nullability);
 }
 
-int AggregateExpression::substrait_op_id = 0;
+shared_ptr<FunctionExpression> FunctionExpression::parseSubstraitOrList(
+    const substrait::Expression *serialized,
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const unordered_map<int, string>> function_anchor)
+{
+    if (!serialized->has_singular_or_list())
+        throw Exception("FunctionExpression::parseSubstraitOrList: "
+                        "substrait expression must be SingularOrList");
+    auto &l = serialized->singular_or_list();
+    if (l.options_size() == 0)
+        throw Exception("FunctionExpression::parseSubstraitOrList: "
+                        "expect at least one option");
+
+    // rewrite x IN (v0, v1, ...) to equal(x, v0) or equal(x, v1) ...
+    auto value = Expression::parseSubstraitExpression(
+        &l.value(), table_schema, function_anchor);
+    vector<shared_ptr<const Expression>> options;
+    shared_ptr<FunctionExpression> equal;
+    for (int i = 0; i < l.options_size(); i++)
+    {
+        auto option = Expression::parseSubstraitExpression(
+            &l.options(i), table_schema, function_anchor);
+        equal = make_shared<FunctionExpression>(
+            "equal_" + std::to_string(substrait_op_id++), "equal",
+            vector<shared_ptr<const Expression>>{value, option},
+            DATA_TYPE::BOOLEAN, true);
+        options.push_back(equal);
+    }
+    if (options.size() == 1)
+        return equal;
+    return connectExpression(
+        "or_" + std::to_string(substrait_op_id++), options, true,
+        false);
+}
+
+std::atomic<int> AggregateExpression::substrait_op_id(0);
 
 shared_ptr<AggregateExpression> AggregateExpression::
     parseSubstraitAggregate(
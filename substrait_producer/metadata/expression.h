@@ -1,6 +1,7 @@
 #pragma once
 #include "data_type/data_type_api.h"
 #include "substrait/plan.pb.h"
+#include <atomic>
 #include <optional>
 #include <string.h>
 #include <unordered_set>
@@ -32,11 +33,94 @@ class Expression
     void setName(string name)
     {
         this->name = name;
+        hash_value = computeHash();
+        shape_hash = computeShapeHash();
     }
 
     virtual Expression *clone() const = 0;
     virtual unordered_set<string> getAttributes() const = 0;
-    virtual bool equal(shared_ptr<const Expression> other) const = 0;
+
+    /**
+     * @brief The structural hash of the expression, computed when the
+     * node is built from its own fields and the hashes of its children.
+     * Equal expressions have the same hash.
+     */
+    size_t getHash() const
+    {
+        return hash_value;
+    }
+
+    /**
+     * @brief The hash of the shape of the expression: the structural
+     * hash with the values of the literals left out, except the
+     * booleans, which connectExpression uses as operands. Expressions
+     * that differ only in the values of their literals have the same
+     * shape hash.
+     */
+    size_t getShapeHash() const
+    {
+        return shape_hash;
+    }
+
+    /**
+     * @brief Compare the shape of an expression with a pattern, i.e.
+     * compare their structure but not the values of the literals other
+     * than the booleans
+     *
+     * @param e
+     * @param pattern
+     * @param nodes OUTPUT: the nodes of e are appended in preorder, as
+     * far as the shapes match
+     * @return true if e has the shape of the pattern
+     */
+    static bool matchShape(const shared_ptr<const Expression> &e,
+                           const Expression &pattern,
+                           vector<shared_ptr<const Expression>> &nodes);
+
+    /**
+     * @brief Compare the structure of two expressions. Shared nodes,
+     * two interned nodes and nodes with different hashes are decided
+     * without walking the trees.
+     *
+     * @param other
+     * @return true
+     * @return false
+     */
+    bool equal(shared_ptr<const Expression> other) const
+    {
+        if (other.get() == this)
+            return true;
+        if (!other || other->hash_value != hash_value)
+            return false;
+        // the pool keeps one live node per structure
+        if (interned.load(std::memory_order_relaxed) &&
+            other->interned.load(std::memory_order_relaxed))
+            return false;
+        if (!equalTo(*other) ||
+            children.size() != other->children.size())
+            return false;
+        for (int i = 0; i < children.size(); i++)
+            if (!children[i]->equal(other->children[i]))
+                return false;
+        return true;
+    }
+
+    /**
+     * @brief Hash-cons an expression. The children are interned first,
+     * then the live node equal to the expression is returned, or the
+     * expression is registered if there is none, so that equal subtrees
+     * share one node and compare by pointer. The names of the returned
+     * nodes can differ from the input, so only intern expressions whose
+     * names are not used, e.g. filters.
+     *
+     * @param e
+     * @return shared_ptr<const T> a node of the same class as e
+     */
+    template <typename T>
+    static shared_ptr<const T> intern(shared_ptr<const T> e)
+    {
+        return static_pointer_cast<const T>(internNode(e));
+    }
 
     virtual void makeSubstraitExpression(
         substrait::Expression *mutable_out,
@@ -48,9 +132,44 @@ class Expression
         shared_ptr<const unordered_map<int, string>> function_anchor);
 
   protected:
+    Expression() = default;
+    // a copy is a new node, which is not interned
+    Expression(const Expression &other)
+        : children(other.children), type(other.type), name(other.name),
+          hash_value(other.hash_value), shape_hash(other.shape_hash)
+    {
+    }
+
     vector<shared_ptr<const Expression>> children;
     DATA_TYPE type;
     string name;
+    size_t hash_value = 0;
+    size_t shape_hash = 0;
+    // set once the node is registered in the intern pool. Atomic, as a
+    // node shared by the threads is interned by any of them
+    mutable std::atomic<bool> interned{false};
+
+    // the hash of the fields compared by equalTo
+    virtual size_t computeHash() const = 0;
+
+    // the hash of the fields compared by equalShapeTo
+    virtual size_t computeShapeHash() const
+    {
+        return computeHash();
+    }
+
+    // compare the fields of two nodes that decide their shapes
+    virtual bool equalShapeTo(const Expression &other) const
+    {
+        return equalTo(other);
+    }
+
+    // compare the fields of two nodes with the same hash, but not
+    // their children
+    virtual bool equalTo(const Expression &other) const = 0;
+
+    static shared_ptr<const Expression> internNode(
+        shared_ptr<const Expression> e);
 };
 
 class Attribute : public Expression
@@ -63,6 +182,8 @@ class Attribute : public Expression
         this->type = type;
         if (size.has_value())
             this->size = size;
+        hash_value = computeHash();
+        shape_hash = computeShapeHash();
     }
 
     string toString() const
@@ -92,24 +213,59 @@ class Attribute : public Expression
         return new Attribute(this->name, this->type);
     }
 
-    bool equal(shared_ptr<const Expression> other) const
+    void makeSubstraitExpression(substrait::Expression *mutable_out,
+                                 shared_ptr<const Schema> schema) const;
+
+    /**
+     * @brief The offset of the attribute in the table schema. -1 if the
+     * attribute is not a table attribute, e.g. a derived column.
+     */
+    int getTableOffset() const
     {
-        auto o = dynamic_cast<const Attribute *>(other.get());
-        if (o == nullptr)
-            return false;
-        return this->name == o->name && this->type == o->type;
+        return table_offset;
     }
 
-    void makeSubstraitExpression(substrait::Expression *mutable_out,
-                                 shared_ptr<const Schema> schema) const;
+    void setTableOffset(int offset)
+    {
+        table_offset = offset;
+    }
+
+    /**
+     * @brief The sorted dictionary of a string attribute. nullptr if
+     * the attribute does not have one; its values are then compared as
+     * plain strings and cannot be split.
+     */
+    shared_ptr<const StringEnum::StringEnumList> getDictionary() const
+    {
+        return dictionary;
+    }
+
+    void setDictionary(
+        shared_ptr<const StringEnum::StringEnumList> dictionary)
+    {
+        this->dictionary = dictionary;
+    }
 
     static shared_ptr<Attribute> parseSubstraitExpression(
         const substrait::Expression *serialized,
         shared_ptr<const Schema> table_schema,
         shared_ptr<const unordered_map<int, string>> function_anchor);
 
+  protected:
+    size_t computeHash() const;
+
+    bool equalTo(const Expression &other) const
+    {
+        auto o = dynamic_cast<const Attribute *>(&other);
+        if (o == nullptr)
+            return false;
+        return this->name == o->name && this->type == o->type;
+    }
+
   private:
     optional<size_t> size;
+    int table_offset = -1;
+    shared_ptr<const StringEnum::StringEnumList> dictionary;
 };
 
 class FunctionExpression : public Expression
@@ -125,6 +281,8 @@ class FunctionExpression : public Expression
         this->children = children;
         this->type = type;
         this->nullable = nullable;
+        hash_value = computeHash();
+        shape_hash = computeShapeHash();
     }
 
     string toString() const
@@ -167,21 +325,6 @@ class FunctionExpression : public Expression
         return ret;
     }
 
-    bool equal(shared_ptr<const Expression> other) const
-    {
-        auto o = dynamic_cast<const FunctionExpression *>(other.get());
-        if (o == nullptr)
-            return false;
-        if (this->op != o->op || this->nullable != o->nullable ||
-            this->type != o->type ||
-            this->children.size() != o->children.size())
-            return false;
-        for (int i = 0; i < children.size(); i++)
-            if (children[i]->equal(o->children[i]) == false)
-                return false;
-        return true;
-    }
-
     virtual void makeSubstraitExpression(
         substrait::Expression *mutable_out,
         shared_ptr<const Schema> schema) const;
@@ -196,10 +339,35 @@ class FunctionExpression : public Expression
         shared_ptr<const Schema> table_schema,
         shared_ptr<const unordered_map<int, string>> function_anchor);
 
+    /**
+     * @brief Parse an IN list as a disjunction of equal comparisons
+     *
+     * @param serialized a SingularOrList expression
+     * @param table_schema
+     * @param function_anchor
+     * @return shared_ptr<FunctionExpression>
+     */
+    static shared_ptr<FunctionExpression> parseSubstraitOrList(
+        const substrait::Expression *serialized,
+        shared_ptr<const Schema> table_schema,
+        shared_ptr<const unordered_map<int, string>> function_anchor);
+
   protected:
     string op;
     bool nullable;
-    static int substrait_op_id;
+    static std::atomic<int> substrait_op_id;
+
+    size_t computeHash() const;
+    size_t computeShapeHash() const;
+
+    bool equalTo(const Expression &other) const
+    {
+        auto o = dynamic_cast<const FunctionExpression *>(&other);
+        if (o == nullptr)
+            return false;
+        return this->op == o->op && this->nullable == o->nullable &&
+               this->type == o->type;
+    }
 };
 
 class AggregateExpression : public FunctionExpression
@@ -227,7 +395,7 @@ class AggregateExpression : public FunctionExpression
         shared_ptr<const unordered_map<int, string>> function_anchor);
 
   private:
-    static int substrait_op_id;
+    static std::atomic<int> substrait_op_id;
 };
 
 class IfFunctionExpression : public FunctionExpression
@@ -261,6 +429,8 @@ class Literal : public Expression
         this->name = name;
         this->value = value;
         this->type = value->getType();
+        hash_value = computeHash();
+        shape_hash = computeShapeHash();
     }
 
     Literal(const string &name, DATA_TYPE type);
@@ -282,14 +452,6 @@ class Literal : public Expression
         return this->value;
     }
 
-    bool equal(shared_ptr<const Expression> other) const
-    {
-        auto o = dynamic_cast<const Literal *>(other.get());
-        if (o == nullptr)
-            return false;
-        return o->value->cmp(this->value.get()) == 0;
-    }
-
     void makeSubstraitExpression(substrait::Expression *mutable_out,
                                  shared_ptr<const Schema> schema) const;
 
@@ -298,8 +460,30 @@ class Literal : public Expression
         shared_ptr<const Schema> table_schema,
         shared_ptr<const unordered_map<int, string>> function_anchor);
 
+  protected:
+    size_t computeHash() const;
+
+    bool equalTo(const Expression &other) const
+    {
+        auto o = dynamic_cast<const Literal *>(&other);
+        if (o == nullptr)
+            return false;
+        return o->value->cmp(this->value.get()) == 0;
+    }
+
+    size_t computeShapeHash() const;
+
+    // a literal other than a boolean has the shape of its type
+    bool equalShapeTo(const Expression &other) const
+    {
+        auto o = dynamic_cast<const Literal *>(&other);
+        if (o == nullptr || o->type != this->type)
+            return false;
+        return this->type != DATA_TYPE::BOOLEAN || equalTo(other);
+    }
+
   private:
     shared_ptr<DataType> value;
 
-    static int substrait_op_id;
+    static std::atomic<int> substrait_op_id;
 };
\ No newline at end of file
@@ -33,7 +33,7 @@ Interval::Interval(double left_value, bool left_open,
 
 Interval::Interval(const std::string &left_value, bool left_open,
                    const std::string &right_value, bool right_open,
-                   StringEnum::StringEnumList *allStrings)
+                   const StringEnum::StringEnumList *allStrings)
 {
     StringEnum *s1 = new StringEnum(left_value, allStrings);
     StringEnum *s2 = new StringEnum(right_value, allStrings);
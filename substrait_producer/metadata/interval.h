@@ -13,7 +13,7 @@ class Interval
              bool right_open, int precision);
     Interval(const std::string &left_value, bool left_open,
              const std::string &right_value, bool right_open,
-             StringEnum::StringEnumList *allStrings);
+             const StringEnum::StringEnumList *allStrings);
     Interval(shared_ptr<const DataType> left_value, bool left_open,
              shared_ptr<const DataType> right_value, bool right_open);
 
@@ -27,6 +27,17 @@ class Interval
     shared_ptr<DataType> getMin() const;
     shared_ptr<DataType> getMax() const;
 
+    // the end points without copying. Both are inclusive
+    const DataType *lower() const
+    {
+        return value[0];
+    }
+
+    const DataType *upper() const
+    {
+        return value[1];
+    }
+
     DATA_TYPE getType() const
     {
         return value[0]->getType();
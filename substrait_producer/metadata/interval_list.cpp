@@ -0,0 +1,304 @@
+#include "metadata/interval_list.h"
+#include "arena.h"
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
+namespace interval_list
+{
+namespace
+{
+shared_ptr<const Interval>
+makeInterval(const DataType *lower, const DataType *upper,
+             std::pmr::memory_resource *resource)
+{
+    return makeArenaShared<Interval>(
+        resource, shared_ptr<const DataType>(lower->clone()), false,
+        shared_ptr<const DataType>(upper->clone()), false);
+}
+
+// true if lower is the value right after upper
+bool isAdjacent(const DataType *upper, const DataType *lower)
+{
+    // plain strings without a dictionary have no previous value
+    if (lower->getType() == DATA_TYPE::STRING)
+        return false;
+    unique_ptr<DataType> p(lower->clone());
+    return p->prev() && p->cmp(upper) == 0;
+}
+
+// union the overlapping or adjacent neighbors of a list that is sorted
+// by the lower end points
+IntervalList unionSorted(const IntervalList &sorted,
+                         std::pmr::memory_resource *resource)
+{
+    IntervalList result(resource);
+    if (sorted.empty())
+        return result;
+    result.reserve(sorted.size());
+
+    size_t start = 0;
+    const DataType *upper = sorted[0]->upper();
+    auto flush = [&](size_t end) {
+        if (end - start == 1 || sorted[start]->upper() == upper)
+            // the first interval covers the group
+            result.push_back(sorted[start]);
+        else
+            result.push_back(
+                makeInterval(sorted[start]->lower(), upper, resource));
+    };
+    for (size_t i = 1; i < sorted.size(); i++)
+    {
+        const DataType *lower = sorted[i]->lower();
+        if (lower->cmp(upper) <= 0 || isAdjacent(upper, lower))
+        {
+            upper = upper->max(sorted[i]->upper());
+            continue;
+        }
+        flush(i);
+        start = i;
+        upper = sorted[i]->upper();
+    }
+    flush(sorted.size());
+    return result;
+}
+
+bool lowerLess(const shared_ptr<const Interval> &a,
+               const shared_ptr<const Interval> &b)
+{
+    return a->lower()->cmp(b->lower()) < 0;
+}
+
+// the first interval in the list whose upper end point is not less
+// than value
+IntervalList::const_iterator firstNotBefore(const IntervalList &list,
+                                            const DataType *value)
+{
+    return std::partition_point(
+        list.begin(), list.end(),
+        [value](const shared_ptr<const Interval> &i) {
+            return i->upper()->cmp(value) < 0;
+        });
+}
+
+// true if each interval of inner is in an interval of outer. The
+// neighbors of a normalized list are not adjacent, so an interval in
+// the union of outer is in a single interval of outer
+bool covers(const IntervalList &outer, const IntervalList &inner)
+{
+    size_t j = 0;
+    for (const auto &x : inner)
+    {
+        // the only interval that can cover x is the first one that
+        // does not end before x
+        while (j < outer.size() &&
+               outer[j]->upper()->cmp(x->upper()) < 0)
+            j++;
+        if (j == outer.size() || outer[j]->lower()->cmp(x->lower()) > 0)
+            return false;
+    }
+    return true;
+}
+}; // namespace
+
+IntervalList normalize(IntervalList intervals,
+                       std::pmr::memory_resource *resource)
+{
+    std::sort(intervals.begin(), intervals.end(), lowerLess);
+    return unionSorted(intervals, resource);
+}
+
+IntervalList Union(const IntervalList &a, const IntervalList &b,
+                   std::pmr::memory_resource *resource)
+{
+    IntervalList merged(resource);
+    merged.reserve(a.size() + b.size());
+    std::merge(a.begin(), a.end(), b.begin(), b.end(),
+               std::back_inserter(merged), lowerLess);
+    return unionSorted(merged, resource);
+}
+
+IntervalList intersect(const IntervalList &a, const IntervalList &b,
+                       std::pmr::memory_resource *resource)
+{
+    IntervalList result(resource);
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        const DataType *lower = a[i]->lower()->max(b[j]->lower());
+        const DataType *upper = a[i]->upper()->min(b[j]->upper());
+        if (lower->cmp(upper) <= 0)
+        {
+            if (lower == a[i]->lower() && upper == a[i]->upper())
+                result.push_back(a[i]);
+            else if (lower == b[j]->lower() && upper == b[j]->upper())
+                result.push_back(b[j]);
+            else
+                result.push_back(makeInterval(lower, upper, resource));
+        }
+        if (a[i]->upper()->cmp(b[j]->upper()) < 0)
+            i++;
+        else
+            j++;
+    }
+    return result;
+}
+
+IntervalList intersect(const IntervalList &a, const Interval &b,
+                       std::pmr::memory_resource *resource)
+{
+    IntervalList result(resource);
+    for (auto it = firstNotBefore(a, b.lower());
+         it != a.end() && (*it)->lower()->cmp(b.upper()) <= 0; it++)
+    {
+        const DataType *lower = (*it)->lower()->max(b.lower());
+        const DataType *upper = (*it)->upper()->min(b.upper());
+        if (lower == (*it)->lower() && upper == (*it)->upper())
+            result.push_back(*it);
+        else
+            result.push_back(makeInterval(lower, upper, resource));
+    }
+    return result;
+}
+
+IntervalList difference(const IntervalList &a, const IntervalList &b,
+                        std::pmr::memory_resource *resource)
+{
+    IntervalList result(resource);
+    size_t j = 0;
+    for (const auto &x : a)
+    {
+        // skip the intervals in b before x
+        while (j < b.size() && b[j]->upper()->cmp(x->lower()) < 0)
+            j++;
+        if (j == b.size() || b[j]->lower()->cmp(x->upper()) > 0)
+        {
+            // x does not overlap with b
+            result.push_back(x);
+            continue;
+        }
+
+        // the lower end point of the remaining part of x
+        unique_ptr<DataType> lower(x->lower()->clone());
+        bool remain = true;
+        for (size_t k = j;
+             k < b.size() && b[k]->lower()->cmp(x->upper()) <= 0; k++)
+        {
+            if (b[k]->lower()->cmp(lower.get()) > 0)
+            {
+                unique_ptr<DataType> upper(b[k]->lower()->clone());
+                upper->prev();
+                result.push_back(
+                    makeInterval(lower.get(), upper.get(), resource));
+            }
+            lower.reset(b[k]->upper()->clone());
+            if (!lower->next() || lower->cmp(x->upper()) > 0)
+            {
+                remain = false;
+                break;
+            }
+        }
+        if (remain)
+            result.push_back(
+                makeInterval(lower.get(), x->upper(), resource));
+    }
+    return result;
+}
+
+SET_RELATION relationship(const IntervalList &list,
+                          const Interval &plain)
+{
+    if (list.empty())
+        return SET_RELATION::DISJOINT;
+    auto it = firstNotBefore(list, plain.lower());
+    if (it == list.end() || (*it)->lower()->cmp(plain.upper()) > 0)
+        return SET_RELATION::DISJOINT;
+    if (list.size() == 1)
+        return list[0]->relationship(plain);
+
+    // all intervals are in the plain
+    if (list.front()->lower()->cmp(plain.lower()) >= 0 &&
+        list.back()->upper()->cmp(plain.upper()) <= 0)
+        return SET_RELATION::SUBSET;
+
+    // only the first overlapping interval can cover the plain
+    if ((*it)->lower()->cmp(plain.lower()) <= 0 &&
+        (*it)->upper()->cmp(plain.upper()) >= 0)
+        return SET_RELATION::SUPERSET;
+    return SET_RELATION::INTERSECT;
+}
+
+SET_RELATION relationship(const IntervalList &a, const IntervalList &b)
+{
+    // the lists are sorted, so one pass finds an overlapping pair
+    bool overlap = false;
+    for (size_t i = 0, j = 0; i < a.size() && j < b.size();)
+    {
+        if (a[i]->upper()->cmp(b[j]->lower()) < 0)
+            i++;
+        else if (b[j]->upper()->cmp(a[i]->lower()) < 0)
+            j++;
+        else
+        {
+            overlap = true;
+            break;
+        }
+    }
+    if (!overlap)
+        return SET_RELATION::DISJOINT;
+    bool sub = covers(b, a);
+    bool super = covers(a, b);
+    if (sub && super)
+        return SET_RELATION::EQUAL;
+    else if (sub)
+        return SET_RELATION::SUBSET;
+    else if (super)
+        return SET_RELATION::SUPERSET;
+    return SET_RELATION::INTERSECT;
+}
+
+IntervalList coarsen(const IntervalList &list, int max_intervals,
+                     std::pmr::memory_resource *resource)
+{
+    assert(max_intervals >= 1);
+    int extra_num = (int)list.size() - max_intervals;
+    if (extra_num <= 0)
+        return IntervalList(list, resource);
+
+    // fill the extra_num smallest gaps. Filling a gap does not change
+    // the other gaps, so the gaps can be chosen at once. Plain strings
+    // have no distance, so their gaps are filled from the left
+    bool has_distance = list[0]->getType() != DATA_TYPE::STRING;
+    vector<pair<double, int>> gaps;
+    gaps.reserve(list.size() - 1);
+    for (int i = 0; i + 1 < list.size(); i++)
+        gaps.push_back(make_pair(
+            has_distance
+                ? list[i + 1]->lower()->distance(list[i]->upper())
+                : 0,
+            i));
+    std::nth_element(gaps.begin(), gaps.begin() + extra_num - 1,
+                     gaps.end());
+    vector<bool> fill(list.size(), false);
+    for (int i = 0; i < extra_num; i++)
+        fill[gaps[i].second] = true;
+
+    IntervalList result(resource);
+    result.reserve(max_intervals);
+    int start = 0;
+    for (int i = 0; i < list.size(); i++)
+    {
+        if (fill[i])
+            continue;
+        if (start == i)
+            result.push_back(list[i]);
+        else
+            result.push_back(
+                makeInterval(list[start]->lower(), list[i]->upper(),
+                             resource));
+        start = i + 1;
+    }
+    assert(result.size() == max_intervals);
+    return result;
+}
+}; // namespace interval_list
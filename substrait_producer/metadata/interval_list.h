@@ -0,0 +1,101 @@
+#pragma once
+#include "metadata/interval.h"
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A normalized list of intervals on one attribute: the intervals are
+ * sorted by their lower end points, pairwise disjoint, and two
+ * neighbors are not adjacent (e.g. [0, 3] and [4, 9] are stored as [0,
+ * 9]). The functions below take normalized lists and return normalized
+ * lists. Unchanged intervals are shared with the inputs. The result
+ * lists and their new intervals are allocated from the memory resource
+ * passed to the function, see QueryArena.
+ */
+typedef std::pmr::vector<shared_ptr<const Interval>> IntervalList;
+
+namespace interval_list
+{
+/**
+ * @brief Normalize a set of intervals in O(n log n)
+ *
+ * @param intervals intervals in any order. They can overlap.
+ * @param resource
+ * @return IntervalList
+ */
+IntervalList normalize(
+    IntervalList intervals,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+
+IntervalList Union(
+    const IntervalList &a, const IntervalList &b,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+
+IntervalList intersect(
+    const IntervalList &a, const IntervalList &b,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+
+IntervalList intersect(
+    const IntervalList &a, const Interval &b,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+
+/**
+ * @brief Compute the values in a but not in b
+ *
+ * @param a
+ * @param b
+ * @param resource
+ * @return IntervalList
+ */
+IntervalList difference(
+    const IntervalList &a, const IntervalList &b,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+
+/**
+ * @brief Compute the relationship between the interval list and a
+ * plain interval with binary search.
+ *
+ * @param list
+ * @param plain
+ * @return SET_RELATION DISJOINT: all intervals in the list are disjoint
+ * with the plain, which an empty list always is; EQUAL: the list has a
+ * single interval and the interval is equal to the plain; SUBSET: all
+ * intervals in the list are the subset of the plain; SUPERSET: an
+ * interval is the superset of or equal to the plain; INTERSECT: other
+ * cases
+ */
+SET_RELATION relationship(const IntervalList &list,
+                          const Interval &plain);
+
+/**
+ * @brief Compute the exact set relationship of two lists in one merge
+ * pass, without allocating
+ *
+ * @param a
+ * @param b
+ * @return SET_RELATION the relationship of a to b. An empty list has
+ * no value, so it is disjoint with any list
+ */
+SET_RELATION relationship(const IntervalList &a, const IntervalList &b);
+
+/**
+ * @brief Reduce the number of intervals by filling the smallest gaps
+ * between neighbors. The result is a superset of the input.
+ *
+ * @param list
+ * @param max_intervals the maximum number of intervals in the result
+ * @param resource
+ * @return IntervalList
+ */
+IntervalList coarsen(
+    const IntervalList &list, int max_intervals,
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource());
+}; // namespace interval_list
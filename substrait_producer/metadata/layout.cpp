@@ -0,0 +1,35 @@
+#include "metadata/layout.h"
+
+shared_ptr<const Layout> Layout::load(
+    const InputParameter &parameter,
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics)
+{
+    auto layout = make_shared<Layout>();
+    bool check_path = parameter.engine == InputParameter::Engine::Velox;
+    if (!parameter.catalog_path.empty())
+    {
+        layout->catalog = BlockCatalog::openCatalog(
+            parameter.catalog_path, table_schema, statistics,
+            parameter.data_path, check_path);
+        return layout;
+    }
+
+    substrait::PartitionList s;
+    readSubstrait(&s, parameter.partition_path);
+    for (int i = 0; i < s.partitions_size(); i++)
+        layout->partitions.push_back(
+            PartitionMeta::parseSubstraitPartition(
+                &s.partitions(i), table_schema, statistics,
+                parameter.data_path, check_path));
+    return layout;
+}
+
+vector<shared_ptr<const PartitionMeta>> Layout::selectPartitions(
+    const Query &query) const
+{
+    if (!catalog)
+        return partitions;
+    return catalog->selectPartitions(*query.getFilterBoundary(),
+                                     query.getAllReferredAttributes());
+}
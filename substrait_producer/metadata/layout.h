@@ -0,0 +1,44 @@
+#pragma once
+
+#include "configuration.h"
+#include "metadata/block_catalog.h"
+#include "metadata/boundary.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The partitions of a layout as the planners read them: the
+ * parsed PartitionList, or the mapped BlockCatalog whose blocks are
+ * built once a query selects them. A layout is read-only once loaded,
+ * so queries are planned on it concurrently.
+ */
+class Layout
+{
+  public:
+    /**
+     * @brief Load the layout of parameter.catalog_path if it is set,
+     * else of parameter.partition_path. The partition paths are
+     * resolved to their parquet files for Velox
+     *
+     * @param parameter
+     * @param table_schema
+     * @param statistics
+     * @return shared_ptr<const Layout>
+     */
+    static shared_ptr<const Layout> load(
+        const InputParameter &parameter,
+        shared_ptr<const Schema> table_schema,
+        shared_ptr<const TableStatistics> statistics);
+
+    // the partitions that a query may read
+    vector<shared_ptr<const PartitionMeta>> selectPartitions(
+        const Query &query) const;
+
+  private:
+    shared_ptr<const BlockCatalog> catalog;
+    vector<shared_ptr<const PartitionMeta>> partitions;
+};
@@ -1,112 +1,24 @@
 #include "metadata/query.h"
 #include "configuration.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <map>
 
 Query::Query(
     shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics,
     shared_ptr<const FunctionExpression> filter,
     const vector<shared_ptr<const AggregateExpression>> &measures,
     const string &path)
-    : table_schema(table_schema), filter(filter), measures(measures),
-      path(path)
+    : table_schema(table_schema), statistics(statistics),
+      filter(filter), measures(measures), path(path)
 {
-    for (auto m : measures)
-        attributes_in_measures.push_back(
-            make_shared<unordered_set<string>>(m->getAttributes()));
-    produceFilterBoundary();
-}
-
-unordered_set<string> Query::getAllReferredAttributes() const
-{
-    unordered_set<string> attributes =
-        this->filter_boundary->getAttributes();
-    for (auto m : attributes_in_measures)
-        attributes.insert(m->begin(), m->end());
-    return attributes;
-}
-
-void Query::produceFilterBoundary()
-{
-    static const unordered_map<string, string> operators = {
-        {"gt", "lt"},
-        {"lt", "gt"},
-        {"gte", "lte"},
-        {"lte", "gte"},
-        {"equal", "equal"}};
-    auto sub_exps = this->filter->getSubExpressions("and");
-    unordered_map<string, shared_ptr<Interval>> intervals;
-
-    for (auto e : sub_exps)
-    {
-        auto children = e->getChildren();
-        if (children.size() != 2)
-            throw Exception("Query::produceFilterBoundary: expect "
-                            "binary expression but got " +
-                            e->toString());
-        shared_ptr<const Attribute> attribute;
-        shared_ptr<const Literal> literal;
-        int attribute_off = -1;
-        for (int i = 0; i < children.size(); i++)
-        {
-            auto c = children[i];
-            auto a = dynamic_pointer_cast<const Attribute>(c);
-            if (a)
-                if (attribute)
-                    throw Exception("Query::produceFilterBoundary: the "
-                                    "expression must "
-                                    "have a single attribute but got " +
-                                    e->toString());
-                else
-                {
-                    attribute = std::move(a);
-                    attribute_off = i;
-                }
-            auto l = dynamic_pointer_cast<const Literal>(c);
-            if (l)
-                if (literal)
-                    throw Exception("Query::produceFilterBoundary: the "
-                                    "expression must "
-                                    "have a single literval but got " +
-                                    e->toString());
-                else
-                    literal = std::move(l);
-        }
-        string name = attribute->getName();
-        if (intervals.find(name) == intervals.end())
-            intervals.emplace(
-                name, make_shared<Interval>(getMinValue(name), false,
-                                            getMaxValue(name), false));
-        auto it = intervals.find(name);
-        string op = e->getFunction();
-        if (attribute_off != 0) // value op attribute
-            if (operators.find(op) == operators.end())
-                throw Exception(
-                    "Query::produceFilterBoundary: unknow operator " +
-                    op);
-            else
-                op = operators.find(op)->second;
-        auto value = literal->getValue();
-        if (op == "equal")
-        {
-            it->second->setMin(value, false);
-            it->second->setMax(value, false);
-        }
-        else if (op == "gt")
-            it->second->setMin(value, true);
-        else if (op == "lt")
-            it->second->setMax(value, true);
-        else if (op == "gte")
-            it->second->setMin(value, false);
-        else if (op == "lte")
-            it->second->setMax(value, false);
-        else
-            throw Exception(
-                "Query::getFilterBoundary: unknow operator " + op);
-    }
-
-    unordered_map<string, shared_ptr<const Interval>> b;
-    for (auto it = intervals.begin(); it != intervals.end(); it++)
-        b.emplace(it->first, it->second);
-    filter_boundary = make_shared<Boundary>(b);
+    vector<shared_ptr<const Expression>> nodes;
+    query_template =
+        QueryTemplate::get(table_schema, filter, measures, nodes);
+    sub_filters = query_template->subFilters(nodes);
+    filter_boundary =
+        query_template->produceFilterBoundary(nodes, statistics);
 }
 
 string Query::toString() const
@@ -123,7 +35,8 @@ string Query::toString() const
 
 vector<shared_ptr<Query>> Query::parseSubstraitQuery(
     const substrait::Plan *serialized,
-    shared_ptr<const Schema> table_schema, string table_path)
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const TableStatistics> statistics, string table_path)
 {
     shared_ptr<unordered_map<int, string>> function_anchor =
         make_shared<unordered_map<int, string>>();
@@ -136,6 +49,12 @@ vector<shared_ptr<Query>> Query::parseSubstraitQuery(
             decl.extension_function().function_anchor(),
             decl.extension_function().name());
     }
+    // the anchors in order, appended to the source of every query
+    string anchors;
+    for (auto &anchor : map<int, string>(function_anchor->begin(),
+                                         function_anchor->end()))
+        anchors += "\n" + std::to_string(anchor.first) + ":" +
+                   anchor.second;
     vector<shared_ptr<Query>> queries;
 
     for (int i = 0; i < serialized->relations_size(); i++)
@@ -164,8 +83,50 @@ vector<shared_ptr<Query>> Query::parseSubstraitQuery(
         auto &condition = agg_rel.input().filter().condition();
         auto filter = FunctionExpression::parseSubstraitExpression(
             &condition, table_schema, function_anchor);
-        queries.push_back(make_shared<Query>(table_schema, filter,
-                                             measures, table_path));
+        auto query = make_shared<Query>(table_schema, statistics,
+                                        filter, measures, table_path);
+        {
+            google::protobuf::io::StringOutputStream stream(
+                &query->source);
+            google::protobuf::io::CodedOutputStream output(&stream);
+            output.SetSerializationDeterministic(true);
+            rel.SerializeToCodedStream(&output);
+        }
+        query->source += anchors;
+        queries.push_back(query);
     }
     return queries;
-}
\ No newline at end of file
+}
+
+QueryReader::QueryReader(const string &path, bool delimited,
+                         shared_ptr<const Schema> table_schema,
+                         shared_ptr<const TableStatistics> statistics,
+                         const string &table_path)
+    : table_schema(table_schema), statistics(statistics),
+      table_path(table_path)
+{
+    if (delimited)
+    {
+        log = make_unique<DelimitedReader>(path);
+        return;
+    }
+    substrait::Plan p;
+    readMessage(&p, path);
+    queries = Query::parseSubstraitQuery(&p, table_schema, statistics,
+                                         table_path);
+}
+
+shared_ptr<Query> QueryReader::next()
+{
+    substrait::Plan p;
+    while (position == queries.size())
+    {
+        if (!log || !log->next(&p))
+            return nullptr;
+        queries = Query::parseSubstraitQuery(&p, table_schema,
+                                             statistics, table_path);
+        position = 0;
+    }
+    // drop the reference so that the query is released by the caller
+    return std::move(queries[position++]);
+}
@@ -1,8 +1,11 @@
 #pragma once
 
-#include "metadata/boundary.h"
+#include "metadata/complex_boundary.h"
 #include "metadata/expression.h"
+#include "metadata/query_template.h"
 #include "metadata/schema.h"
+#include "protobuf_io.h"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +15,7 @@ class Query
 {
   public:
     Query(shared_ptr<const Schema> table_schema,
+          shared_ptr<const TableStatistics> statistics,
           shared_ptr<const FunctionExpression> filter,
           const vector<shared_ptr<const AggregateExpression>> &measures,
           const string &path);
@@ -21,15 +25,53 @@ class Query
         return filter;
     }
 
-    vector<shared_ptr<const AggregateExpression>> getMeasures() const
+    const vector<shared_ptr<const AggregateExpression>> &
+    getMeasures() const
     {
         return measures;
     }
 
-    shared_ptr<const unordered_set<string>> attributesInMeasure(
-        int measure_index) const
+    /**
+     * @brief Get the conjuncts of the filter, i.e.
+     * getFilter()->getSubExpressions("and")
+     *
+     * @return const vector<shared_ptr<const FunctionExpression>>&
+     */
+    const vector<shared_ptr<const FunctionExpression>> &
+    getSubFilters() const
     {
-        return attributes_in_measures[measure_index];
+        return sub_filters;
+    }
+
+    // the literal-independent part of the query, shared by the
+    // queries of its shape
+    shared_ptr<const QueryTemplate> getTemplate() const
+    {
+        return query_template;
+    }
+
+    const AttributeSet &attributesInMeasure(int measure_index) const
+    {
+        return query_template->attributesInMeasures()[measure_index];
+    }
+
+    // the attributes in all measures
+    const AttributeSet &attributesInMeasures() const
+    {
+        return query_template->attributesInAllMeasures();
+    }
+
+    // the attributes referred by the filter boundary
+    const AttributeSet &attributesInFilter() const
+    {
+        return query_template->attributesInFilter();
+    }
+
+    // the attributes referred by the conjuncts on several attributes,
+    // see QueryTemplate::attributesInResidualFilters
+    const AttributeSet &attributesInResidualFilters() const
+    {
+        return query_template->attributesInResidualFilters();
     }
 
     int numOfMeasures() const
@@ -42,27 +84,99 @@ class Query
         return path;
     }
 
-    shared_ptr<const Boundary> getFilterBoundary() const
+    /**
+     * @brief Get the tuples selected by the filter. Each attribute has
+     * the union of the intervals that the filter accepts.
+     *
+     * @return shared_ptr<const ComplexBoundary>
+     */
+    shared_ptr<const ComplexBoundary> getFilterBoundary() const
     {
         return filter_boundary;
     }
 
-    unordered_set<string> getAllReferredAttributes() const;
+    // the attributes in the filter boundary or in any measure
+    const AttributeSet &getAllReferredAttributes() const
+    {
+        return query_template->attributesReferred();
+    }
+
+    shared_ptr<const Schema> getTableSchema() const
+    {
+        return table_schema;
+    }
+
+    shared_ptr<const TableStatistics> getStatistics() const
+    {
+        return statistics;
+    }
+
+    /**
+     * @brief Get the substrait relation the query is parsed from,
+     * serialized deterministically and followed by the names of its
+     * function anchors, so that equal queries have equal sources. Empty
+     * if the query is not parsed from substrait
+     */
+    const string &getSource() const
+    {
+        return source;
+    }
 
     string toString() const;
 
     static vector<shared_ptr<Query>> parseSubstraitQuery(
         const substrait::Plan *serialized,
-        shared_ptr<const Schema> table_schema, string table_path);
+        shared_ptr<const Schema> table_schema,
+        shared_ptr<const TableStatistics> statistics,
+        string table_path);
 
   private:
     shared_ptr<const Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
     shared_ptr<const FunctionExpression> filter;
     vector<shared_ptr<const AggregateExpression>> measures;
     const string path;
+    string source;
+
+    shared_ptr<const QueryTemplate> query_template;
+    vector<shared_ptr<const FunctionExpression>> sub_filters;
+    shared_ptr<ComplexBoundary> filter_boundary;
+};
+
+/**
+ * @brief Read the queries of a query file one at a time. The file is
+ * either one substrait::Plan holding every query, or a query log of
+ * length-delimited substrait::Plan messages each holding some queries.
+ * A log is parsed one message at a time, so the memory does not grow
+ * with the length of the log.
+ */
+class QueryReader
+{
+  public:
+    /**
+     * @brief Open a query file
+     *
+     * @param path
+     * @param delimited True if the file is a query log
+     * @param table_schema
+     * @param statistics
+     * @param table_path
+     */
+    QueryReader(const string &path, bool delimited,
+                shared_ptr<const Schema> table_schema,
+                shared_ptr<const TableStatistics> statistics,
+                const string &table_path);
 
-    shared_ptr<Boundary> filter_boundary;
-    vector<shared_ptr<unordered_set<string>>> attributes_in_measures;
+    // the next query, or nullptr after the last query
+    shared_ptr<Query> next();
 
-    void produceFilterBoundary();
-};
\ No newline at end of file
+  private:
+    shared_ptr<const Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
+    string table_path;
+    // nullptr if the file is one plan
+    unique_ptr<DelimitedReader> log;
+    // the queries of the last parsed plan
+    vector<shared_ptr<Query>> queries;
+    size_t position = 0;
+};
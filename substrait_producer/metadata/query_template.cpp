@@ -0,0 +1,414 @@
+#include "metadata/query_template.h"
+#include "configuration.h"
+#include <boost/functional/hash.hpp>
+#include <list>
+#include <mutex>
+
+namespace
+{
+// the cached templates, the most recently used first, and their
+// positions by key. Guarded by cache_mutex
+typedef list<shared_ptr<const QueryTemplate>> TemplateList;
+TemplateList templates;
+unordered_multimap<size_t, TemplateList::iterator> template_index;
+std::mutex cache_mutex;
+
+// append the nodes of e in preorder. ends[i] is set to the position
+// after the subtree of node i
+void collect(const shared_ptr<const Expression> &e,
+             vector<shared_ptr<const Expression>> &nodes,
+             vector<int> &ends)
+{
+    int position = nodes.size();
+    nodes.push_back(e);
+    ends.push_back(0);
+    for (const auto &c : e->getChildren())
+        collect(c, nodes, ends);
+    ends[position] = nodes.size();
+}
+
+// the codes of the strings that pass "attribute op value" on an
+// attribute with a dictionary, within the value range of the table.
+// The list is empty if no string of the dictionary passes, e.g. the
+// value is missing from the dictionary of an equality, so the
+// predicate selects no tuple
+IntervalList encodeStringPredicate(
+    const Interval &range, const StringEnum::StringEnumList *dictionary,
+    const string &op, const DataType &value)
+{
+    auto s = dynamic_cast<const String *>(&value);
+    auto range_lower = dynamic_cast<const StringEnum *>(range.lower());
+    auto range_upper = dynamic_cast<const StringEnum *>(range.upper());
+    if (s == nullptr || range_lower == nullptr ||
+        range_upper == nullptr)
+        throw Exception("Query::produceFilterBoundary: expect a string "
+                        "literal on a dictionary attribute but got " +
+                        value.toString());
+    string v = s->getValue();
+    int lower = range_lower->getIndex();
+    int upper = range_upper->getIndex();
+    if (op == "equal")
+    {
+        lower = std::max(lower, dictionary->lowerBound(v));
+        upper = std::min(upper, dictionary->upperBound(v) - 1);
+    }
+    else if (op == "gt")
+        lower = std::max(lower, dictionary->upperBound(v));
+    else if (op == "gte")
+        lower = std::max(lower, dictionary->lowerBound(v));
+    else if (op == "lt")
+        upper = std::min(upper, dictionary->lowerBound(v) - 1);
+    else if (op == "lte")
+        upper = std::min(upper, dictionary->upperBound(v) - 1);
+    else
+    {
+        auto prefix = dictionary->prefixRange(v);
+        lower = std::max(lower, prefix.first);
+        upper = std::min(upper, prefix.second);
+    }
+
+    if (lower > upper)
+        return {};
+    return {make_shared<Interval>(
+        make_shared<StringEnum>(lower, dictionary), false,
+        make_shared<StringEnum>(upper, dictionary), false)};
+}
+
+// the values in the table range that pass "attribute op value"
+IntervalList compareValue(const Interval &range, const string &op,
+                          shared_ptr<const DataType> value)
+{
+    auto interval = make_shared<Interval>(range);
+    if (op == "equal")
+    {
+        interval->setMin(value, false);
+        interval->setMax(value, false);
+    }
+    else if (op == "gt")
+        interval->setMin(value, true);
+    else if (op == "lt")
+        interval->setMax(value, true);
+    else if (op == "gte")
+        interval->setMin(value, false);
+    else
+        interval->setMax(value, false);
+
+    // the value is out of the table range
+    if (interval->lower()->cmp(interval->upper()) > 0)
+        return {};
+    return {interval};
+}
+}; // namespace
+
+shared_ptr<const QueryTemplate> QueryTemplate::get(
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const FunctionExpression> filter,
+    const vector<shared_ptr<const AggregateExpression>> &measures,
+    vector<shared_ptr<const Expression>> &nodes)
+{
+    size_t key = 0;
+    boost::hash_combine(key, table_schema->getID());
+    boost::hash_combine(key, filter->getShapeHash());
+    for (const auto &m : measures)
+        boost::hash_combine(key, m->getShapeHash());
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto range = template_index.equal_range(key);
+        for (auto it = range.first; it != range.second; it++)
+        {
+            auto position = it->second;
+            if (!(*position)->match(table_schema.get(), filter,
+                                    measures, nodes))
+                continue;
+            templates.splice(templates.begin(), templates, position);
+            return *position;
+        }
+    }
+
+    // build the template out of the lock. A query of the same shape
+    // planned meanwhile by another thread adds a duplicate, which is
+    // evicted in time
+    shared_ptr<const QueryTemplate> t(
+        new QueryTemplate(key, table_schema, filter, measures, nodes));
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    templates.push_front(t);
+    template_index.emplace(key, templates.begin());
+    if (templates.size() > kCacheCapacity)
+    {
+        auto last = std::prev(templates.end());
+        auto range = template_index.equal_range((*last)->key);
+        for (auto it = range.first; it != range.second; it++)
+            if (it->second == last)
+            {
+                template_index.erase(it);
+                break;
+            }
+        templates.pop_back();
+    }
+    return t;
+}
+
+QueryTemplate::QueryTemplate(
+    size_t key, shared_ptr<const Schema> table_schema,
+    shared_ptr<const FunctionExpression> filter,
+    const vector<shared_ptr<const AggregateExpression>> &measures,
+    vector<shared_ptr<const Expression>> &nodes)
+    : key(key), table_schema(table_schema), filter(filter),
+      measures(measures)
+{
+    for (auto m : measures)
+    {
+        attributes_in_measures.push_back(
+            table_schema->getAttributeSet(m->getAttributes()));
+        attributes_all_measures |= attributes_in_measures.back();
+    }
+
+    if (!filter->isAndOnly("and"))
+        throw Exception("QueryTemplate: the filter must be a "
+                        "conjunction of predicates but got " +
+                        filter->toString());
+    nodes.clear();
+    vector<int> ends;
+    collect(filter, nodes, ends);
+    addConjuncts(nodes, ends, 0);
+    attributes_referred =
+        attributes_in_filter | attributes_all_measures;
+}
+
+bool QueryTemplate::match(
+    const Schema *table_schema,
+    const shared_ptr<const FunctionExpression> &filter,
+    const vector<shared_ptr<const AggregateExpression>> &measures,
+    vector<shared_ptr<const Expression>> &nodes) const
+{
+    if (table_schema->getID() != this->table_schema->getID() ||
+        measures.size() != this->measures.size())
+        return false;
+    for (int i = 0; i < measures.size(); i++)
+    {
+        nodes.clear();
+        if (!Expression::matchShape(measures[i], *this->measures[i],
+                                    nodes))
+            return false;
+    }
+    nodes.clear();
+    return Expression::matchShape(filter, *this->filter, nodes);
+}
+
+void QueryTemplate::addConjuncts(
+    const vector<shared_ptr<const Expression>> &nodes,
+    const vector<int> &ends, int position)
+{
+    auto e = static_cast<const FunctionExpression *>(
+        nodes[position].get());
+    if (e->getFunction() == "and")
+    {
+        for (int c = position + 1; c < ends[position]; c = ends[c])
+            addConjuncts(nodes, ends, c);
+        return;
+    }
+
+    Predicate predicate;
+    conjuncts.push_back(position);
+    if (!compile(nodes, ends, position, predicate))
+    {
+        // an or across attributes does not bound any of them, so the
+        // conjunct is widened to the full ranges and left to the
+        // residual filter
+        AttributeSet attributes =
+            table_schema->getAttributeSet(e->getAttributes());
+        predicate.steps.clear();
+        predicates.push_back(std::move(predicate));
+        sub_filter_attributes.push_back(-1);
+        attributes_in_filter |= attributes;
+        attributes_in_residual_filters |= attributes;
+        return;
+    }
+    int offset = table_schema->getOffset(predicate.attribute);
+    predicate.offset = offset;
+    predicate.dictionary = table_schema->get(offset)->getDictionary();
+    for (auto &step : predicate.steps)
+        if (step.kind == Step::COMPARE && step.op == "starts_with" &&
+            !predicate.dictionary)
+            throw Exception("Query::produceFilterBoundary: unknow "
+                            "operator starts_with on " +
+                            predicate.attribute);
+    predicates.push_back(std::move(predicate));
+    sub_filter_attributes.push_back(offset);
+    attributes_in_filter.set(offset);
+}
+
+bool QueryTemplate::compile(
+    const vector<shared_ptr<const Expression>> &nodes,
+    const vector<int> &ends, int position, Predicate &predicate) const
+{
+    static const unordered_map<string, string> operators = {
+        {"gt", "lt"},
+        {"lt", "gt"},
+        {"gte", "lte"},
+        {"lte", "gte"},
+        {"equal", "equal"}};
+    auto &e = static_cast<const FunctionExpression &>(*nodes[position]);
+    string op = e.getFunction();
+    if (op == "and" || op == "or")
+    {
+        Step step;
+        step.kind = op == "and" ? Step::AND : Step::OR;
+        for (int c = position + 1; c < ends[position]; c = ends[c])
+        {
+            // skip the auxiliary literal of connectExpression, which
+            // does not change the result
+            auto l = dynamic_cast<const Literal *>(nodes[c].get());
+            if (l && l->getType() == DATA_TYPE::BOOLEAN &&
+                dynamic_pointer_cast<const Boolean>(l->getValue())
+                        ->getValue() == (step.kind == Step::AND))
+                continue;
+            if (!dynamic_cast<const FunctionExpression *>(
+                    nodes[c].get()))
+                throw Exception("Query::produceFilterBoundary: "
+                                "unsupported operand " +
+                                nodes[c]->toString() + " in " +
+                                e.toString());
+            if (!compile(nodes, ends, c, predicate))
+                return false;
+            step.operands++;
+        }
+        if (step.operands == 0)
+            throw Exception("Query::produceFilterBoundary: expect a "
+                            "predicate in " +
+                            e.toString());
+        predicate.steps.push_back(std::move(step));
+        return true;
+    }
+
+    const Attribute *a = nullptr;
+    int literal = -1;
+    int children = 0;
+    for (int c = position + 1; c < ends[position]; c = ends[c])
+    {
+        if (auto t = dynamic_cast<const Attribute *>(nodes[c].get()))
+            if (a)
+                throw Exception("Query::produceFilterBoundary: the "
+                                "expression must "
+                                "have a single attribute but got " +
+                                e.toString());
+            else
+            {
+                a = t;
+                // value op attribute
+                if (children != 0)
+                    if (operators.find(op) == operators.end())
+                        throw Exception("Query::produceFilterBoundary: "
+                                        "unknow operator " +
+                                        op);
+                    else
+                        op = operators.find(op)->second;
+            }
+        if (dynamic_cast<const Literal *>(nodes[c].get()))
+            if (literal != -1)
+                throw Exception("Query::produceFilterBoundary: the "
+                                "expression must "
+                                "have a single literval but got " +
+                                e.toString());
+            else
+                literal = c;
+        children++;
+    }
+    if (children != 2)
+        throw Exception("Query::produceFilterBoundary: expect "
+                        "binary expression but got " +
+                        e.toString());
+    if (!a || literal == -1)
+        throw Exception("Query::produceFilterBoundary: expect a "
+                        "comparison between an attribute and a literal "
+                        "but got " +
+                        e.toString());
+    if (op != "starts_with" && operators.find(op) == operators.end())
+        throw Exception(
+            "Query::produceFilterBoundary: unknow operator " + op);
+
+    string name = a->getName();
+    if (predicate.attribute.empty())
+        predicate.attribute = name;
+    else if (predicate.attribute != name)
+        return false;
+
+    Step step;
+    step.kind = Step::COMPARE;
+    step.op = op;
+    step.literal = literal;
+    predicate.steps.push_back(std::move(step));
+    return true;
+}
+
+vector<shared_ptr<const FunctionExpression>> QueryTemplate::subFilters(
+    const vector<shared_ptr<const Expression>> &nodes) const
+{
+    vector<shared_ptr<const FunctionExpression>> sub_filters;
+    for (int position : conjuncts)
+        sub_filters.push_back(
+            static_pointer_cast<const FunctionExpression>(
+                nodes[position]));
+    return sub_filters;
+}
+
+shared_ptr<ComplexBoundary> QueryTemplate::produceFilterBoundary(
+    const vector<shared_ptr<const Expression>> &nodes,
+    shared_ptr<const TableStatistics> statistics) const
+{
+    IntervalListMap intervals;
+    for (const auto &p : predicates)
+    {
+        // a conjunct on several attributes keeps the full ranges
+        if (p.offset < 0)
+            continue;
+        auto list = produceIntervals(p, nodes, *statistics);
+        auto it = intervals.find(p.offset);
+        if (it == intervals.end())
+            it = intervals.emplace(p.offset, std::move(list)).first;
+        else
+            it->second = interval_list::intersect(it->second, list);
+        // an empty list keeps no tuple, so the boundary is disjoint
+        // with every block and the query reads none of them
+    }
+    return make_shared<ComplexBoundary>(intervals, statistics);
+}
+
+IntervalList QueryTemplate::produceIntervals(
+    const Predicate &predicate,
+    const vector<shared_ptr<const Expression>> &nodes,
+    const TableStatistics &statistics) const
+{
+    const Interval &range = *statistics.getRange(predicate.offset);
+    vector<IntervalList> lists;
+    for (const auto &step : predicate.steps)
+    {
+        if (step.kind == Step::COMPARE)
+        {
+            auto value =
+                static_cast<const Literal &>(*nodes[step.literal])
+                    .getValue();
+            // a string attribute with a dictionary is compared by the
+            // codes
+            if (predicate.dictionary)
+                lists.push_back(encodeStringPredicate(
+                    range, predicate.dictionary.get(), step.op,
+                    *value));
+            else
+                lists.push_back(compareValue(range, step.op, value));
+            continue;
+        }
+        // combine the lists of the operands, the last on the top
+        auto first = lists.end() - step.operands;
+        IntervalList result = std::move(*first);
+        for (auto it = first + 1; it != lists.end(); it++)
+            if (step.kind == Step::AND)
+                result = interval_list::intersect(result, *it);
+            else
+                result = interval_list::Union(result, *it);
+        lists.erase(first, lists.end());
+        lists.push_back(std::move(result));
+    }
+    return std::move(lists.back());
+}
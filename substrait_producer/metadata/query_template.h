@@ -0,0 +1,238 @@
+#pragma once
+
+#include "metadata/attribute_set.h"
+#include "metadata/complex_boundary.h"
+#include "metadata/expression.h"
+#include "metadata/schema.h"
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The literal-independent part of a query, shared by the
+ * queries that differ only in the values of their literals. It holds
+ * the positions of the conjuncts of the filter, the checked predicate
+ * of each conjunct compiled to the steps that compute its intervals,
+ * and the attribute sets of the measures and the filter. A query of a
+ * known shape thus skips the decomposition and the checks of its
+ * filter and only reads its literals to produce its filter boundary.
+ *
+ * The templates are kept in a bounded cache, least recently used
+ * first evicted, keyed by the identity of the table schema
+ * (Schema::getID, which unlike its address is never reused by a
+ * schema read later, e.g. by a reload) and the shape hashes of the
+ * filter and the measures (Expression::getShapeHash). A hit is
+ * confirmed by Expression::matchShape, which also collects the nodes
+ * of the filter that the template refers to by their preorder
+ * positions.
+ */
+class QueryTemplate
+{
+  public:
+    // the number of templates kept by the cache
+    static constexpr size_t kCacheCapacity = 1024;
+
+    /**
+     * @brief Get the template of a query from the cache, or build and
+     * cache it
+     *
+     * @param table_schema
+     * @param filter a conjunction of predicates, see compile
+     * @param measures
+     * @param nodes OUTPUT: the nodes of the filter in preorder, the
+     * input of subFilters and produceFilterBoundary
+     * @return shared_ptr<const QueryTemplate>
+     */
+    static shared_ptr<const QueryTemplate>
+    get(shared_ptr<const Schema> table_schema,
+        shared_ptr<const FunctionExpression> filter,
+        const vector<shared_ptr<const AggregateExpression>> &measures,
+        vector<shared_ptr<const Expression>> &nodes);
+
+    /**
+     * @brief Get the conjuncts of a filter of the template, in the
+     * order of getSubExpressions("and")
+     *
+     * @param nodes the nodes of the filter collected by get
+     * @return vector<shared_ptr<const FunctionExpression>>
+     */
+    vector<shared_ptr<const FunctionExpression>>
+    subFilters(const vector<shared_ptr<const Expression>> &nodes) const;
+
+    /**
+     * @brief Compute the filter boundary of a filter of the template
+     * from the values of its literals
+     *
+     * @param nodes the nodes of the filter collected by get
+     * @param statistics the value range of the table
+     * @return shared_ptr<ComplexBoundary>
+     */
+    shared_ptr<ComplexBoundary> produceFilterBoundary(
+        const vector<shared_ptr<const Expression>> &nodes,
+        shared_ptr<const TableStatistics> statistics) const;
+
+    const vector<AttributeSet> &attributesInMeasures() const
+    {
+        return attributes_in_measures;
+    }
+
+    const AttributeSet &attributesInAllMeasures() const
+    {
+        return attributes_all_measures;
+    }
+
+    // the attributes referred by the conjuncts of the filter
+    const AttributeSet &attributesInFilter() const
+    {
+        return attributes_in_filter;
+    }
+
+    const AttributeSet &attributesReferred() const
+    {
+        return attributes_referred;
+    }
+
+    // the attributes referred by the conjuncts on several attributes,
+    // which no block passes by its boundary and which are evaluated
+    // after reconstruction
+    const AttributeSet &attributesInResidualFilters() const
+    {
+        return attributes_in_residual_filters;
+    }
+
+    bool hasResidualFilters() const
+    {
+        return !attributes_in_residual_filters.empty();
+    }
+
+    /**
+     * @brief Get the offset of the attribute referred by each conjunct
+     * of the filter, in the order of getSubExpressions("and"). The
+     * offset is -1 for a conjunct on several attributes
+     *
+     * @return const vector<int>&
+     */
+    const vector<int> &subFilterAttributes() const
+    {
+        return sub_filter_attributes;
+    }
+
+    int numOfSubFilters() const
+    {
+        return sub_filter_attributes.size();
+    }
+
+  private:
+    // a step of a compiled predicate, run on a stack of interval lists
+    struct Step
+    {
+        enum Kind
+        {
+            // push the intervals of "attribute op literal"
+            COMPARE,
+            // replace the top operands lists by their intersection
+            AND,
+            // replace the top operands lists by their union
+            OR
+        };
+        Kind kind;
+        // the operator of COMPARE, with the attribute on the left
+        string op;
+        // the preorder position of the literal of COMPARE
+        int literal = -1;
+        int operands = 0;
+    };
+
+    // a conjunct of the filter, compiled
+    struct Predicate
+    {
+        string attribute;
+        // the offset of the attribute in the table schema, -1 if the
+        // conjunct refers to several attributes. Such a conjunct is
+        // widened to the full ranges of its attributes and has no steps
+        int offset = -1;
+        shared_ptr<const StringEnum::StringEnumList> dictionary;
+        vector<Step> steps;
+    };
+
+    // the key of the template in the cache and the query it is built
+    // from, which is matched by the queries of the same shape
+    size_t key;
+    shared_ptr<const Schema> table_schema;
+    shared_ptr<const FunctionExpression> filter;
+    vector<shared_ptr<const AggregateExpression>> measures;
+
+    // the preorder positions of the conjuncts
+    vector<int> conjuncts;
+    vector<Predicate> predicates;
+    vector<AttributeSet> attributes_in_measures;
+    AttributeSet attributes_all_measures;
+    AttributeSet attributes_in_filter;
+    AttributeSet attributes_referred;
+    AttributeSet attributes_in_residual_filters;
+    vector<int> sub_filter_attributes;
+
+    /**
+     * @brief Build the template of a query and check its filter
+     *
+     * @param nodes OUTPUT: the nodes of the filter in preorder
+     */
+    QueryTemplate(
+        size_t key, shared_ptr<const Schema> table_schema,
+        shared_ptr<const FunctionExpression> filter,
+        const vector<shared_ptr<const AggregateExpression>> &measures,
+        vector<shared_ptr<const Expression>> &nodes);
+
+    /**
+     * @brief Check if a query has the shape of the template
+     *
+     * @param nodes OUTPUT: the nodes of the filter in preorder if the
+     * query matches
+     */
+    bool match(
+        const Schema *table_schema,
+        const shared_ptr<const FunctionExpression> &filter,
+        const vector<shared_ptr<const AggregateExpression>> &measures,
+        vector<shared_ptr<const Expression>> &nodes) const;
+
+    /**
+     * @brief Add the conjuncts of a node of the filter
+     *
+     * @param nodes the nodes of the filter in preorder
+     * @param ends the preorder position after the subtree of each node
+     * @param position
+     */
+    void addConjuncts(const vector<shared_ptr<const Expression>> &nodes,
+                      const vector<int> &ends, int position);
+
+    /**
+     * @brief Compile a predicate. A predicate is a comparison between
+     * an attribute and a literal, or an and/or combination of
+     * comparisons.
+     *
+     * @param nodes the nodes of the filter in preorder
+     * @param ends the preorder position after the subtree of each node
+     * @param position the position of the predicate
+     * @param predicate OUTPUT: the steps are appended. The attribute
+     * is set to the first referred attribute if empty on input
+     * @return false if the predicate refers to an attribute other than
+     * predicate.attribute, true otherwise
+     */
+    bool compile(const vector<shared_ptr<const Expression>> &nodes,
+                 const vector<int> &ends, int position,
+                 Predicate &predicate) const;
+
+    /**
+     * @brief Compute the values of an attribute accepted by a predicate
+     *
+     * @param predicate
+     * @param nodes the nodes of the filter in preorder
+     * @param statistics
+     * @return IntervalList the normalized intervals. An empty list if
+     * no value in the table range passes the predicate
+     */
+    IntervalList
+    produceIntervals(const Predicate &predicate,
+                     const vector<shared_ptr<const Expression>> &nodes,
+                     const TableStatistics &statistics) const;
+};
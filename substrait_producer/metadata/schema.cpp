@@ -1,5 +1,31 @@
 #include "metadata/schema.h"
 #include "configuration.h"
+#include <atomic>
+#include <filesystem>
+
+namespace
+{
+std::atomic<uint64_t> next_schema_id{0};
+}; // namespace
+
+Schema::Schema() : id(next_schema_id++)
+{
+}
+
+Schema::Schema(const Schema &other)
+    : mattr(other.mattr), vattr(other.vattr), moffset(other.moffset),
+      attribute_set(other.attribute_set), id(next_schema_id++)
+{
+}
+
+Schema &Schema::operator=(const Schema &other)
+{
+    mattr = other.mattr;
+    vattr = other.vattr;
+    moffset = other.moffset;
+    attribute_set = other.attribute_set;
+    return *this;
+}
 
 const shared_ptr<Attribute> Schema::get(const string &name) const
 {
@@ -17,12 +43,10 @@ const shared_ptr<Attribute> Schema::get(int offset) const
 
 int Schema::getOffset(const string &name) const
 {
-    for (size_t i = 0; i < vattr.size(); i++)
-    {
-        if (vattr[i]->getName() == name)
-            return i;
-    }
-    return -1;
+    auto it = moffset.find(name);
+    if (it == moffset.end())
+        return -1;
+    return it->second;
 }
 
 boost::dynamic_bitset<> Schema::getOffsets(
@@ -50,8 +74,26 @@ void Schema::add(shared_ptr<Attribute> attr)
     if (mattr.find(attr->getName()) != mattr.end())
         throw Exception("The schema already has attribute " +
                         attr->getName());
+    moffset[attr->getName()] = vattr.size();
     vattr.push_back(attr);
     mattr[attr->getName()] = attr;
+    if (attr->getTableOffset() >= 0)
+        attribute_set.set(attr->getTableOffset());
+}
+
+AttributeSet Schema::getAttributeSet(
+    const unordered_set<string> &names) const
+{
+    AttributeSet result;
+    for (const auto &n : names)
+    {
+        int offset = this->get(n)->getTableOffset();
+        if (offset < 0)
+            throw Exception("Schema::getAttributeSet: " + n +
+                            " is not a table attribute");
+        result.set(offset);
+    }
+    return result;
 }
 
 void Schema::append(shared_ptr<const Schema> other)
@@ -90,32 +132,9 @@ bool Schema::equal(shared_ptr<const Schema> other) const
 }
 
 SET_RELATION Schema::relationship(
-    const unordered_set<string> &attributes) const
-{
-    bool found = false;
-    for (auto it = mattr.begin(); it != mattr.end() && !found; it++)
-        if (attributes.count(it->first))
-            found = true;
-    if (!found && mattr.size() != 0)
-        return SET_RELATION::DISJOINT;
-
-    bool has_unique[]{false, false};
-    for (auto it = mattr.begin();
-         it != mattr.end() && has_unique[0] == false; it++)
-        if (attributes.count(it->first) == 0)
-            has_unique[0] = true;
-    for (auto it = attributes.begin();
-         it != attributes.end() && has_unique[1] == false; it++)
-        if (mattr.count(*it) == 0)
-            has_unique[1] = true;
-    if (has_unique[0] == false && has_unique[1] == false)
-        return SET_RELATION::EQUAL;
-    else if (has_unique[0] == true && has_unique[1] == false)
-        return SET_RELATION::SUPERSET;
-    else if (has_unique[0] == false && has_unique[1] == true)
-        return SET_RELATION::SUBSET;
-    else
-        return SET_RELATION::INTERSECT;
+    const AttributeSet &attributes) const
+{
+    return attribute_set.relationship(attributes);
 }
 
 unordered_set<string> Schema::getAttributeNames() const
@@ -140,6 +159,8 @@ void Schema::rename(const string &src_name, const string &dest_name)
     a->setName(dest_name);
     mattr.erase(src_name);
     mattr[dest_name] = a;
+    moffset[dest_name] = moffset.at(src_name);
+    moffset.erase(src_name);
 }
 
 string Schema::toString() const
@@ -156,6 +177,11 @@ shared_ptr<Schema> Schema::parseSubstraitSchema(
 {
     shared_ptr<Schema> schema = make_shared<Schema>();
     int size = serialized->names_size();
+    if (size > AttributeSet::capacity)
+        throw Exception("Schema::parseSubstraitSchema: the table has " +
+                        std::to_string(size) +
+                        " attributes, more than the capacity " +
+                        std::to_string(AttributeSet::capacity));
 
     for (int i = 0; i < size; i++)
     {
@@ -167,7 +193,65 @@ shared_ptr<Schema> Schema::parseSubstraitSchema(
         bool nullability;
         shared_ptr<Attribute> a = make_shared<Attribute>(
             name, parseSubstraitType(&t, nullability), size);
+        a->setTableOffset(i);
         schema->add(std::move(a));
     }
     return schema;
+}
+
+void Schema::parseSubstraitDictionaries(
+    const substrait::Expression_Literal *serialized)
+{
+    if (!serialized->has_map())
+        throw Exception("Schema::parseSubstraitDictionaries: expect a "
+                        "map literal");
+    auto &m = serialized->map();
+    for (int i = 0; i < m.key_values_size(); i++)
+    {
+        auto &kv = m.key_values(i);
+        auto a = get(kv.key().string());
+        if (a->getType() != DATA_TYPE::STRING)
+            throw Exception("Schema::parseSubstraitDictionaries: "
+                            "attribute " +
+                            a->getName() + " is not a string");
+        vector<string> strings;
+        strings.reserve(kv.value().list().values_size());
+        for (auto &v : kv.value().list().values())
+            strings.push_back(v.string());
+        a->setDictionary(make_shared<StringEnum::StringEnumList>(
+            std::move(strings)));
+    }
+}
+
+void Schema::makeSubstraitDictionaries(
+    substrait::Expression_Literal *mutable_out) const
+{
+    auto m = mutable_out->mutable_map();
+    for (auto a : vattr)
+    {
+        auto dictionary = a->getDictionary();
+        if (!dictionary)
+            continue;
+        auto kv = m->add_key_values();
+        kv->mutable_key()->set_string(a->getName());
+        auto list = kv->mutable_value()->mutable_list();
+        for (int i = 0; i < dictionary->size(); i++)
+            list->add_values()->set_string(dictionary->get(i));
+    }
+}
+
+shared_ptr<Schema> Schema::readSchema(const string &schema_path)
+{
+    substrait::NamedStruct s;
+    readSubstrait(&s, schema_path);
+    auto schema = parseSubstraitSchema(&s);
+
+    string dictionary_path = schema_path + dictionary_suffix;
+    if (std::filesystem::exists(dictionary_path))
+    {
+        substrait::Expression_Literal d;
+        readSubstrait(&d, dictionary_path);
+        schema->parseSubstraitDictionaries(&d);
+    }
+    return schema;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "configuration.h"
+#include "metadata/attribute_set.h"
 #include "metadata/expression.h"
 #include "substrait/type.pb.h"
 #include <boost/dynamic_bitset.hpp>
@@ -13,6 +14,11 @@ using namespace std;
 class Schema
 {
   public:
+    Schema();
+    // a copy is a new schema, with its own identity
+    Schema(const Schema &other);
+    Schema &operator=(const Schema &other);
+
     void add(shared_ptr<Attribute> attribute);
     void append(shared_ptr<const Schema> other);
 
@@ -32,6 +38,26 @@ class Schema
 
     unordered_set<string> getAttributeNames() const;
 
+    /**
+     * @brief The table attributes in the schema, keyed by their offsets
+     * in the table schema. Attributes that are not from the table are
+     * not included.
+     */
+    const AttributeSet &getAttributeSet() const
+    {
+        return attribute_set;
+    }
+
+    /**
+     * @brief Get the set of the named attributes. Each attribute must
+     * be a table attribute in the schema.
+     *
+     * @param names
+     * @return AttributeSet
+     */
+    AttributeSet getAttributeSet(
+        const unordered_set<string> &names) const;
+
     bool contains(const string &name) const;
     void rename(const string &src_name, const string &dest_name);
 
@@ -44,20 +70,55 @@ class Schema
      * @param attributes
      * @return SET_RELATION
      */
-    SET_RELATION relationship(
-        const unordered_set<string> &attributes) const;
+    SET_RELATION relationship(const AttributeSet &attributes) const;
 
     size_t size() const
     {
         return vattr.size();
     }
 
+    /**
+     * @brief The identity of the schema. Unlike the address of the
+     * schema, it is never reused by another schema of the process
+     */
+    uint64_t getID() const
+    {
+        return id;
+    }
+
     bool equal(shared_ptr<const Schema> other) const;
 
     static shared_ptr<Schema> parseSubstraitSchema(
         substrait::NamedStruct *serialized);
 
+    /**
+     * @brief Attach the string dictionaries to the attributes
+     *
+     * @param serialized a map literal from an attribute name to the
+     * list of the distinct strings of the attribute
+     */
+    void parseSubstraitDictionaries(
+        const substrait::Expression_Literal *serialized);
+
+    void makeSubstraitDictionaries(
+        substrait::Expression_Literal *mutable_out) const;
+
+    /**
+     * @brief Read the table schema. The string dictionaries are read
+     * from schema_path + dictionary_suffix if the file exists.
+     *
+     * @param schema_path
+     * @return shared_ptr<Schema>
+     */
+    static shared_ptr<Schema> readSchema(const string &schema_path);
+
+    static constexpr const char *dictionary_suffix = ".dict";
+
   private:
     unordered_map<string, shared_ptr<Attribute>> mattr;
     vector<shared_ptr<Attribute>> vattr;
+    // the offset of each attribute in vattr
+    unordered_map<string, int> moffset;
+    AttributeSet attribute_set;
+    uint64_t id;
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "metadata/statistics.h"
+#include "metadata/boundary.h"
+
+TableStatistics::TableStatistics(shared_ptr<const Schema> table_schema,
+                                 const Boundary &table_range)
+    : table_schema(table_schema)
+{
+    ranges.resize(table_schema->size());
+    min_values.resize(table_schema->size());
+    max_values.resize(table_schema->size());
+    const auto &intervals = table_range.getIntervals();
+    for (auto it = intervals.begin(); it != intervals.end(); it++)
+    {
+        int offset = it->first;
+        if (offset < 0 || offset >= table_schema->size())
+            throw Exception("TableStatistics: attribute " +
+                            std::to_string(offset) +
+                            " is not in the table schema");
+        ranges[offset] = it->second;
+        min_values[offset] = it->second->getMin();
+        max_values[offset] = it->second->getMax();
+    }
+}
+
+const shared_ptr<const Interval> &TableStatistics::getRange(
+    int offset) const
+{
+    if (!hasRange(offset))
+        throw Exception("TableStatistics::getRange: Miss the min/max "
+                        "value of attribute " +
+                        (offset >= 0 && offset < table_schema->size()
+                             ? table_schema->get(offset)->getName()
+                             : std::to_string(offset)));
+    return ranges[offset];
+}
+
+const shared_ptr<const Interval> &TableStatistics::getRange(
+    const string &attribute) const
+{
+    int offset = table_schema->getOffset(attribute);
+    if (offset < 0)
+        throw Exception("TableStatistics::getRange: Miss the min/max "
+                        "value of attribute " +
+                        attribute);
+    return getRange(offset);
+}
+
+shared_ptr<const TableStatistics> TableStatistics::withSample(
+    shared_ptr<const TableSample> sample) const
+{
+    auto copy = make_shared<TableStatistics>(*this);
+    copy->sample = sample;
+    return copy;
+}
+
+const Interval &TableStatistics::findRange(
+    int offset, const TableStatistics *first,
+    const TableStatistics *second)
+{
+    if (first)
+        return *first->getRange(offset);
+    if (second)
+        return *second->getRange(offset);
+    throw Exception("TableStatistics::findRange: Miss the min/max "
+                    "value of attribute " +
+                    std::to_string(offset));
+}
+
+vector<string> TableStatistics::getAttributes() const
+{
+    vector<string> attributes;
+    for (int i = 0; i < ranges.size(); i++)
+        if (ranges[i])
+            attributes.push_back(table_schema->get(i)->getName());
+    return attributes;
+}
+
+shared_ptr<const TableStatistics> TableStatistics::
+    parseSubstraitTableRange(const substrait::Partition *serialized,
+                             shared_ptr<const Schema> table_schema)
+{
+    if (serialized->blocks_size() != 1)
+        throw Exception("TableStatistics::parseSubstraitTableRange: "
+                        "expect a single block");
+    auto block = BlockMeta::parseSubstraitBlock(&serialized->blocks(0),
+                                                table_schema, nullptr);
+    return make_shared<TableStatistics>(table_schema,
+                                        *block->getBoundary());
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "metadata/interval.h"
+#include "metadata/schema.h"
+#include "substrait/partition.pb.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Boundary;
+class TableSample;
+
+/**
+ * @brief The value range (min/max) of each attribute in a table. The
+ * ranges are indexed by the attribute offset in the table schema and
+ * are frozen after construction, so a statistics object can be shared
+ * by threads and several tables can be planned in one process.
+ */
+class TableStatistics
+{
+  public:
+    /**
+     * @brief Build the statistics from the boundary of the table range
+     *
+     * @param table_schema
+     * @param table_range each interval is the [min, max] of an
+     * attribute
+     */
+    TableStatistics(shared_ptr<const Schema> table_schema,
+                    const Boundary &table_range);
+
+    shared_ptr<const Schema> getSchema() const
+    {
+        return table_schema;
+    }
+
+    bool hasRange(int offset) const
+    {
+        return offset >= 0 && offset < ranges.size() && ranges[offset];
+    }
+
+    /**
+     * @brief Get the closed interval [min, max] of an attribute
+     *
+     * @param offset the offset of the attribute in the table schema
+     * @return const shared_ptr<const Interval>&
+     */
+    const shared_ptr<const Interval> &getRange(int offset) const;
+
+    const shared_ptr<const Interval> &getRange(
+        const string &attribute) const;
+
+    shared_ptr<const DataType> getMinValue(int offset) const
+    {
+        getRange(offset);
+        return min_values[offset];
+    }
+
+    shared_ptr<const DataType> getMaxValue(int offset) const
+    {
+        getRange(offset);
+        return max_values[offset];
+    }
+
+    /**
+     * @brief Get the attributes that have a value range, in the order
+     * of the table schema
+     *
+     * @return vector<string>
+     */
+    vector<string> getAttributes() const;
+
+    // the row sample of the table, nullptr if there is none
+    shared_ptr<const TableSample> getSample() const
+    {
+        return sample;
+    }
+
+    /**
+     * @brief Copy the statistics with a row sample of the table. Only
+     * the boundaries built from the copy can estimate row numbers on
+     * the sample, so attach it before parsing blocks and queries.
+     *
+     * @param sample
+     * @return shared_ptr<const TableStatistics>
+     */
+    shared_ptr<const TableStatistics> withSample(
+        shared_ptr<const TableSample> sample) const;
+
+    /**
+     * @brief Get the value range of an attribute from the first
+     * statistics that is not nullptr. Used to fill the missing
+     * attributes when comparing two boundaries.
+     *
+     * @param offset the offset of the attribute in the table schema
+     * @param first
+     * @param second
+     * @return const Interval&
+     */
+    static const Interval &findRange(int offset,
+                                     const TableStatistics *first,
+                                     const TableStatistics *second);
+
+    /**
+     * @brief Parse the table range file, a partition with a single
+     * block whose boundary is the value range of the table
+     *
+     * @param serialized
+     * @param table_schema
+     * @return shared_ptr<const TableStatistics>
+     */
+    static shared_ptr<const TableStatistics> parseSubstraitTableRange(
+        const substrait::Partition *serialized,
+        shared_ptr<const Schema> table_schema);
+
+  private:
+    shared_ptr<const Schema> table_schema;
+    vector<shared_ptr<const Interval>> ranges;
+    vector<shared_ptr<const DataType>> min_values;
+    vector<shared_ptr<const DataType>> max_values;
+    shared_ptr<const TableSample> sample;
+};
@@ -1,4 +1,5 @@
 #include "partitioner/common.h"
+#include "arena.h"
 #include "exceptions.h"
 #include "partitioner/model.h"
 #include <algorithm>
@@ -23,6 +24,12 @@ PartitionParameter PartitionParameter::parse(int argc,
             p.test_query_path = argv[idx++];
         else if (op == "--partition_path")
             p.partition_path = argv[idx++];
+        else if (op == "--sample_path")
+            p.sample_path = argv[idx++];
+        else if (op == "--rows_path")
+            p.rows_path = argv[idx++];
+        else if (op == "--sorted_blocks")
+            p.sorted_blocks = true;
         else if (op == "--type")
         {
             string type = argv[idx++];
@@ -61,22 +68,21 @@ double estimateCost(
 
     double io_cost(0), recons_cost(0);
 
-    unordered_map<shared_ptr<const BlockMeta>, boost::dynamic_bitset<>>
+    unordered_map<shared_ptr<const BlockMeta>, AttributeSet>
         read_attributes_in_direct;
     // estimate I/O size in direct
     for (auto p : direct_params)
     {
         assert(p->blocks.size() == 1);
         auto b = *p->blocks.begin();
-        io_size += b->estimateIOSize(
-            table_schema->get(p->read_attributes)->getAttributeNames());
+        io_size += b->estimateIOSize(p->read_attributes);
 
         io_row_num += b->getRowNum();
         read_attributes_in_direct[b] = p->read_attributes;
     }
 
     // estimate I/O and reconstruct in recons_params
-    boost::dynamic_bitset<> recons_attributes(table_schema->size());
+    AttributeSet recons_attributes(table_schema->size());
     for (auto p : recons_params)
     {
         assert(p->blocks.size() == 1);
@@ -85,8 +91,7 @@ double estimateCost(
         if (read_attributes_in_direct.count(b))
             read_attributes -= read_attributes_in_direct[b];
 
-        io_size += b->estimateIOSize(
-            table_schema->get(read_attributes)->getAttributeNames());
+        io_size += b->estimateIOSize(read_attributes);
         io_row_num += b->getRowNum();
 
         recons_attributes |= p->project_attributes;
@@ -135,7 +140,8 @@ double estimateCost(
         *produceParameter)(
         shared_ptr<const Query> query,
         shared_ptr<const Schema> table_schema,
-        const vector<shared_ptr<const PartitionMeta>> &partitions),
+        const vector<shared_ptr<const PartitionMeta>> &partitions,
+        std::pmr::memory_resource *resource),
     double (*aggModel)(unsigned long long, unsigned long long,
                        unsigned long long))
 {
@@ -153,10 +159,62 @@ double estimateCost(
     for (auto q : queries)
     {
         printf("cost of Q%d\t%s:\n", qid++, q->toString().c_str());
-        auto params = produceParameter(q, table_schema, partitions);
+        QueryArena arena;
+        auto params = produceParameter(q, table_schema, partitions,
+                                       arena.resource());
         total_time += estimateCost(params.second, params.first,
                                    table_schema, aggModel, true);
     }
     printf("Total time is %.2f seconds\n", total_time);
     return total_time;
-}
\ No newline at end of file
+}
+
+vector<shared_ptr<const PartitionMeta>> makePartitions(
+    const vector<shared_ptr<const BlockMeta>> &blocks,
+    const boost::dynamic_bitset<> &accessed_attributes,
+    shared_ptr<const Schema> table_schema,
+    const TableSample *table_rows)
+{
+    // find all vertical partitions
+    vector<pair<boost::dynamic_bitset<>,
+                vector<shared_ptr<const BlockMeta>>>>
+        column_blocks;
+    for (auto b : blocks)
+    {
+        // skip the block if it does not contain any used attributes
+        auto attr = table_schema->getOffsets(b->getSchema());
+        if ((accessed_attributes & attr).count() == 0)
+            continue;
+        auto it = column_blocks.begin();
+        for (; it != column_blocks.end(); it++)
+        {
+            if (it->first == attr)
+                break;
+        }
+        if (it == column_blocks.end())
+        {
+            column_blocks.push_back(
+                make_pair(attr, vector<shared_ptr<const BlockMeta>>{}));
+            it = column_blocks.end() - 1;
+        }
+
+        it->second.push_back(b);
+    }
+
+    vector<shared_ptr<const PartitionMeta>> layout;
+    for (auto it = column_blocks.begin(); it != column_blocks.end();
+         it++)
+    {
+        auto p = make_shared<PartitionMeta>("");
+        for (auto b : it->second)
+        {
+            shared_ptr<BlockMeta> i = shared_ptr<BlockMeta>(b->clone());
+            // the tuples of the block are the rows in its boundary
+            if (table_rows)
+                i->setTupleIDs(table_rows->tupleIDs(*i->getBoundary()));
+            p->addBlock(i);
+        }
+        layout.push_back(p);
+    }
+    return layout;
+}
@@ -1,6 +1,9 @@
 #pragma once
+#include "evaluate/table_sample.h"
 #include "metadata/boundary.h"
 #include "produce_plan/scan_parameter.h"
+#include <boost/dynamic_bitset.hpp>
+#include <memory_resource>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -24,7 +27,15 @@ struct PartitionParameter
     string validation_path;
     string test_query_path;
     string partition_path;
+    // the row sample of the table to estimate row numbers. Optional
+    string sample_path;
+    // every row of the table in the format of the sample, to write the
+    // tuple ids of each block. Optional
+    string rows_path;
     PartitionType partition_type;
+    // true if the data files keep the tuples of each block in the
+    // order of the tuple ids
+    bool sorted_blocks = false;
 
     static PartitionParameter parse(int argc, char const *argv[]);
 };
@@ -48,6 +59,25 @@ double estimateCost(
         *produceParameter)(
         shared_ptr<const Query> query,
         shared_ptr<const Schema> table_schema,
-        const vector<shared_ptr<const PartitionMeta>> &partitions),
+        const vector<shared_ptr<const PartitionMeta>> &partitions,
+        std::pmr::memory_resource *resource),
     double (*aggModel)(unsigned long long, unsigned long long,
-                       unsigned long long));
\ No newline at end of file
+                       unsigned long long));
+
+/**
+ * @brief Group the blocks into the partitions of the layout, one per
+ * set of attributes. A block is dropped if it has none of the accessed
+ * attributes.
+ *
+ * @param blocks
+ * @param accessed_attributes
+ * @param table_schema
+ * @param table_rows every row of the table, to set the tuple ids of
+ * each block. Can be null
+ * @return vector<shared_ptr<const PartitionMeta>>
+ */
+vector<shared_ptr<const PartitionMeta>> makePartitions(
+    const vector<shared_ptr<const BlockMeta>> &blocks,
+    const boost::dynamic_bitset<> &accessed_attributes,
+    shared_ptr<const Schema> table_schema,
+    const TableSample *table_rows);
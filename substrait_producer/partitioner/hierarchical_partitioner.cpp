@@ -1,4 +1,5 @@
 #include "partitioner/hierarchical_partitioner.h"
+#include "arena.h"
 #include "partitioner/common.h"
 #include "partitioner/horizontal_partitioner.h"
 #include "partitioner/model.h"
@@ -32,54 +33,47 @@ vector<Block_Pattern> columnBlocks(
 {
     vector<Block_Pattern> columns;
     auto table_schema = table->getSchema();
-    auto attribute_names = table_schema->getAttributeNames();
-    attribute_names.erase(tuple_id_name);
     auto tid = table_schema->get(tuple_id_name);
 
     // get attributes accessed by each query
-    vector<unordered_set<string>> query_attributes[2];
-    unordered_set<string> filter_attributes;
+    vector<AttributeSet> query_attributes[2];
+    AttributeSet filter_attributes;
     for (auto q : queries)
     {
-        auto filter_attr = q->getFilterBoundary()->getAttributes();
-        auto project_attr = q->getAllReferredAttributes();
-        for (const auto &a : filter_attr)
-            project_attr.erase(a);
-
+        const auto &filter_attr = q->attributesInFilter();
         query_attributes[0].push_back(filter_attr);
-        query_attributes[1].push_back(project_attr);
-        filter_attributes.insert(filter_attr.begin(),
-                                 filter_attr.end());
+        query_attributes[1].push_back(q->getAllReferredAttributes() -
+                                      filter_attr);
+        filter_attributes |= filter_attr;
     }
 
-    vector<pair<unordered_set<string>, boost::dynamic_bitset<>>>
+    vector<pair<vector<shared_ptr<Attribute>>, boost::dynamic_bitset<>>>
         patterns[2];
 
-    for (auto a : attribute_names)
+    for (int k = 0; k < table_schema->size(); k++)
     {
+        auto attr = table_schema->get(k);
+        if (attr == tid)
+            continue;
+        int a = attr->getTableOffset();
         int idx = 1;
-        if (filter_attributes.count(a))
+        if (filter_attributes.test(a))
             idx = 0;
-        auto s = make_shared<Schema>();
-        s->add(table_schema->get(a));
         boost::dynamic_bitset<> b(queries.size());
         for (int i = 0; i < queries.size(); i++)
-        {
-            auto r = s->relationship(query_attributes[idx][i]);
-            if (r != SET_RELATION::DISJOINT)
+            if (query_attributes[idx][i].test(a))
                 b.set(i);
-        }
 
         auto it = patterns[idx].begin();
         for (; it != patterns[idx].end(); it++)
             if (it->second == b)
             {
-                it->first.insert(a);
+                it->first.push_back(attr);
                 break;
             }
         if (it == patterns[idx].end())
             patterns[idx].push_back(
-                make_pair(unordered_set<string>{a}, b));
+                make_pair(vector<shared_ptr<Attribute>>{attr}, b));
     }
 
     for (int i = 0; i < 2; i++)
@@ -89,10 +83,11 @@ vector<Block_Pattern> columnBlocks(
             auto s = make_shared<Schema>();
             s->add(tid);
             for (auto a : p.first)
-                s->add(table_schema->get(a));
+                s->add(a);
             auto column =
                 make_shared<BlockMeta>(0, table->getBoundary(), s,
                                        nullptr, table->getRowNum());
+            column->setSortedByTid(table->isSortedByTid());
             columns.push_back(make_pair(column, p.second));
         }
     }
@@ -209,8 +204,10 @@ vector<shared_ptr<const BlockMeta>> partitionColumnGroups(
         {
             if (i % thread_num != thread_id)
                 continue;
-            auto params = produceParameters(v_validate_queries[i],
-                                            table_schema, partitions);
+            QueryArena arena;
+            auto params =
+                produceParameters(v_validate_queries[i], table_schema,
+                                  partitions, arena.resource());
             double c =
                 estimateCost(params.second, params.first, table_schema,
                              aggModel, print_stats);
@@ -248,20 +245,23 @@ std::vector<std::pair<int, int>> pairColumnGroupsSample(
     unordered_set<std::pair<int, int>, boost::hash<pair<int, int>>> ans;
 
     // find the location of each attribute
-    unordered_map<string, int> group_attributes;
+    vector<int> group_attributes(AttributeSet::capacity, 0);
     for (int i = 0; i < column_groups.size(); i++)
     {
-        auto attrs =
-            column_groups[i].first->getSchema()->getAttributeNames();
-        for (const string &a : attrs)
+        const auto &attrs =
+            column_groups[i].first->getSchema()->getAttributeSet();
+        for (int a = attrs.findFirst(); a != AttributeSet::npos;
+             a = attrs.findNext(a))
             group_attributes[a] = i;
     }
     for (auto q : train_queries)
     {
-        auto filter_attr = q->getFilterBoundary()->getAttributes();
-        auto proj_attr = q->getAllReferredAttributes();
-        for (const auto &fa : filter_attr)
-            for (const auto &pa : proj_attr)
+        const auto &filter_attr = q->attributesInFilter();
+        const auto &proj_attr = q->getAllReferredAttributes();
+        for (int fa = filter_attr.findFirst(); fa != AttributeSet::npos;
+             fa = filter_attr.findNext(fa))
+            for (int pa = proj_attr.findFirst();
+                 pa != AttributeSet::npos; pa = proj_attr.findNext(pa))
             {
                 int i = group_attributes[fa], j = group_attributes[pa];
                 if (i == j)
@@ -323,13 +323,12 @@ std::vector<std::pair<int, int>> pairColumnGroupsWOUnique(
     const vector<Block_Pattern> &column_groups,
     const vector<shared_ptr<const Query>> &queries)
 {
-    unordered_set<string> filter_attrs;
-    vector<unordered_set<string>> query_attributes;
+    AttributeSet filter_attrs;
+    vector<AttributeSet> query_attributes;
     for (auto q : queries)
     {
-        auto a = q->getFilterBoundary()->getAttributes();
-        filter_attrs.insert(a.begin(), a.end());
-        a = q->getAllReferredAttributes();
+        filter_attrs |= q->attributesInFilter();
+        const auto &a = q->getAllReferredAttributes();
         auto it = query_attributes.begin();
         for (; it != query_attributes.end(); it++)
             if (*it == a)
@@ -2,13 +2,15 @@
 #include "metadata/boundary.h"
 #include "metadata/query.h"
 #include "produce_plan/scan_parameter.h"
+#include <memory_resource>
 
 typedef std::pair<vector<shared_ptr<const ScanParameter>>,
                   vector<shared_ptr<const ScanParameter>>> (
     *ParameterFunction)(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const PartitionMeta>> &partitions);
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    std::pmr::memory_resource *resource);
 
 vector<shared_ptr<const BlockMeta>> hierarchicalPartition(
     shared_ptr<BlockMeta> table,
@@ -19,9 +19,9 @@ size_t estimateIOSize(
 {
     intersect_queries.clear();
     size_t size = 0;
-    for (auto q : queries)
+    for (const auto &q : queries)
     {
-        auto query_attributes = q->getAllReferredAttributes();
+        const auto &query_attributes = q->getAllReferredAttributes();
         SET_RELATION rel = block->relationship(q->getFilterBoundary(),
                                                query_attributes);
         if (rel == SET_RELATION::DISJOINT)
@@ -51,6 +51,7 @@ vector<shared_ptr<const BlockMeta>> resizeBlock(
     for (auto it = ratio.begin(); it != ratio.end(); it++)
         sum += it->second;
     auto intervals = block->getBoundary()->getIntervals();
+    auto table_schema = block->getBoundary()->getStatistics()->getSchema();
     unordered_set<string> checked_attr;
 
     vector<shared_ptr<BlockMeta>> candidates;
@@ -70,8 +71,9 @@ vector<shared_ptr<const BlockMeta>> resizeBlock(
         checked_attr.insert(attr);
 
         // split the block
-        assert(intervals.count(attr) > 0);
-        auto i = intervals[attr];
+        int offset = table_schema->getOffset(attr);
+        assert(intervals.count(offset) > 0);
+        auto i = intervals[offset];
         auto p = shared_ptr<DataType>(
             i->getMin()->middle(i->getMax().get(), 0.5));
         candidates = block->split(attr, p, true);
@@ -89,21 +91,23 @@ vector<shared_ptr<const BlockMeta>> resizeBlock(
 
     if (!has_produced && candidates.size() == 0)
     {
-        auto min_max_attrs = getMinMaxAttributes();
+        auto statistics = block->getBoundary()->getStatistics();
+        auto min_max_attrs = statistics->getAttributes();
         for (auto a : min_max_attrs)
         {
             shared_ptr<DataType> p;
-            if (intervals.count(a))
+            int offset = table_schema->getOffset(a);
+            if (intervals.count(offset))
             {
-                auto i = intervals[a];
+                auto i = intervals[offset];
                 p = shared_ptr<DataType>(
                     i->getMin()->middle(i->getMax().get(), 0.5));
             }
             else
             {
-                auto min_v = getMinValue(a), max_v = getMaxValue(a);
+                auto &i = statistics->getRange(offset);
                 p = shared_ptr<DataType>(
-                    min_v->middle(max_v.get(), 0.5));
+                    i->getMin()->middle(i->getMax().get(), 0.5));
             }
 
             candidates = block->split(a, p, true);
@@ -171,66 +175,50 @@ vector<shared_ptr<const BlockMeta>> horizontalPartition(
     // sample 30 queries
     auto sample_queries = sampleQueries(queries, 30, block);
 
-    for (auto q : sample_queries)
-    {
-        auto intervals = q->getFilterBoundary()->getIntervals();
-        for (auto it = intervals.begin(); it != intervals.end(); it++)
+    // split the block at a point and keep the split if it is the
+    // cheapest one so far
+    auto try_split = [&](const string &attr, shared_ptr<DataType> point,
+                         bool point_target) {
+        auto candidate = block->split(attr, point, point_target);
+        if (candidate.size() == 0)
+            return;
+        assert(candidate.size() == 2);
+        unordered_set<shared_ptr<const Query>> q1, q2;
+        size_t cost = 0;
+        cost += estimateIOSize(candidate[0], queries, q1);
+        cost += estimateIOSize(candidate[1], queries, q2);
+        if (cost < min_cost)
         {
-            string attr = it->first;
-            auto min_val = it->second->getMin(),
-                 max_val = it->second->getMax();
+            min_cost = cost;
+            auto snum = split_num;
+            if (snum.count(attr))
+                snum[attr]++;
+            else
+                snum[attr] = 1;
 
-            auto candidate = block->split(attr, min_val, false);
-            if (candidate.size() > 0)
+            // avoid to produce small partitions
+            if (!stopCondition(candidate[0]) &&
+                !stopCondition(candidate[1]))
             {
-                assert(candidate.size() == 2);
-                unordered_set<shared_ptr<const Query>> q1, q2;
-                size_t cost = 0;
-                cost += estimateIOSize(candidate[0], queries, q1);
-                cost += estimateIOSize(candidate[1], queries, q2);
-                if (cost < min_cost)
-                {
-                    min_cost = cost;
-                    auto snum = split_num;
-                    if (snum.count(attr))
-                        snum[attr]++;
-                    else
-                        snum[attr] = 1;
-
-                    // avoid to produce small partitions
-                    if (!stopCondition(candidate[0]) &&
-                        !stopCondition(candidate[1]))
-                    {
-                        children[0] = {candidate[0], q1, snum};
-                        children[1] = {candidate[1], q2, snum};
-                    }
-                }
+                children[0] = {candidate[0], q1, snum};
+                children[1] = {candidate[1], q2, snum};
             }
+        }
+    };
 
-            candidate = block->split(attr, max_val, true);
-            if (candidate.size() > 0)
+    for (auto q : sample_queries)
+    {
+        // each interval accepted by the query filter gives two split
+        // points
+        const auto &intervals = q->getFilterBoundary()->getIntervals();
+        auto table_schema = q->getTableSchema();
+        for (auto it = intervals.begin(); it != intervals.end(); it++)
+        {
+            string attr = table_schema->get(it->first)->getName();
+            for (const auto &i : it->second)
             {
-                assert(candidate.size() == 2);
-                unordered_set<shared_ptr<const Query>> q1, q2;
-                size_t cost = 0;
-                cost += estimateIOSize(candidate[0], queries, q1);
-                cost += estimateIOSize(candidate[1], queries, q2);
-                if (cost < min_cost)
-                {
-                    min_cost = cost;
-                    auto snum = split_num;
-                    if (snum.count(attr))
-                        snum[attr]++;
-                    else
-                        snum[attr] = 1;
-
-                    if (!stopCondition(candidate[0]) &&
-                        !stopCondition(candidate[1]))
-                    {
-                        children[0] = {candidate[0], q1, snum};
-                        children[1] = {candidate[1], q2, snum};
-                    }
-                }
+                try_split(attr, i->getMin(), false);
+                try_split(attr, i->getMax(), true);
             }
         }
     }
@@ -31,4 +31,26 @@ double predictAggTimeLate(unsigned long long insert_num,
     double coefficients[3] = {0.7224, 0.01, 0.011};
     return insert_m * coefficients[0] + total_m * coefficients[1] +
            valid_m * coefficients[2];
-}
\ No newline at end of file
+}
+
+double predictJoinTime(unsigned long long build_num,
+                       unsigned long long probe_num,
+                       unsigned long long valid_cells)
+{
+    double build_m = (double)build_num / (1024 * 1024);
+    double probe_m = (double)probe_num / (1024 * 1024);
+    double valid_m = (double)valid_cells / (1024 * 1024);
+    // the coefficients of predictAggTimeLate, not calibrated for joins
+    double coefficients[2] = {0.7224, 0.011};
+    return (build_m + probe_m) * coefficients[0] +
+           valid_m * coefficients[1];
+}
+
+double predictSortTime(unsigned long long comparisons)
+{
+    double comparisons_m = (double)comparisons / (1024 * 1024);
+    // the total cells coefficient of predictAggTimeLate, not
+    // calibrated for sorts
+    double coefficient = 0.01;
+    return comparisons_m * coefficient;
+}
@@ -32,4 +32,33 @@ double predictAggTimeEarly(unsigned long long insert_num,
  */
 double predictAggTimeLate(unsigned long long insert_num,
                           unsigned long long total_cells,
-                          unsigned long long valid_cells);
\ No newline at end of file
+                          unsigned long long valid_cells);
+
+/**
+ * @brief Predict the time of the hash joins on the tuple id in the join
+ * reconstruction in Velox (6 threads) on balos. The joins are not
+ * calibrated: the model reuses the coefficients of predictAggTimeLate,
+ * whose hash table is also keyed by the tuple id. A built or probed
+ * tuple costs an insert and a cell carried through a join costs a
+ * valid cell.
+ *
+ * @param build_num number of tuples inserted into the hash tables
+ * @param probe_num number of tuples probing the hash tables
+ * @param valid_cells number of cells carried through the joins
+ * @return double predicted time in seconds
+ */
+double predictJoinTime(unsigned long long build_num,
+                       unsigned long long probe_num,
+                       unsigned long long valid_cells);
+
+/**
+ * @brief Predict the time of the sort on the tuple id in the merge
+ * reconstruction in Velox (6 threads) on balos. The sort is not
+ * calibrated: a comparison costs a hash table cell of
+ * predictAggTimeLate. The aggregation above the sort is predicted by
+ * predictAggTimeLate, since the consumer still builds its hash table.
+ *
+ * @param comparisons number of comparisons of the sort
+ * @return double predicted time in seconds
+ */
+double predictSortTime(unsigned long long comparisons);
@@ -1,5 +1,7 @@
 #include "baselines/produce_scan_parameter.h"
+#include "evaluate/table_sample.h"
 #include "google/protobuf/util/json_util.h"
+#include "metadata/block_catalog.h"
 #include "metadata/boundary.h"
 #include "metadata/query.h"
 #include "metadata/schema.h"
@@ -15,13 +17,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-void setMinMax(const Boundary *boundary)
-{
-    auto intervals = boundary->getIntervals();
-    for (auto p : intervals)
-        setMinMax(p.first, p.second->getMin(), p.second->getMax());
-}
-
 int main(int argc, char const *argv[])
 {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
@@ -29,33 +24,40 @@ int main(int argc, char const *argv[])
 
     // parse schema
     shared_ptr<Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
     shared_ptr<BlockMeta> root_block;
     unordered_set<shared_ptr<const Query>> queries, validate_queries,
         test_queries;
 
-    {
-        substrait::NamedStruct s;
-        readSubstrait(&s, parameter.schema_path);
-        table_schema = Schema::parseSubstraitSchema(&s);
-    }
-    // set min/max
+    table_schema = Schema::readSchema(parameter.schema_path);
+    // get min/max
     {
         substrait::Partition s;
         readSubstrait(&s, parameter.table_range_path);
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+        if (!parameter.sample_path.empty())
+            statistics = statistics->withSample(TableSample::readSample(
+                parameter.sample_path, table_schema));
         auto p = PartitionMeta::parseSubstraitPartition(
-            &s, table_schema, "", false);
+            &s, table_schema, statistics, "", false);
         root_block = shared_ptr<BlockMeta>(p->getBlocks()[0]->clone());
-        setMinMax(root_block->getBoundary().get());
-        unordered_map<string, shared_ptr<const Interval>>
-            empty_intervals;
-        root_block->setBoundary(make_shared<Boundary>(empty_intervals));
+        // the root block is the entire table. Use the table schema so
+        // that the attribute offsets in the block schema are the table
+        // offsets that attribute sets and scan parameters refer to
+        root_block->setSchema(table_schema);
+        IntervalMap empty_intervals;
+        root_block->setBoundary(
+            make_shared<Boundary>(empty_intervals, statistics));
+        root_block->setSortedByTid(parameter.sorted_blocks);
     }
     // parse query
     {
         {
             substrait::Plan p;
             readSubstrait(&p, parameter.query_path);
-            auto q = Query::parseSubstraitQuery(&p, table_schema, "");
+            auto q = Query::parseSubstraitQuery(&p, table_schema,
+                                                 statistics, "");
             for (auto i : q)
                 queries.insert(i);
         }
@@ -63,7 +65,8 @@ int main(int argc, char const *argv[])
         {
             substrait::Plan p;
             readSubstrait(&p, parameter.validation_path);
-            auto q = Query::parseSubstraitQuery(&p, table_schema, "");
+            auto q = Query::parseSubstraitQuery(&p, table_schema,
+                                                 statistics, "");
             for (auto i : q)
                 validate_queries.insert(i);
         }
@@ -72,7 +75,8 @@ int main(int argc, char const *argv[])
         {
             substrait::Plan p;
             readSubstrait(&p, parameter.test_query_path);
-            auto q = Query::parseSubstraitQuery(&p, table_schema, "");
+            auto q = Query::parseSubstraitQuery(&p, table_schema,
+                                                 statistics, "");
             for (auto i : q)
                 test_queries.insert(i);
         }
@@ -112,11 +116,8 @@ int main(int argc, char const *argv[])
     // boundary
     boost::dynamic_bitset<> accessed_attributes(table_schema->size());
     for (auto q : validate_queries)
-    {
-        auto attr = q->getAllReferredAttributes();
-        for (auto a : attr)
-            accessed_attributes.set(table_schema->getOffset(a));
-    }
+        accessed_attributes |= q->getAllReferredAttributes().toBitset(
+            table_schema->size());
     for (auto b : blocks)
     {
         auto attr = table_schema->getOffsets(b->getSchema());
@@ -127,53 +128,34 @@ int main(int argc, char const *argv[])
             accessed_attributes.set(table_schema->getOffset(a));
     }
 
-    // find all vertical partitions
-    vector<pair<boost::dynamic_bitset<>,
-                vector<shared_ptr<const BlockMeta>>>>
-        column_blocks;
-    for (auto b : blocks)
+    // the tuple ids of each block are read from every row of the table
+    shared_ptr<const TableSample> table_rows;
+    if (!parameter.rows_path.empty())
     {
-        // skip the block if it does not contain any used attributes
-        auto attr = table_schema->getOffsets(b->getSchema());
-        if ((accessed_attributes & attr).count() == 0)
-            continue;
-        auto it = column_blocks.begin();
-        for (; it != column_blocks.end(); it++)
-        {
-            if (it->first == attr)
-                break;
-        }
-        if (it == column_blocks.end())
-        {
-            column_blocks.push_back(
-                make_pair(attr, vector<shared_ptr<const BlockMeta>>{}));
-            it = column_blocks.end() - 1;
-        }
-
-        it->second.push_back(b);
+        table_rows =
+            TableSample::readSample(parameter.rows_path, table_schema);
+        if (root_block->hasRowNum() &&
+            (int64_t)table_rows->numOfRows() != root_block->getRowNum())
+            throw Exception("partitioner: " + parameter.rows_path +
+                            " does not hold every row of the table");
     }
-
+    auto layout = makePartitions(blocks, accessed_attributes,
+                                 table_schema, table_rows.get());
     int pid = 0;
-    for (auto it = column_blocks.begin(); it != column_blocks.end();
-         it++)
+    for (auto p : layout)
     {
-        PartitionMeta p("");
-        for (auto b : it->second)
-        {
-            shared_ptr<BlockMeta> i = shared_ptr<BlockMeta>(b->clone());
-            p.addBlock(i);
-            cout << i->toString() << endl;
-        }
-        p.makeSubstraitPartition(plist.add_partitions(), pid++,
-                                 table_schema);
+        for (auto b : p->getBlocks())
+            cout << b->toString() << endl;
+        p->makeSubstraitPartition(plist.add_partitions(), pid++,
+                                  table_schema);
     }
 
-    for (auto it = column_blocks.begin(); it != column_blocks.end();
-         it++)
+    for (auto p : layout)
     {
-        auto attr = table_schema->get(it->first);
+        auto attr = table_schema->get(
+            table_schema->getOffsets(p->getBlocks()[0]->getSchema()));
         int64_t tnum = 0;
-        for (auto b : it->second)
+        for (auto b : p->getBlocks())
             tnum += b->getRowNum();
         printf("Schema %s has %lld tuples\n", attr->toString().c_str(),
                tnum);
@@ -197,6 +179,9 @@ int main(int argc, char const *argv[])
                           ios::trunc | ios::binary);
     plist.SerializeToOstream(&ofile_binary);
     ofile_binary.close();
+    BlockCatalog::writeCatalog(
+        parameter.partition_path + BlockCatalog::suffix, layout,
+        table_schema);
 
     google::protobuf::ShutdownProtobufLibrary();
     return 0;
@@ -0,0 +1,167 @@
+#include "plan_cache.h"
+#include "exceptions.h"
+#include <filesystem>
+#include <functional>
+#include <stdio.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// the version of the cache entries. Bump it when the planner changes
+// the plan of a query, so that the plans cached before are missed, or
+// when the layout of an entry changes
+const int kCacheVersion = 2;
+
+// the 128-bit FNV-1a, so that a digest of the files collides with
+// negligible probability
+typedef unsigned __int128 Digest;
+const Digest kFnvOffset =
+    ((Digest)0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+const Digest kFnvPrime = ((Digest)1 << 88) | 0x13b;
+
+// FNV-1a, chained over several inputs through hash
+Digest hashBytes(const char *bytes, size_t size, Digest hash)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// the string is followed by its size, so that the inputs chained do
+// not run into each other
+Digest hashString(const string &s, Digest hash)
+{
+    hash = hashBytes(s.data(), s.size(), hash);
+    uint64_t size = s.size();
+    return hashBytes((const char *)&size, sizeof(size), hash);
+}
+
+// an unset path hashes as an empty file
+Digest hashFile(const string &path, Digest hash)
+{
+    if (path.empty())
+        return hashString("", hash);
+    MappedFile file(path);
+    hash = hashBytes(file.data(), file.size(), hash);
+    uint64_t size = file.size();
+    return hashBytes((const char *)&size, sizeof(size), hash);
+}
+
+string toHex(Digest digest)
+{
+    char hex[33];
+    snprintf(hex, sizeof(hex), "%016lx%016lx",
+             (unsigned long)(digest >> 64), (unsigned long)digest);
+    return hex;
+}
+} // namespace
+
+PlanCache::PlanCache(const InputParameter &parameter,
+                     const string &planner)
+    : dir(parameter.plan_cache_dir)
+{
+    if (dir.empty())
+        return;
+    fs::create_directories(dir);
+
+    fingerprint =
+        hashString(std::to_string(kCacheVersion), kFnvOffset);
+    fingerprint = hashString(planner, fingerprint);
+    fingerprint = hashFile(parameter.schema_path, fingerprint);
+    // the dictionaries decide the codes of the strings, and a schema
+    // without them hashes as an empty file
+    string dictionary_path =
+        parameter.schema_path + Schema::dictionary_suffix;
+    if (!fs::exists(dictionary_path))
+        dictionary_path.clear();
+    fingerprint = hashFile(dictionary_path, fingerprint);
+    fingerprint = hashFile(parameter.table_range_path, fingerprint);
+    fingerprint = hashFile(parameter.sample_path, fingerprint);
+    // the catalog replaces the partition file
+    bool from_catalog = !parameter.catalog_path.empty();
+    fingerprint =
+        hashString(from_catalog ? "catalog" : "partition", fingerprint);
+    fingerprint = hashFile(from_catalog ? parameter.catalog_path
+                                        : parameter.partition_path,
+                           fingerprint);
+    fingerprint = hashString(parameter.data_path, fingerprint);
+    string options = std::to_string(parameter.engine) + "," +
+                     std::to_string(parameter.reconstruct) + "," +
+                     std::to_string(parameter.parallel);
+    fingerprint = hashString(options, fingerprint);
+}
+
+bool PlanCache::read(const Query &query, substrait::Plan *plan) const
+{
+    string file = path(query);
+    if (!fs::exists(file))
+        return false;
+    // a hash collision, an entry of another version or a damaged entry
+    // is a miss, and the entry is rewritten with the plan of the query
+    try
+    {
+        MappedFile entry(file);
+        string key = makeKey(query);
+        if (entry.size() < key.size() ||
+            key.compare(0, key.size(), entry.data(), key.size()) != 0)
+            return false;
+        if (plan->ParseFromArray(entry.data() + key.size(),
+                                 entry.size() - key.size()))
+            return true;
+    }
+    catch (const Exception &)
+    {
+    }
+    plan->Clear();
+    return false;
+}
+
+void PlanCache::write(const Query &query,
+                      const substrait::Plan &plan) const
+{
+    string file = path(query);
+    // unique to the process and the thread
+    string temporary =
+        file + ".tmp" + std::to_string(getpid()) + "_" +
+        std::to_string(std::hash<std::thread::id>()(
+            std::this_thread::get_id()));
+    string entry = makeKey(query);
+    if (!plan.AppendToString(&entry))
+        throw Exception("PlanCache: cannot serialize the plan of " +
+                        file);
+    FILE *out = fopen(temporary.c_str(), "wb");
+    if (!out)
+        throw Exception("PlanCache: cannot open " + temporary);
+    bool written = fwrite(entry.data(), 1, entry.size(), out) ==
+                   entry.size();
+    if (fclose(out) != 0 || !written)
+        throw Exception("PlanCache: cannot write " + temporary);
+    fs::rename(temporary, file);
+}
+
+string PlanCache::makeKey(const Query &query) const
+{
+    const string &source = query.getSource();
+    if (source.empty())
+        throw Exception("PlanCache: the query has no source");
+    return "plan_cache " + std::to_string(kCacheVersion) + "\n" +
+           toHex(fingerprint) + "\n" + std::to_string(source.size()) +
+           "\n" + source;
+}
+
+string PlanCache::path(const Query &query) const
+{
+    const string &source = query.getSource();
+    if (source.empty())
+        throw Exception("PlanCache: the query has no source");
+    char name[17];
+    snprintf(name, sizeof(name), "%016lx",
+             (unsigned long)hashString(source, fingerprint));
+    return dir + "/" + name + ".plan";
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "configuration.h"
+#include "metadata/query.h"
+#include "substrait/plan.pb.h"
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/**
+ * @brief A cache of the plans on disk, one entry per file named after
+ * the hash of its key. The key is the source of the query and the
+ * fingerprint of everything else the plan depends on: the version of
+ * the cache, the planner, the contents of the schema, its string
+ * dictionaries, the table range, sample and partition or catalog
+ * files, the data path, the engine, the reconstruct type and the
+ * parallel method. An entry holds its key followed by the binary
+ * substrait::Plan, and a read compares the key, so a collision of the
+ * file names is a miss. A new layout thus misses
+ * the plans of the old one, which stay in the dir until it is cleared.
+ * The data files themselves are not read, so the cache must be cleared
+ * if they are rewritten under the same layout.
+ *
+ * A plan is written to a temporary file and renamed, so concurrent
+ * planners, threads or processes, share one dir and a reader never
+ * sees a partial plan.
+ */
+class PlanCache
+{
+  public:
+    /**
+     * @brief Open the cache of parameter.plan_cache_dir, created if it
+     * does not exist. The cache is disabled if the dir is not set
+     *
+     * @param parameter
+     * @param planner the name of the program producing the plans, as
+     * the programs plan the same query differently
+     */
+    PlanCache(const InputParameter &parameter, const string &planner);
+
+    bool enabled() const
+    {
+        return !dir.empty();
+    }
+
+    /**
+     * @brief Read the cached plan of a query
+     *
+     * @param query
+     * @param plan OUTPUT: the cached plan
+     * @return false if the plan is not cached, or if the entry is of
+     * another key or cannot be parsed. Writing the plan then replaces
+     * the entry
+     */
+    bool read(const Query &query, substrait::Plan *plan) const;
+
+    void write(const Query &query, const substrait::Plan &plan) const;
+
+  private:
+    string dir;
+    // the 128-bit FNV-1a of the inputs of the fingerprint
+    unsigned __int128 fingerprint;
+
+    string path(const Query &query) const;
+
+    // the key stored at the head of the entry of a query
+    string makeKey(const Query &query) const;
+};
@@ -0,0 +1,68 @@
+#include "plan_writer.h"
+#include "exceptions.h"
+
+PlanWriter::PlanWriter(const InputParameter &parameter)
+    : plan_dir(parameter.plan_dir), format(parameter.plan_format)
+{
+    if (!parameter.plan_stream_path.empty())
+        stream =
+            make_unique<DelimitedWriter>(parameter.plan_stream_path);
+}
+
+void PlanWriter::write(int i, const substrait::Plan &plan)
+{
+    if (!stream)
+    {
+        writeFile(i, plan);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(stream_mutex);
+    if (i != next)
+    {
+        // the plan is gone once the worker returns, so it waits
+        // serialized. The serialization runs out of the lock
+        lock.unlock();
+        string bytes;
+        if (!plan.SerializeToString(&bytes))
+            throw Exception("PlanWriter: cannot serialize plan " +
+                            std::to_string(i));
+        lock.lock();
+        if (i != next)
+        {
+            pending.emplace(i, std::move(bytes));
+            return;
+        }
+        stream->writeSerialized(bytes);
+    }
+    else
+        stream->write(plan);
+
+    for (next++; !pending.empty() && pending.begin()->first == next;
+         next++)
+    {
+        stream->writeSerialized(pending.begin()->second);
+        pending.erase(pending.begin());
+    }
+}
+
+void PlanWriter::close()
+{
+    if (!stream)
+        return;
+    if (!pending.empty())
+        throw Exception("PlanWriter: the plan of query " +
+                        std::to_string(next) + " is not written");
+    stream->close();
+}
+
+void PlanWriter::writeFile(int i, const substrait::Plan &plan) const
+{
+    string path = plan_dir + "/q" + std::to_string(i);
+    if (format == InputParameter::PlanFormat::Binary)
+        writeMessage(plan, path);
+    else if (format == InputParameter::PlanFormat::Text)
+        writeTextMessage(plan, path);
+    else
+        writeJsonMessage(plan, path);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "configuration.h"
+#include "protobuf_io.h"
+#include "substrait/plan.pb.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+using namespace std;
+
+/**
+ * @brief Write the plans of the queries, either each to plan_dir/q<i>
+ * in the plan format, or all to one stream of length-delimited binary
+ * messages that DelimitedReader iterates. The stream holds the plans in
+ * the order of the queries: a plan that is finished before the plan of
+ * an earlier query is kept serialized until the earlier plans are
+ * written.
+ */
+class PlanWriter
+{
+  public:
+    explicit PlanWriter(const InputParameter &parameter);
+
+    PlanWriter(const PlanWriter &) = delete;
+    PlanWriter &operator=(const PlanWriter &) = delete;
+
+    /**
+     * @brief Write the plan of a query. Called concurrently by the
+     * workers of planQueries
+     *
+     * @param i the position of the query
+     * @param plan
+     */
+    void write(int i, const substrait::Plan &plan);
+
+    // flush the stream and close its file. Every plan must be written
+    void close();
+
+  private:
+    string plan_dir;
+    InputParameter::PlanFormat format;
+
+    std::mutex stream_mutex;
+    unique_ptr<DelimitedWriter> stream;
+    // the position of the next plan in the stream
+    int next = 0;
+    // the serialized plans that wait for the plan of an earlier query
+    map<int, string> pending;
+
+    void writeFile(int i, const substrait::Plan &plan) const;
+};
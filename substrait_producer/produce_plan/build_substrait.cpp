@@ -5,59 +5,87 @@
 #include <memory.h>
 #include <unordered_map>
 
-shared_ptr<unordered_map<string, int>> functions;
-
 const unordered_map<string, string> function_overflow_option = {
     {"add", "SILENT"},
     {"subtract", "SILENT"},
     {"multiply", "SILENT"},
     {"divide", "SILENT"}};
 
-void registFunctions(st::Plan *plan)
+namespace
 {
-    functions = make_shared<unordered_map<string, int>>();
+// the extension declarations of every plan and the anchors of the
+// declared functions
+struct FunctionRegistry
+{
+    st::Plan skeleton;
+    unordered_map<string, int> anchors;
+};
 
+FunctionRegistry makeFunctionRegistry()
+{
+    FunctionRegistry registry;
+    st::Plan &skeleton = registry.skeleton;
     unordered_map<string, vector<string>> uri_funcs = {
         {kUDFURI,
          {"reconstruct", "bitmap_or", "bitmap_get", "bitmap_or_scalar",
-          "bitmap_and_scalar",
-          "bitmap_count"}}, // TODO: bitmap_or_scalar,
+          "bitmap_and_scalar", "bitmap_count",
+          "tid_position"}}, // TODO: bitmap_or_scalar,
                             // bitmap_and_scalar, bitmap_count (count
                             // the number of set bits)
         {kComparisonURI,
          {"equal", "gte", "lte", "lt", "is_not_null",
           "is_null"}}, // is_not_null is not valid in Velox
         {kArithmeticURI, {"sum", "add"}},
-        {kBooleanURI, {"or", "and", "not"}}};
+        {kBooleanURI, {"or", "and", "not"}},
+        {kStringURI, {"starts_with"}}};
 
     int uri_anchor = 10;
     int func_anchor = 100;
     for (auto it = uri_funcs.begin(); it != uri_funcs.end(); it++)
     {
-        auto uri = plan->add_extension_uris();
+        auto uri = skeleton.add_extension_uris();
         uri->set_extension_uri_anchor(uri_anchor);
         uri->set_uri(it->first);
 
         for (auto &n : it->second)
         {
             auto func =
-                plan->add_extensions()->mutable_extension_function();
+                skeleton.add_extensions()->mutable_extension_function();
             func->set_extension_uri_reference(uri_anchor);
             func->set_function_anchor(func_anchor);
             func->set_name(n);
-            functions->emplace(n, func_anchor);
+            registry.anchors.emplace(n, func_anchor);
             func_anchor++;
         }
         uri_anchor++;
     }
+    return registry;
+}
+
+// built on the first use. The registry is read-only once built, and
+// the initialization of the static is thread-safe, so the plans of
+// concurrent queries share it
+const FunctionRegistry &functionRegistry()
+{
+    static const FunctionRegistry registry = makeFunctionRegistry();
+    return registry;
+}
+}; // namespace
+
+void registFunctions(st::Plan *plan)
+{
+    // the anchors do not depend on the query, so the declarations are
+    // copied from the skeleton instead of rebuilt for every plan
+    const st::Plan &skeleton = functionRegistry().skeleton;
+    *plan->mutable_extension_uris() = skeleton.extension_uris();
+    *plan->mutable_extensions() = skeleton.extensions();
 }
 
 int getFunctionAnchor(const string &name)
 {
-    if (!functions)
-        throw Exception("Must regist functions");
-    auto it = functions->find(name);
-    if (it == functions->end())
+    const auto &anchors = functionRegistry().anchors;
+    auto it = anchors.find(name);
+    if (it == anchors.end())
         throw Exception("Cannot find function " + name);
     return it->second;
 }
@@ -119,6 +147,20 @@ shared_ptr<FunctionExpression> checkValid(
     }
 }
 
+st::Rel *newRel(const google::protobuf::Message &owner)
+{
+    return google::protobuf::Arena::CreateMessage<st::Rel>(
+        owner.GetArena());
+}
+
+st::Rel *detachRel(st::Rel *rel)
+{
+    auto detached = newRel(*rel);
+    // both are on the same arena, so the swap exchanges pointers
+    detached->Swap(rel);
+    return detached;
+}
+
 /**
  * @brief Read a parquet file
  *
@@ -138,6 +180,27 @@ shared_ptr<Schema> read(st::Rel *rel, const std::string &path,
         return readVelox(rel, path, block_id, base_schema);
 }
 
+shared_ptr<Schema> readNothing(
+    st::Rel *rel,
+    const vector<shared_ptr<const AggregateExpression>> &measures)
+{
+    auto read_rel = rel->mutable_read();
+    auto schema = read_rel->mutable_base_schema();
+    auto types = schema->mutable_struct_();
+    shared_ptr<Schema> out_schema = make_shared<Schema>();
+    for (auto m : measures)
+    {
+        schema->add_names(m->getName());
+        makeSubstraitType(types->add_types(), m->getType(), true,
+                          false);
+        out_schema->add(make_shared<Attribute>(m->getName(),
+                                               m->getType()));
+    }
+    // a virtual table without any row
+    read_rel->mutable_virtual_table();
+    return out_schema;
+}
+
 shared_ptr<Schema> filter(st::Rel *rel,
                           shared_ptr<const Expression> expression,
                           shared_ptr<const Schema> inSchema)
@@ -195,6 +258,21 @@ shared_ptr<Schema> exchange(
         return exchangeVelox(rel, in_schema, scatter_attributes);
 }
 
+shared_ptr<Schema> orderBy(
+    st::Rel *rel, shared_ptr<const Schema> in_schema,
+    const vector<shared_ptr<const Attribute>> &keys)
+{
+    auto sort_rel = rel->mutable_sort();
+    for (auto key : keys)
+    {
+        auto field = sort_rel->add_sorts();
+        key->makeSubstraitExpression(field->mutable_expr(), in_schema);
+        field->set_direction(
+            st::SortField::SORT_DIRECTION_ASC_NULLS_LAST);
+    }
+    return make_shared<Schema>(*in_schema);
+}
+
 shared_ptr<Schema> equalJoin(
     st::Rel *rel, shared_ptr<const Schema> left_schema,
     shared_ptr<const Schema> right_schema, const string &left_key,
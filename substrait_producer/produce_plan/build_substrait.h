@@ -29,9 +29,44 @@ void makeBinaryScalarFunction(
 shared_ptr<FunctionExpression> checkValid(
     const string &name, shared_ptr<const Attribute> attribute);
 
+/**
+ * @brief Create a Rel on the arena of a message of the plan, to be
+ * built apart and moved into the plan by set_allocated_* or
+ * AddAllocated. The move exchanges pointers instead of copying the
+ * subtree. The Rel is owned by the arena, or by the caller until it is
+ * moved if the plan is on the heap.
+ *
+ * @param owner a message of the plan the Rel is moved into
+ * @return st::Rel*
+ */
+st::Rel *newRel(const google::protobuf::Message &owner);
+
+/**
+ * @brief Move the content of a built Rel into a new Rel on its arena,
+ * so that an operator is put on top of the Rel by moving the new Rel
+ * into an input of the emptied one.
+ *
+ * @param rel
+ * @return st::Rel* the new Rel, owned as by newRel
+ */
+st::Rel *detachRel(st::Rel *rel);
+
 shared_ptr<Schema> read(st::Rel *rel, const std::string &path,
                         const std::vector<int> &block_id,
                         shared_ptr<const Schema> project_schema);
+
+/**
+ * @brief Read an empty virtual table in place of the blocks, so that a
+ * query selecting no block still aggregates its measures over no tuple
+ *
+ * @param rel
+ * @param measures the columns of the table are the measures
+ * @return shared_ptr<Schema>
+ */
+shared_ptr<Schema> readNothing(
+    st::Rel *rel,
+    const vector<shared_ptr<const AggregateExpression>> &measures);
+
 shared_ptr<Schema> filter(st::Rel *rel,
                           shared_ptr<const Expression> expression,
                           shared_ptr<const Schema> in_schema);
@@ -53,6 +88,19 @@ shared_ptr<Schema> exchange(
     st::Rel *rel, shared_ptr<const Schema> in_schema,
     const vector<shared_ptr<const Attribute>> &scatter_attributes);
 
+/**
+ * @brief Order a table by the keys in ascending order. The input of the
+ * Sort rel is set by the caller
+ *
+ * @param rel the Sort rel
+ * @param in_schema
+ * @param keys
+ * @return shared_ptr<Schema> the schema of the input
+ */
+shared_ptr<Schema> orderBy(
+    st::Rel *rel, shared_ptr<const Schema> in_schema,
+    const vector<shared_ptr<const Attribute>> &keys);
+
 /**
  * @brief Build an equal join between the left and right table
  *
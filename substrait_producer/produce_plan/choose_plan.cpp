@@ -0,0 +1,236 @@
+#include "baselines/make_plan_base.h"
+#include "baselines/produce_scan_parameter.h"
+#include "partitioner/common.h"
+#include "partitioner/model.h"
+#include "produce_plan/helper.h"
+#include "produce_plan/join_sequence.h"
+#include "produce_plan/make_plan.h"
+#include "produce_plan/produce_scan_parameter.h"
+#include <cmath>
+#include <stdio.h>
+
+namespace
+{
+enum Strategy
+{
+    Aggregate,
+    Early,
+    Join,
+    Merge,
+    NumOfStrategies
+};
+
+const char *strategy_names[NumOfStrategies] = {"aggregate", "early",
+                                               "join", "merge"};
+
+// the cost model needs the row number of every block
+bool hasRowNums(
+    const vector<shared_ptr<const PartitionMeta>> &partitions)
+{
+    for (auto &p : partitions)
+        for (auto &b : p->getBlocks())
+            if (!b->hasRowNum())
+                return false;
+    return true;
+}
+
+// the joins of a sequence of mini tables: each mini table probes the
+// outer join of the mini tables after it. Return the tuples out of the
+// sequence
+int64_t addJoinSequence(
+    const vector<shared_ptr<const ScanParameter>> &params,
+    shared_ptr<const Schema> table_schema, uint64_t &build_tuples,
+    uint64_t &probe_tuples)
+{
+    auto tuples = joinSequenceTuples(params, table_schema);
+    int64_t joined = 0;
+    for (int i = (int)tuples.size() - 1; i >= 0; i--)
+    {
+        if (i + 1 < (int)tuples.size())
+        {
+            build_tuples += joined;
+            probe_tuples += tuples[i];
+        }
+        joined += tuples[i];
+    }
+    return joined;
+}
+
+// the cost of the plan of evalauteJoinPlan: the I/O of all scans, the
+// join sequences of the measure groups, and the left join of their
+// union with the join sequence of the filter blocks
+double estimateJoinCost(
+    const vector<shared_ptr<const ScanParameter>> &direct_params,
+    const vector<shared_ptr<const ScanParameter>> &recons_filter_params,
+    const vector<vector<shared_ptr<const ScanParameter>>>
+        &recons_measure_params,
+    shared_ptr<const Schema> table_schema)
+{
+    uint64_t io_size = 0, build_tuples = 0, probe_tuples = 0,
+             valid_cells = 0;
+
+    // a block read by several scans is costed once per attribute
+    unordered_map<shared_ptr<const BlockMeta>, AttributeSet> read;
+    auto add_scan = [&](shared_ptr<const ScanParameter> p,
+                        bool reconstruct) {
+        for (auto b : p->blocks)
+        {
+            auto it = read.find(b);
+            if (it == read.end())
+                it = read.emplace(b, AttributeSet(table_schema->size()))
+                         .first;
+            io_size += b->estimateIOSize(p->read_attributes -
+                                         it->second);
+            it->second |= p->read_attributes;
+            if (reconstruct)
+                valid_cells += (p->project_attributes.count() - 1) *
+                               b->estimateRowNum(*p->filter_boundary);
+        }
+    };
+    for (auto p : direct_params)
+        add_scan(p, false);
+    for (auto p : recons_filter_params)
+        add_scan(p, true);
+    for (const auto &group : recons_measure_params)
+        for (auto p : group)
+            add_scan(p, true);
+
+    int64_t union_tuples = 0;
+    for (const auto &group : recons_measure_params)
+        union_tuples += addJoinSequence(group, table_schema,
+                                        build_tuples, probe_tuples);
+    if (union_tuples > 0 && !recons_filter_params.empty())
+    {
+        // the filter table is the build side
+        int64_t filter_tuples = addJoinSequence(
+            recons_filter_params, table_schema, build_tuples,
+            probe_tuples);
+        build_tuples += filter_tuples;
+        probe_tuples += union_tuples;
+    }
+
+    return predictIOTime(io_size) +
+           predictJoinTime(build_tuples, probe_tuples, valid_cells);
+}
+
+// the comparisons of the sort on the tuple id in the merge
+// reconstruction of the aggregation parameters: N log2 N for the N
+// reconstructed tuples, none if they are read from one block stored in
+// the order of the tuple id and no exchange scatters them
+uint64_t sortComparisons(
+    const vector<shared_ptr<const ScanParameter>> &recons_params)
+{
+    bool partition = InputParameter::get()->parallel ==
+                     InputParameter::AggParallelMethod::Partition;
+    if (recons_params.empty() ||
+        (recons_params.size() == 1 && !partition &&
+         isSortedByTid(*recons_params[0])))
+        return 0;
+    uint64_t tuples = 0;
+    for (auto p : recons_params)
+        for (auto b : p->blocks)
+            tuples += b->estimateRowNum(*p->filter_boundary);
+    return tuples < 2 ? 0 : tuples * std::log2((double)tuples);
+}
+}; // namespace
+
+void makeCheapestPlan(
+    substrait::Rel *rel, shared_ptr<const Schema> table_schema,
+    shared_ptr<const Query> query,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    int query_index, std::pmr::memory_resource *resource)
+{
+    // without the row numbers nothing can be costed, so only the
+    // parameters of the aggregation are produced
+    if (!hasRowNums(partitions))
+    {
+        fprintf(stderr,
+                "q%d: the row numbers of the blocks are unknown, "
+                "chosen: %s\n",
+                query_index, strategy_names[Aggregate]);
+        auto scan_parameters = produceScanParametersAggregation(
+            query, table_schema, partitions, resource);
+        evaluateAggregatePlan(rel, table_schema, query,
+                              scan_parameters.second,
+                              scan_parameters.first);
+        return;
+    }
+
+    // the candidate scan parameters of each strategy
+    auto aggregate_params = produceScanParametersAggregation(
+        query, table_schema, partitions, resource);
+    auto early_params = produceScanParameters(query, table_schema,
+                                              partitions, resource);
+    vector<shared_ptr<const ScanParameter>> join_direct_params,
+        join_filter_params;
+    vector<vector<shared_ptr<const ScanParameter>>> join_measure_params;
+    // the join reconstruction leaves a conjunct on several attributes
+    // to the residual filter of the aggregation
+    bool joinable = !query->getTemplate()->hasResidualFilters();
+    if (joinable)
+        produceScanParameterJoin(query, table_schema, partitions,
+                                 join_direct_params, join_filter_params,
+                                 join_measure_params, resource);
+
+    // a strategy that cannot be costed is never cheaper
+    double times[NumOfStrategies] = {INFINITY, INFINITY, INFINITY,
+                                     INFINITY};
+    times[Aggregate] = estimateCost(aggregate_params.second,
+                                    aggregate_params.first,
+                                    table_schema, predictAggTimeLate);
+    // the merge reconstruction is the aggregation with a sort below it
+    times[Merge] =
+        times[Aggregate] +
+        predictSortTime(sortComparisons(aggregate_params.second));
+    // the baselines either reconstruct every block or none
+    if (early_params.first.empty() != early_params.second.empty())
+        times[Early] =
+            estimateCost(early_params.second, early_params.first,
+                         table_schema, predictAggTimeEarly);
+    if (joinable)
+        times[Join] =
+            estimateJoinCost(join_direct_params, join_filter_params,
+                             join_measure_params, table_schema);
+    // a tie keeps the earlier strategy, so the merge is never chosen
+    // over the aggregation it only adds a sort to
+    int chosen = Aggregate;
+    for (int i = 0; i < NumOfStrategies; i++)
+        if (times[i] < times[chosen])
+            chosen = i;
+
+    // one write, so that the reports of the queries planned at the
+    // same time do not interleave
+    char line[128];
+    snprintf(line, sizeof(line),
+             "*************Reconstruction cost of q%d*************\n",
+             query_index);
+    string report = line;
+    for (int i = 0; i < NumOfStrategies; i++)
+    {
+        snprintf(line, sizeof(line), "%s: %.2f seconds\n",
+                 strategy_names[i], times[i]);
+        report += line;
+    }
+    report += string("chosen: ") + strategy_names[chosen] + "\n";
+    fputs(report.c_str(), stderr);
+
+    switch (chosen)
+    {
+    // the merge ties the aggregation only when it sorts nothing, and
+    // its plan is then the plan of the aggregation
+    case Aggregate:
+    case Merge:
+        evaluateAggregatePlan(rel, table_schema, query,
+                              aggregate_params.second,
+                              aggregate_params.first);
+        break;
+    case Early:
+        evaluate(rel, table_schema, query, early_params.second,
+                 early_params.first);
+        break;
+    case Join:
+        evalauteJoinPlan(rel, table_schema, query, join_direct_params,
+                         join_filter_params, join_measure_params);
+        break;
+    }
+}
@@ -1,5 +1,6 @@
 #include "produce_plan/helper.h"
 #include "produce_plan/build_substrait.h"
+#include <algorithm>
 
 shared_ptr<FunctionExpression> makeBitmapGet(
     const string &bitmap_attribute_name,
@@ -19,41 +20,88 @@ shared_ptr<FunctionExpression> makeBitmapGet(
 vector<shared_ptr<const ScanParameter>> mergeBeforeRead(
     const vector<shared_ptr<const ScanParameter>> &parameters)
 {
-    if (InputParameter::get()->engine == InputParameter::Engine::Arrow)
+    // group the parameters by their hashes. The merged parameters
+    // keep the order of their first blocks
+    vector<shared_ptr<ScanParameter>> out;
+    unordered_multimap<size_t, shared_ptr<ScanParameter>> groups;
+    for (auto p : parameters)
     {
-        vector<shared_ptr<ScanParameter>> out;
-        for (auto p : parameters)
+        bool put = false;
+        size_t h = p->hash();
+        auto range = groups.equal_range(h);
+        for (auto it = range.first; it != range.second; it++)
         {
-            bool put = false;
-            for (auto o : out)
+            auto o = it->second;
+            if (p->equal(o))
             {
-                if (p->equal(o))
-                {
-                    put = true;
-                    o->block_id.insert(p->block_id.begin(),
-                                       p->block_id.end());
-                    o->blocks.insert(p->blocks.begin(),
-                                     p->blocks.end());
-                    break;
-                }
+                put = true;
+                o->block_id.insert(p->block_id.begin(),
+                                   p->block_id.end());
+                o->blocks.insert(p->blocks.begin(), p->blocks.end());
+                break;
             }
-            if (!put)
-                out.push_back(p->clone());
         }
+        if (!put)
+        {
+            out.push_back(p->clone());
+            groups.emplace(h, out.back());
+        }
+    }
 
-        vector<shared_ptr<const ScanParameter>> const_out;
+    vector<shared_ptr<const ScanParameter>> const_out;
+    if (InputParameter::get()->engine == InputParameter::Engine::Arrow)
+    {
         for (auto s : out)
             const_out.push_back(s);
         return const_out;
     }
-    else
+
+    // the Velox consumer only takes a conjunction on the block id, so a
+    // read is a range of consecutive blocks. A merged parameter is
+    // split at the gaps between its block ids
+    for (auto s : out)
     {
-        return parameters;
+        vector<int> ids(s->block_id.begin(), s->block_id.end());
+        std::sort(ids.begin(), ids.end());
+        size_t first = 0;
+        for (size_t i = 1; i <= ids.size(); i++)
+        {
+            if (i < ids.size() && ids[i] == ids[i - 1] + 1)
+                continue;
+            if (first == 0 && i == ids.size())
+            {
+                const_out.push_back(s);
+                break;
+            }
+            auto run = s->clone();
+            run->block_id = unordered_set<int>(ids.begin() + first,
+                                               ids.begin() + i);
+            run->blocks.clear();
+            for (auto &block : s->blocks)
+                if (run->block_id.count(block->getBlockID()))
+                    run->blocks.insert(block);
+            const_out.push_back(run);
+            first = i;
+        }
     }
+    return const_out;
+}
+
+shared_ptr<Schema> orderByTid(substrait::Rel *rel,
+                              shared_ptr<const Schema> schema)
+{
+    auto input_rel = detachRel(rel);
+    rel->mutable_sort()->set_allocated_input(input_rel);
+    return orderBy(rel, schema, {schema->get(tuple_id_name)});
+}
+
+bool isSortedByTid(const ScanParameter &p)
+{
+    return p.blocks.size() == 1 && (*p.blocks.begin())->isSortedByTid();
 }
 
 shared_ptr<Schema> readBlocks(substrait::Rel *read_rel,
-                              const boost::dynamic_bitset<> &attributes,
+                              const AttributeSet &attributes,
                               const unordered_set<int> &block_id,
                               shared_ptr<const Schema> table_schema,
                               const string &path)
@@ -62,8 +110,8 @@ shared_ptr<Schema> readBlocks(substrait::Rel *read_rel,
     shared_ptr<Attribute> block_id_attr =
         make_shared<Attribute>(block_id_name, DATA_TYPE::INTEGER);
     read_schema->add(block_id_attr);
-    for (auto i = attributes.find_first(); i != attributes.npos;
-         i = attributes.find_next(i))
+    for (int i = attributes.findFirst(); i != AttributeSet::npos;
+         i = attributes.findNext(i))
         read_schema->add(table_schema->get(i));
     auto schema_after_read = read(
         read_rel, path, vector<int>(block_id.begin(), block_id.end()),
@@ -74,7 +122,7 @@ shared_ptr<Schema> readBlocks(substrait::Rel *read_rel,
 shared_ptr<Schema> readForReconstruction(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &reconstruct_attributes)
+    const AttributeSet &reconstruct_attributes)
 {
     substrait::Rel *project_rel, *filter_rel, *read_rel;
     project_rel = rel;
@@ -120,9 +168,9 @@ shared_ptr<Schema> readForReconstruction(
     //     possible_measures_name, possible_measures));
     project_expression.push_back(
         make_shared<Literal>(valid_attribute_name, valid_attributes));
-    for (auto i = reconstruct_attributes.find_first();
-         i != reconstruct_attributes.npos;
-         i = reconstruct_attributes.find_next(i))
+    for (int i = reconstruct_attributes.findFirst();
+         i != AttributeSet::npos;
+         i = reconstruct_attributes.findNext(i))
     {
         if (parameter->project_attributes.test(i))
             // the attribute has been read
@@ -141,7 +189,7 @@ shared_ptr<Schema> readForReconstruction(
 shared_ptr<Schema> readForDirectEval(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &measure_attribtues)
+    const AttributeSet &measure_attribtues)
 {
     substrait::Rel *project_rel, *filter_rel, *read_rel;
     project_rel = rel;
@@ -171,9 +219,8 @@ shared_ptr<Schema> readForDirectEval(
         make_shared<FixedBinary>(parameter->direct_meassures);
     project_expression.push_back(
         make_shared<Literal>(direct_measures_name, direct_measures));
-    for (auto i = measure_attribtues.find_first();
-         i != measure_attribtues.npos;
-         i = measure_attribtues.find_next(i))
+    for (int i = measure_attribtues.findFirst();
+         i != AttributeSet::npos; i = measure_attribtues.findNext(i))
     {
         auto attr = table_schema->get(i);
         if (parameter->project_attributes.test(i))
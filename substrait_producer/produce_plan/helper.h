@@ -3,7 +3,6 @@
 #include "metadata/schema.h"
 #include "produce_plan/scan_parameter.h"
 #include "substrait/algebra.pb.h"
-#include <boost/dynamic_bitset.hpp>
 
 shared_ptr<FunctionExpression> makeBitmapGet(
     const string &bitmap_attribute_name,
@@ -12,8 +11,28 @@ shared_ptr<FunctionExpression> makeBitmapGet(
 vector<shared_ptr<const ScanParameter>> mergeBeforeRead(
     const vector<shared_ptr<const ScanParameter>> &parameters);
 
+/**
+ * @brief Order the tuples of a built Rel by the tuple id. The Rel is
+ * moved under a Sort rel in place
+ *
+ * @param rel
+ * @param schema the schema of the Rel
+ * @return shared_ptr<Schema> the schema of the ordered Rel
+ */
+shared_ptr<Schema> orderByTid(substrait::Rel *rel,
+                              shared_ptr<const Schema> schema);
+
+/**
+ * @brief Check if a parameter reads its tuples in the order of the
+ * tuple id: it reads one block stored in that order
+ *
+ * @param p
+ * @return true if the tuples are read in the order of the tuple id
+ */
+bool isSortedByTid(const ScanParameter &p);
+
 shared_ptr<Schema> readBlocks(substrait::Rel *read_rel,
-                              const boost::dynamic_bitset<> &attributes,
+                              const AttributeSet &attributes,
                               const unordered_set<int> &block_id,
                               shared_ptr<const Schema> table_schema,
                               const string &path);
@@ -33,7 +52,7 @@ shared_ptr<Schema> readBlocks(substrait::Rel *read_rel,
 shared_ptr<Schema> readForReconstruction(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &reconstruct_attributes);
+    const AttributeSet &reconstruct_attributes);
 
 /**
  * @brief read and project data blocks in one partition before direct
@@ -49,7 +68,7 @@ shared_ptr<Schema> readForReconstruction(
 shared_ptr<Schema> readForDirectEval(
     substrait::Rel *rel, shared_ptr<const ScanParameter> parameter,
     shared_ptr<const Schema> table_schema,
-    const boost::dynamic_bitset<> &measure_attribtues);
+    const AttributeSet &measure_attribtues);
 
 /**
  * @brief Process a set of direct evaluation parameters
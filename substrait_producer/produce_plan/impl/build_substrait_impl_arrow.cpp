@@ -1,9 +1,94 @@
 #include "produce_plan/impl/build_substrait_impl_arrow.h"
 #include "configuration.h"
 #include "produce_plan/build_substrait.h"
+#include <algorithm>
 #include <memory.h>
 #include <unordered_map>
 
+namespace
+{
+// the most block id ranges a read filter checks
+constexpr size_t kMaxReadRanges = 10;
+
+// the first and the last id of consecutive blocks
+typedef pair<int, int> BlockRange;
+
+// the runs of consecutive ids among the blocks, in order
+vector<BlockRange> blockRanges(vector<int> block_id)
+{
+    std::sort(block_id.begin(), block_id.end());
+    vector<BlockRange> ranges;
+    for (int b : block_id)
+        if (!ranges.empty() && b <= ranges.back().second + 1)
+            ranges.back().second = std::max(ranges.back().second, b);
+        else
+            ranges.emplace_back(b, b);
+    return ranges;
+}
+
+/**
+ * @brief Merge the ranges separated by the smallest gaps until at most
+ * max_ranges remain. The merged ranges cover the blocks in the gaps, so
+ * the ranges select as few unselected blocks as possible.
+ */
+vector<BlockRange> mergeBlockRanges(const vector<BlockRange> &ranges,
+                                    size_t max_ranges)
+{
+    if (ranges.size() <= max_ranges)
+        return ranges;
+    // gap i is between range i and range i + 1
+    vector<size_t> gaps(ranges.size() - 1);
+    for (size_t i = 0; i < gaps.size(); i++)
+        gaps[i] = i;
+    std::stable_sort(gaps.begin(), gaps.end(),
+                     [&](size_t x, size_t y)
+                     {
+                         return ranges[x + 1].first - ranges[x].second <
+                                ranges[y + 1].first - ranges[y].second;
+                     });
+    vector<bool> closed(gaps.size(), false);
+    for (size_t i = 0; i < ranges.size() - max_ranges; i++)
+        closed[gaps[i]] = true;
+
+    vector<BlockRange> merged{ranges[0]};
+    for (size_t i = 1; i < ranges.size(); i++)
+        if (closed[i - 1])
+            merged.back().second = ranges[i].second;
+        else
+            merged.push_back(ranges[i]);
+    return merged;
+}
+
+// a disjunction of the ranges, a range of one block checked by equal
+shared_ptr<FunctionExpression> checkBlockRanges(
+    const vector<BlockRange> &ranges,
+    shared_ptr<const Attribute> block_id_att)
+{
+    auto compare = [&](const string &op, int b)
+    {
+        shared_ptr<Literal> l = make_shared<Literal>(
+            "bid_value", make_shared<Integer>(b, 32));
+        return make_shared<FunctionExpression>(
+            "bid_check_" + op, op,
+            vector<shared_ptr<const Expression>>{block_id_att, l},
+            DATA_TYPE::BOOLEAN, false);
+    };
+    vector<shared_ptr<const Expression>> subExps;
+    for (auto &range : ranges)
+        if (range.first == range.second)
+            subExps.push_back(compare("equal", range.first));
+        else
+            subExps.push_back(make_shared<FunctionExpression>(
+                "bid_check_range", "and",
+                vector<shared_ptr<const Expression>>{
+                    compare("gte", range.first),
+                    compare("lte", range.second)},
+                DATA_TYPE::BOOLEAN, false));
+    return FunctionExpression::connectExpression(
+        "check_block_exp", subExps, false, false);
+}
+} // namespace
+
 /**
  * @brief Read a parquet file
  *
@@ -41,66 +126,20 @@ shared_ptr<Schema> readArrow(st::Rel *rel, const std::string &path,
     *file->mutable_uri_path() = path;
     file->mutable_parquet();
 
-    shared_ptr<FunctionExpression> check_block_exp;
     auto block_id_att = base_schema->get(block_id_name);
-
-    auto make_precise_filter = [&]() -> shared_ptr<FunctionExpression> {
-        vector<shared_ptr<const Expression>> subExps;
-        for (auto b : block_id)
-        {
-            shared_ptr<Literal> l = make_shared<Literal>(
-                "bid_value", make_shared<Integer>(b, 32));
-            subExps.push_back(make_shared<FunctionExpression>(
-                "bid_check_one_element", "equal",
-                vector<shared_ptr<const Expression>>{block_id_att, l},
-                DATA_TYPE::BOOLEAN, false));
-        }
-        return FunctionExpression::connectExpression(
-            "check_block_exp", subExps, false, false);
-    };
-
-    if (block_id.size() < 10)
-    {
-        check_block_exp = make_precise_filter();
-    }
-    else
-    {
-        shared_ptr<Integer> min_block_id = make_shared<Integer>(
-            *min_element(block_id.begin(), block_id.end()), 32);
-        shared_ptr<Integer> max_block_id = make_shared<Integer>(
-            *max_element(block_id.begin(), block_id.end()), 32);
-        shared_ptr<Literal> min_l =
-            make_shared<Literal>("min_block_id", min_block_id);
-        shared_ptr<Literal> max_l =
-            make_shared<Literal>("max_block_id", max_block_id);
-        shared_ptr<Attribute> block_id_attr =
-            base_schema->get(block_id_name);
-
-        shared_ptr<FunctionExpression> min_f =
-            make_shared<FunctionExpression>(
-                "f1", "gte",
-                vector<shared_ptr<const Expression>>{block_id_attr,
-                                                     min_l},
-                DATA_TYPE::BOOLEAN, false);
-        shared_ptr<FunctionExpression> max_f =
-            make_shared<FunctionExpression>(
-                "f2", "lte",
-                vector<shared_ptr<const Expression>>{block_id_attr,
-                                                     max_l},
-                DATA_TYPE::BOOLEAN, false);
-        check_block_exp = make_shared<FunctionExpression>(
-            "check_block_exp", "and",
-            vector<shared_ptr<const Expression>>{min_f, max_f},
-            DATA_TYPE::BOOLEAN, false);
-    }
-    // check block id in read to skip data pages in file
-    check_block_exp->makeSubstraitExpression(read_rel->mutable_filter(),
-                                             base_schema);
+    auto ranges = blockRanges(block_id);
+    // check block id in read to skip data pages in file. The read
+    // filter is tested on the min/max of every page, so it checks a
+    // few ranges that may cover blocks between the selected ones
+    checkBlockRanges(mergeBlockRanges(ranges, kMaxReadRanges),
+                     block_id_att)
+        ->makeSubstraitExpression(read_rel->mutable_filter(),
+                                  base_schema);
 
     // check the block id after read
-    check_block_exp = make_precise_filter();
-    check_block_exp->makeSubstraitExpression(
-        filter_rel->mutable_condition(), base_schema);
+    checkBlockRanges(ranges, block_id_att)
+        ->makeSubstraitExpression(filter_rel->mutable_condition(),
+                                  base_schema);
     return make_shared<Schema>(*base_schema);
 }
 
@@ -1,6 +1,7 @@
 #include "produce_plan/impl/build_substrait_impl_velox.h"
 #include "configuration.h"
 #include "produce_plan/build_substrait.h"
+#include <algorithm>
 #include <memory.h>
 #include <unordered_map>
 
@@ -8,9 +9,14 @@ shared_ptr<Schema> readVelox(st::Rel *rel, const std::string &path,
                              const std::vector<int> &block_id,
                              shared_ptr<const Schema> base_schema)
 {
-    if (block_id.size() != 1)
-        throw Exception(
-            "read: Velox consumer only reads one block each time");
+    if (block_id.size() == 0)
+        throw Exception("read: read at least one block from " + path);
+    // the consumer takes a conjunction on the block id, i.e. a range
+    int min_block_id = *min_element(block_id.begin(), block_id.end());
+    int max_block_id = *max_element(block_id.begin(), block_id.end());
+    if (max_block_id - min_block_id + 1 != (int)block_id.size())
+        throw Exception("read: Velox consumer only reads consecutive "
+                        "blocks each time");
     auto filter_rel = rel->mutable_filter();
 
     // read the blocks
@@ -34,14 +40,27 @@ shared_ptr<Schema> readVelox(st::Rel *rel, const std::string &path,
     file->mutable_parquet();
 
     auto block_id_att = base_schema->get(block_id_name);
-    shared_ptr<const Expression> bid_value = make_shared<const Literal>(
-        "bid_value", make_shared<Integer>(block_id[0], 32));
-    shared_ptr<FunctionExpression> check_block_exp =
-        make_shared<FunctionExpression>(
-            "bid_check_one_element", "equal",
+    auto compare = [&](const string &op, int b)
+    {
+        shared_ptr<const Expression> bid_value =
+            make_shared<const Literal>("bid_value",
+                                       make_shared<Integer>(b, 32));
+        return make_shared<FunctionExpression>(
+            "bid_check_" + op, op,
             vector<shared_ptr<const Expression>>{block_id_att,
                                                  bid_value},
             DATA_TYPE::BOOLEAN, false);
+    };
+    shared_ptr<FunctionExpression> check_block_exp;
+    if (min_block_id == max_block_id)
+        check_block_exp = compare("equal", min_block_id);
+    else
+        check_block_exp = make_shared<FunctionExpression>(
+            "bid_check_range", "and",
+            vector<shared_ptr<const Expression>>{
+                compare("gte", min_block_id),
+                compare("lte", max_block_id)},
+            DATA_TYPE::BOOLEAN, false);
     check_block_exp->makeSubstraitExpression(read_rel->mutable_filter(),
                                              base_schema);
 
@@ -9,30 +9,13 @@ shared_ptr<Schema> readMiniTable(
     shared_ptr<const Schema> table_schema)
 {
     assert(blocks.size() > 0);
-    boost::dynamic_bitset<> project_attributes(table_schema->size());
+    AttributeSet project_attributes(table_schema->size());
     for (auto b : blocks)
         project_attributes |= b->project_attributes;
-    vector<substrait::Rel *> read_rel;
-    shared_ptr<Schema> schema_after_read;
-    for (auto b : blocks)
-    {
-        auto rel = new substrait::Rel();
-        shared_ptr<Schema> s = readForReconstruction(
-            rel, b, table_schema, project_attributes);
-        read_rel.push_back(rel);
-        if (!schema_after_read)
-            schema_after_read = s;
-        else if (!schema_after_read->equal(s))
-            throw Exception(
-                "readMiniTable:inputs of union must have same schema");
-    }
 
     if (blocks.size() == 1)
-    {
-        *rel = *read_rel[0];
-        delete read_rel[0];
-        return schema_after_read;
-    }
+        return readForReconstruction(rel, *blocks.begin(), table_schema,
+                                     project_attributes);
 
     ::substrait::Rel *union_rel, *exchange_rel;
     if (InputParameter::get()->engine == InputParameter::Engine::Arrow)
@@ -46,12 +29,20 @@ shared_ptr<Schema> readMiniTable(
         union_rel = exchange_rel->mutable_exchange()->mutable_input();
     }
 
-    auto schema_after_union = unionAll(union_rel, schema_after_read);
-    for (auto r : read_rel)
+    // read the blocks directly into the inputs of the union
+    shared_ptr<Schema> schema_after_read;
+    for (auto b : blocks)
     {
-        *union_rel->mutable_set()->add_inputs() = *r;
-        delete r;
+        shared_ptr<Schema> s = readForReconstruction(
+            union_rel->mutable_set()->add_inputs(), b, table_schema,
+            project_attributes);
+        if (!schema_after_read)
+            schema_after_read = s;
+        else if (!schema_after_read->equal(s))
+            throw Exception(
+                "readMiniTable:inputs of union must have same schema");
     }
+    auto schema_after_union = unionAll(union_rel, schema_after_read);
 
     if (exchange_rel)
         schema_after_union =
@@ -61,6 +52,7 @@ shared_ptr<Schema> readMiniTable(
     return schema_after_union;
 }
 
+// join two tables. left_rel and right_rel are moved into the join
 shared_ptr<Schema> makeJoinRel(::substrait::Rel *rel,
                                shared_ptr<const Schema> left_schema,
                                ::substrait::Rel *left_rel,
@@ -72,8 +64,8 @@ shared_ptr<Schema> makeJoinRel(::substrait::Rel *rel,
     project_rel = rel;
     join_rel = project_rel->mutable_project()->mutable_input();
 
-    *join_rel->mutable_join()->mutable_left() = *left_rel;
-    *join_rel->mutable_join()->mutable_right() = *right_rel;
+    join_rel->mutable_join()->set_allocated_left(left_rel);
+    join_rel->mutable_join()->set_allocated_right(right_rel);
 
     vector<int> left_map, right_map;
     auto join_out_schema = equalJoin(
@@ -174,8 +166,8 @@ int findLargestAttribute(
     {
         const auto &attr = it->first->read_attributes;
         int64_t t = it->second;
-        for (auto i = attr.find_first(); i != attr.npos;
-             i = attr.find_next(i))
+        for (int i = attr.findFirst(); i != AttributeSet::npos;
+             i = attr.findNext(i))
         {
             const string &name = table_schema->get(i)->getName();
             if (name != tuple_id_name && name != block_id_name)
@@ -211,30 +203,21 @@ shared_ptr<Expression> checkAttributes(
     const unordered_set<shared_ptr<const ScanParameter>> &future_blocks,
     shared_ptr<const Query> query,
     shared_ptr<const Schema> input_schema,
-    shared_ptr<const Schema> table_schema)
+    shared_ptr<const Schema> table_schema,
+    unordered_set<int> &checked_measures)
 {
-    static unordered_set<int> checked_measures;
 
-    unordered_set<string> future_attribtues;
+    AttributeSet future_attribtues;
     for (const auto b : future_blocks)
-        for (auto i = b->project_attributes.find_first();
-             i != b->project_attributes.npos;
-             i = b->project_attributes.find_next(i))
-            future_attribtues.insert(table_schema->get(i)->getName());
+        future_attribtues |= b->project_attributes;
 
     vector<shared_ptr<const Expression>> filter_exp;
     for (int i = 0; i < query->numOfMeasures(); i++)
     {
-        auto attr = query->attributesInMeasure(i);
-        boost::dynamic_bitset<> attr_bitmap(table_schema->size(),
-                                            false);
-        bool in_future = false;
-        for (string a : *attr)
-        {
-            attr_bitmap.set(table_schema->getOffset(a), true);
-            if (future_attribtues.count(a) != 0)
-                in_future = true;
-        }
+        const auto &attr = query->attributesInMeasure(i);
+        AttributeSet attr_bitmap = attr;
+        attr_bitmap.resize(table_schema->size());
+        bool in_future = attr.intersects(future_attribtues);
         if (in_future || checked_measures.count(i))
             break;
 
@@ -272,7 +255,7 @@ shared_ptr<Expression> checkAttributes(
             vector<shared_ptr<const Expression>>{
                 bitmap_count_exp,
                 make_shared<Literal>(
-                    "all", make_shared<Integer>(attr->size(), 32))},
+                    "all", make_shared<Integer>(attr.count(), 32))},
             DATA_TYPE::BOOLEAN, false);
         filter_exp.push_back(FunctionExpression::connectExpression(
             "check_measure_" + to_string(i),
@@ -291,7 +274,8 @@ shared_ptr<Schema> makeJoinSequenceRecursive(
     list<pair<shared_ptr<const ScanParameter>, int64_t>> active,
     unordered_set<shared_ptr<const ScanParameter>> finished,
     shared_ptr<const Schema> table_schema,
-    shared_ptr<const Query> query, bool filter_tuples)
+    shared_ptr<const Query> query, bool filter_tuples,
+    unordered_set<int> &checked_measures)
 {
     int attribute = findLargestAttribute(active, table_schema);
     auto blocks = extractBlocks(active, attribute);
@@ -299,52 +283,43 @@ shared_ptr<Schema> makeJoinSequenceRecursive(
     auto finished_next = finished;
     finished_next.insert(blocks.begin(), blocks.end());
 
-    ::substrait::Rel join_left_rel;
-    auto join_left_schema =
-        readMiniTable(&join_left_rel, blocks, table_schema);
-
-    ::substrait::Rel join_rel;
     shared_ptr<Schema> schema_after_join;
-
     if (active.size() == 0)
-    {
-        join_rel = join_left_rel;
-        schema_after_join = join_left_schema;
-    }
+        schema_after_join = readMiniTable(rel, blocks, table_schema);
     else
     {
-        ::substrait::Rel join_right_rel;
+        auto join_left_rel = newRel(*rel);
+        auto join_left_schema =
+            readMiniTable(join_left_rel, blocks, table_schema);
+        auto join_right_rel = newRel(*rel);
         auto join_right_schema = makeJoinSequenceRecursive(
-            &join_right_rel, active, finished_next, table_schema, query,
-            filter_tuples);
+            join_right_rel, active, finished_next, table_schema, query,
+            filter_tuples, checked_measures);
         schema_after_join = makeJoinRel(
-            &join_rel, join_left_schema, &join_left_rel,
-            join_right_schema, &join_right_rel, table_schema);
+            rel, join_left_schema, join_left_rel, join_right_schema,
+            join_right_rel, table_schema);
     }
 
     if (filter_tuples)
     {
-        shared_ptr<Expression> filter_exp = checkAttributes(
-            finished, query, schema_after_join, table_schema);
+        shared_ptr<Expression> filter_exp =
+            checkAttributes(finished, query, schema_after_join,
+                            table_schema, checked_measures);
         if (filter_exp)
         {
-            *rel->mutable_filter()->mutable_input() = join_rel;
+            auto join_rel = detachRel(rel);
+            rel->mutable_filter()->set_allocated_input(join_rel);
             return filter(rel, filter_exp, schema_after_join);
         }
     }
-    *rel = join_rel;
     return schema_after_join;
 }
 
-shared_ptr<Schema> makeJoinSequence(
-    ::substrait::Rel *rel,
-    const vector<shared_ptr<const ScanParameter>> &blocks,
-    shared_ptr<const Schema> table_schema,
-    shared_ptr<const Query> query, bool filter_tuples)
+// the blocks with the estimated number of their tuples
+list<pair<shared_ptr<const ScanParameter>, int64_t>> estimateTuples(
+    const vector<shared_ptr<const ScanParameter>> &blocks)
 {
     list<pair<shared_ptr<const ScanParameter>, int64_t>> active;
-    unordered_set<shared_ptr<const ScanParameter>> finished;
-
     for (auto b : blocks)
     {
         int64_t tnum = 0;
@@ -357,7 +332,39 @@ shared_ptr<Schema> makeJoinSequence(
         }
         active.push_back(make_pair(b, tnum));
     }
+    return active;
+}
 
-    return makeJoinSequenceRecursive(
-        rel, active, finished, table_schema, query, filter_tuples);
+shared_ptr<Schema> makeJoinSequence(
+    ::substrait::Rel *rel,
+    const vector<shared_ptr<const ScanParameter>> &blocks,
+    shared_ptr<const Schema> table_schema,
+    shared_ptr<const Query> query, bool filter_tuples,
+    unordered_set<int> &checked_measures)
+{
+    unordered_set<shared_ptr<const ScanParameter>> finished;
+    return makeJoinSequenceRecursive(rel, estimateTuples(blocks),
+                                     finished, table_schema, query,
+                                     filter_tuples, checked_measures);
+}
+
+vector<int64_t> joinSequenceTuples(
+    const vector<shared_ptr<const ScanParameter>> &blocks,
+    shared_ptr<const Schema> table_schema)
+{
+    auto active = estimateTuples(blocks);
+    vector<int64_t> tuples;
+    while (!active.empty())
+    {
+        // the mini tables are taken in the order of
+        // makeJoinSequenceRecursive
+        int attribute = findLargestAttribute(active, table_schema);
+        int64_t tnum = 0;
+        for (const auto &b : active)
+            if (b.first->read_attributes.test(attribute))
+                tnum += b.second;
+        extractBlocks(active, attribute);
+        tuples.push_back(tnum);
+    }
+    return tuples;
 }
\ No newline at end of file
@@ -1,8 +1,36 @@
 #pragma once
 #include "produce_plan/scan_parameter.h"
 
+/**
+ * @brief Join the blocks into one table
+ *
+ * @param rel
+ * @param blocks
+ * @param table_schema
+ * @param query
+ * @param filter_tuples True if the joined tuples are filtered by the
+ * validity of the measures
+ * @param checked_measures the measures whose validity is already
+ * checked in the plan of the query. The measures checked by this
+ * sequence are added.
+ * @return shared_ptr<Schema>
+ */
 shared_ptr<Schema> makeJoinSequence(
     ::substrait::Rel *rel,
     const vector<shared_ptr<const ScanParameter>> &blocks,
     shared_ptr<const Schema> table_schema,
-    shared_ptr<const Query> query, bool filter_tuples);
\ No newline at end of file
+    shared_ptr<const Query> query, bool filter_tuples,
+    unordered_set<int> &checked_measures);
+
+/**
+ * @brief Estimate the tuples of the mini tables that makeJoinSequence
+ * joins, in the order it joins them. Each mini table is the left side
+ * of an outer join with the mini tables after it.
+ *
+ * @param blocks
+ * @param table_schema
+ * @return vector<int64_t> the estimated tuples of each mini table
+ */
+vector<int64_t> joinSequenceTuples(
+    const vector<shared_ptr<const ScanParameter>> &blocks,
+    shared_ptr<const Schema> table_schema);
@@ -0,0 +1,46 @@
+#include "produce_plan/make_plan.h"
+#include "configuration.h"
+#include "produce_plan/build_substrait.h"
+#include "produce_plan/produce_scan_parameter.h"
+
+void makeQueryPlan(
+    substrait::Plan *plan, shared_ptr<const Schema> table_schema,
+    shared_ptr<const Query> query,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    int query_index, std::pmr::memory_resource *resource)
+{
+    registFunctions(plan);
+    auto rel = plan->add_relations()->mutable_rel();
+    auto reconstruct = InputParameter::get()->reconstruct;
+    if (reconstruct == InputParameter::Auto)
+    {
+        makeCheapestPlan(rel, table_schema, query, partitions,
+                         query_index, resource);
+        return;
+    }
+    // the join reconstruction only keeps the tuples that pass all
+    // conjuncts in the scans, so a conjunct on several attributes is
+    // left to the residual filter of the aggregation
+    if (reconstruct == InputParameter::Aggregate ||
+        reconstruct == InputParameter::Positional ||
+        reconstruct == InputParameter::Merge ||
+        query->getTemplate()->hasResidualFilters())
+    {
+        auto scan_parameters = produceScanParametersAggregation(
+            query, table_schema, partitions, resource);
+        evaluateAggregatePlan(rel, table_schema, query,
+                              scan_parameters.second,
+                              scan_parameters.first);
+        return;
+    }
+
+    vector<shared_ptr<const ScanParameter>> direct_params,
+        recons_filter_params;
+    vector<vector<shared_ptr<const ScanParameter>>>
+        recons_measure_params;
+    produceScanParameterJoin(query, table_schema, partitions,
+                             direct_params, recons_filter_params,
+                             recons_measure_params, resource);
+    evalauteJoinPlan(rel, table_schema, query, direct_params,
+                     recons_filter_params, recons_measure_params);
+}
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "metadata/boundary.h"
 #include "metadata/query.h"
 #include "metadata/schema.h"
 #include "produce_plan/scan_parameter.h"
 #include "substrait/plan.pb.h"
 #include <boost/dynamic_bitset.hpp>
+#include <memory_resource>
 
 shared_ptr<Schema> evaluateAggregatePlan(
     substrait::Rel *rel, shared_ptr<const Schema> table_schema,
@@ -18,4 +20,45 @@ shared_ptr<Schema> evalauteJoinPlan(
     const vector<shared_ptr<const ScanParameter>> &direct_params,
     const vector<shared_ptr<const ScanParameter>> &recons_filter_params,
     const vector<vector<shared_ptr<const ScanParameter>>>
-        &recons_measure_params);
\ No newline at end of file
+        &recons_measure_params);
+/**
+ * @brief Add the relation of a query with the reconstruction that the
+ * cost model of the partitioner predicts to be the fastest: the late
+ * reconstruction by aggregation, the early reconstruction of the
+ * baselines, the reconstruction by joins, which is not a candidate for
+ * a query with a conjunct on several attributes, or the merge
+ * reconstruction. The predicted time of each reconstruction is reported
+ * on stderr. The aggregation is chosen if the row numbers of the blocks
+ * are unknown.
+ *
+ * @param rel OUTPUT
+ * @param table_schema
+ * @param query
+ * @param partitions the partitions the query may read
+ * @param query_index the position of the query, named in the report
+ * @param resource the memory resource of the scan parameters
+ */
+void makeCheapestPlan(
+    substrait::Rel *rel, shared_ptr<const Schema> table_schema,
+    shared_ptr<const Query> query,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    int query_index, std::pmr::memory_resource *resource);
+
+/**
+ * @brief Produce the plan of a query: register the functions and add
+ * the relation that evaluates the query over the partitions, with the
+ * reconstruction InputParameter::reconstruct selects
+ *
+ * @param plan OUTPUT
+ * @param table_schema
+ * @param query
+ * @param partitions the partitions the query may read
+ * @param query_index the position of the query, named in the reports
+ * @param resource the memory resource of the intermediate objects,
+ * usually the QueryArena of the query
+ */
+void makeQueryPlan(
+    substrait::Plan *plan, shared_ptr<const Schema> table_schema,
+    shared_ptr<const Query> query,
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    int query_index, std::pmr::memory_resource *resource);
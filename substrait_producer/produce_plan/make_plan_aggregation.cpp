@@ -5,8 +5,11 @@
 #include "produce_plan/helper.h"
 #include "produce_plan/make_plan.h"
 #include "substrait/plan.pb.h"
-#include <boost/dynamic_bitset.hpp>
 #include <iostream>
+#include <sstream>
+
+// the least and the greatest tuple id of some blocks
+using TidRange = pair<int64_t, int64_t>;
 
 /**
  * @brief Reconstruct tuples. Filter tuples out if the tuple does not
@@ -20,6 +23,11 @@
  * @param table_schema the schema of the source table
  * @param filters filters in the query
  * @param all_measures all aggregation functions in the query
+ * @param tid_range the least and the greatest tuple id of the input if
+ * the tuples are keyed by their positions in the range, nullptr if they
+ * are keyed by the tuple id
+ * @param input_sorted true if the input is read from one block stored
+ * in the order of the tuple id
  * @return shared_ptr<Schema> the schema after reconstruction, filter
  * and projection
  */
@@ -28,14 +36,16 @@ shared_ptr<Schema> reconstruct(
     shared_ptr<const Schema> input_schema,
     shared_ptr<const Schema> table_schema,
     const vector<shared_ptr<const Expression>> &filters,
-    const vector<shared_ptr<const AggregateExpression>> &all_measures)
+    const vector<shared_ptr<const AggregateExpression>> &all_measures,
+    const TidRange *tid_range = nullptr, bool input_sorted = false)
 {
     substrait::Rel *exchange_rel = nullptr, *agg_rel = nullptr,
                    *filter_rel = nullptr, *project_rel = nullptr,
                    *union_rel = nullptr;
 
-    if (InputParameter::get()->parallel ==
-        InputParameter::AggParallelMethod::Partition)
+    bool partition = InputParameter::get()->parallel ==
+                     InputParameter::AggParallelMethod::Partition;
+    if (partition)
     {
         union_rel = rel;
         project_rel = union_rel->mutable_set()->add_inputs();
@@ -56,7 +66,14 @@ shared_ptr<Schema> reconstruct(
         agg_rel = filter_rel->mutable_filter()->mutable_input();
         agg_rel->mutable_aggregate()->set_allocated_input(input_rel);
     }
-
+    // the merge reconstruction orders the tuples by the tuple id under
+    // the aggregation, after the exchange if any, so that the fragments
+    // of a tuple are adjacent
+    if (InputParameter::get()->reconstruct ==
+            InputParameter::ReconstructType::Merge &&
+        (partition || !input_sorted))
+        orderByTid(agg_rel->mutable_aggregate()->mutable_input(),
+                   input_schema);
     // reconstruct tuples by aggregation
     vector<shared_ptr<const AggregateExpression>> measures;
     for (int i = 0; i < input_schema->size(); i++)
@@ -80,6 +97,23 @@ shared_ptr<Schema> reconstruct(
             name, op, expression, type, true));
     }
     shared_ptr<Expression> group = input_schema->get(tuple_id_name);
+    if (tid_range)
+    {
+        // the dense key tid - base in [0, size), so that the engine
+        // stores the tuples into an array sized from the metadata
+        // instead of probing a hash table
+        int64_t size = tid_range->second - tid_range->first + 1;
+        group = make_shared<FunctionExpression>(
+            tuple_id_name, "tid_position",
+            vector<shared_ptr<const Expression>>{
+                group,
+                make_shared<Literal>("base",
+                                     make_shared<Integer>(
+                                         tid_range->first, 64)),
+                make_shared<Literal>(
+                    "size", make_shared<Integer>(size, 64))},
+            group->getType(), false);
+    }
     auto schema_after_agg =
         aggregate(agg_rel, input_schema, measures, group);
 
@@ -115,8 +149,37 @@ shared_ptr<Schema> reconstruct(
                 valid_check_if));
         }
         else
-            throw Exception("Each atom filter can not contain two or "
-                            "more attributes");
+        {
+            // a conjunct on several attributes is never passed in the
+            // scans (see QueryTemplate::attributesInResidualFilters).
+            // It is evaluated if all its attributes are reconstructed
+            vector<shared_ptr<const Expression>> valid_exps;
+            for (const auto &name : attribute_names)
+            {
+                if (!schema_after_agg->contains(name))
+                {
+                    // no block provides the attribute
+                    valid_exps.clear();
+                    break;
+                }
+                valid_exps.push_back(makeBitmapGet(
+                    valid_attribute_name, schema_after_agg,
+                    table_schema->getOffset(name)));
+            }
+            if (valid_exps.empty())
+            {
+                new_filters.push_back(make_shared<Literal>(
+                    "error", make_shared<Boolean>(false)));
+                continue;
+            }
+            new_filters.push_back(make_shared<IfFunctionExpression>(
+                filters[i]->getName(),
+                FunctionExpression::connectExpression(
+                    "check_valid_attributs", valid_exps, false, "and"),
+                filters[i],
+                make_shared<Literal>("error",
+                                     make_shared<Boolean>(false))));
+        }
     }
 
     auto schema_after_filter = schema_after_agg;
@@ -129,7 +192,9 @@ shared_ptr<Schema> reconstruct(
     }
     else
     {
-        // skip the filter operator
+        // skip the filter operator. agg_rel is released from the
+        // filter first, or it would be deleted with the filter
+        filter_rel->mutable_filter()->unsafe_arena_release_input();
         project_rel->mutable_project()->set_allocated_input(agg_rel);
     }
 
@@ -188,57 +253,158 @@ shared_ptr<Schema> reconstruct(
     auto schema_after_project =
         project(project_rel, project_expression, schema_after_filter);
 
-    if (InputParameter::get()->parallel ==
-        InputParameter::AggParallelMethod::Partition)
+    if (partition)
         return unionAll(union_rel, schema_after_project);
     else
         return schema_after_project;
 }
 
-shared_ptr<Schema> reconstructPath(
+/**
+ * @brief Read and reconstruct the tuples of some blocks
+ *
+ * @param rel
+ * @param table_schema
+ * @param scan_parameters
+ * @param reconstruct_attributes the attributes read by every parameter
+ * @param query
+ * @param tid_range the tuple ids of the blocks if the tuples are keyed
+ * by their positions, nullptr if keyed by the tuple id
+ * @return shared_ptr<Schema>
+ */
+shared_ptr<Schema> reconstructBlocks(
     substrait::Rel *rel, shared_ptr<const Schema> table_schema,
     const vector<shared_ptr<const ScanParameter>> &scan_parameters,
-    shared_ptr<const Query> query)
+    const AttributeSet &reconstruct_attributes,
+    shared_ptr<const Query> query,
+    const TidRange *tid_range)
 {
-    // read data
-    boost::dynamic_bitset<> reconstruct_attributes(
-        table_schema->size());
-    for (auto p : scan_parameters)
-        reconstruct_attributes |= p->project_attributes;
-    vector<substrait::Rel *> read_rel;
+    // read the blocks directly into the inputs of the union
+    substrait::Rel *union_rel = newRel(*rel);
     shared_ptr<Schema> schema_after_read;
     for (auto p : scan_parameters)
     {
-        auto rel = new substrait::Rel();
-        auto s = readForReconstruction(rel, p, table_schema,
-                                       reconstruct_attributes);
+        auto s = readForReconstruction(
+            union_rel->mutable_set()->add_inputs(), p, table_schema,
+            reconstruct_attributes);
         if (!schema_after_read)
             schema_after_read = s;
         else if (!schema_after_read->equal(s))
             throw Exception("reconstructPath: inputs of union have "
                             "different schemas");
-        read_rel.push_back(rel);
     }
 
     // union all
-    substrait::Rel *union_rel = new substrait::Rel();
     auto schema_after_union = unionAll(union_rel, schema_after_read);
-    for (auto r : read_rel)
-    {
-        *union_rel->mutable_set()->add_inputs() = *r;
-        delete r;
-    }
 
-    // reconstruct
+    // reconstruct. The order of several blocks in one read is up to
+    // the engine, so only a single block keeps its stored order
+    bool sorted = scan_parameters.size() == 1 &&
+                  isSortedByTid(*scan_parameters[0]);
     vector<shared_ptr<const Expression>> query_filter_sub_exps;
-    for (auto e : query->getFilter()->getSubExpressions("and"))
+    for (auto e : query->getSubFilters())
         query_filter_sub_exps.push_back(e);
-    auto schema_after_reconstruct =
-        reconstruct(rel, union_rel, schema_after_union, table_schema,
-                    query_filter_sub_exps, query->getMeasures());
+    auto schema_after_reconstruct = reconstruct(
+        rel, union_rel, schema_after_union, table_schema,
+        query_filter_sub_exps, query->getMeasures(), tid_range, sorted);
     return schema_after_reconstruct;
 }
 
+/**
+ * @brief Split the parameters into groups whose blocks have disjoint
+ * tuple ids. The fragments of a tuple are in blocks that all cover its
+ * id, so each group is reconstructed on its own. A block without a
+ * tuple id range takes the range of the table.
+ *
+ * @param scan_parameters
+ * @param table_range the tuple ids of the table
+ * @return vector<pair<TidRange, vector<shared_ptr<const
+ * ScanParameter>>>> the tuple ids and the parameters of each group, in
+ * the order of the ranges
+ */
+vector<pair<TidRange, vector<shared_ptr<const ScanParameter>>>>
+splitByTidRange(
+    const vector<shared_ptr<const ScanParameter>> &scan_parameters,
+    const TidRange &table_range)
+{
+    vector<pair<TidRange, shared_ptr<const ScanParameter>>> ranges;
+    for (auto &p : scan_parameters)
+    {
+        TidRange range(INT64_MAX, INT64_MIN);
+        for (auto &b : p->blocks)
+        {
+            if (!b->hasTidRange())
+            {
+                range = table_range;
+                break;
+            }
+            range.first = std::min(range.first, b->getTidMin());
+            range.second = std::max(range.second, b->getTidMax());
+        }
+        if (p->blocks.empty())
+            range = table_range;
+        ranges.emplace_back(range, p);
+    }
+    std::stable_sort(ranges.begin(), ranges.end(),
+                     [](const auto &a, const auto &b) {
+                         return a.first.first < b.first.first;
+                     });
+
+    vector<pair<TidRange, vector<shared_ptr<const ScanParameter>>>>
+        groups;
+    for (auto &r : ranges)
+    {
+        if (groups.empty() ||
+            r.first.first > groups.back().first.second)
+            groups.push_back({r.first, {}});
+        auto &group = groups.back();
+        group.first.second =
+            std::max(group.first.second, r.first.second);
+        group.second.push_back(r.second);
+    }
+    return groups;
+}
+
+shared_ptr<Schema> reconstructPath(
+    substrait::Rel *rel, shared_ptr<const Schema> table_schema,
+    const vector<shared_ptr<const ScanParameter>> &scan_parameters,
+    shared_ptr<const Query> query)
+{
+    AttributeSet reconstruct_attributes(table_schema->size());
+    for (auto p : scan_parameters)
+        reconstruct_attributes |= p->project_attributes;
+    if (InputParameter::get()->reconstruct !=
+        InputParameter::ReconstructType::Positional)
+        return reconstructBlocks(rel, table_schema, scan_parameters,
+                                 reconstruct_attributes, query,
+                                 nullptr);
+
+    auto tid = query->getStatistics()->getRange(tuple_id_name);
+    TidRange table_range(
+        static_cast<const Integer *>(tid->lower())->getValue(),
+        static_cast<const Integer *>(tid->upper())->getValue());
+    auto groups = splitByTidRange(scan_parameters, table_range);
+    if (groups.size() == 1)
+        return reconstructBlocks(rel, table_schema, groups[0].second,
+                                 reconstruct_attributes, query,
+                                 &groups[0].first);
+
+    // union the tuples reconstructed in each range
+    shared_ptr<Schema> schema_after_reconstruct;
+    for (auto &group : groups)
+    {
+        auto s = reconstructBlocks(rel->mutable_set()->add_inputs(),
+                                   table_schema, group.second,
+                                   reconstruct_attributes, query,
+                                   &group.first);
+        if (!schema_after_reconstruct)
+            schema_after_reconstruct = s;
+        else if (!schema_after_reconstruct->equal(s))
+            throw Exception("reconstructPath: tuple id ranges have "
+                            "different schemas");
+    }
+    return unionAll(rel, schema_after_reconstruct);
+}
+
 /**
  * @brief evaluate expressions in all aggregation measures after reading
  * data in direct_evaluation path.
@@ -291,37 +457,24 @@ shared_ptr<Schema> directEvalPath(
     const vector<shared_ptr<const ScanParameter>> &scan_parameters,
     shared_ptr<const Query> query)
 {
-    boost::dynamic_bitset<> direct_attributes(table_schema->size());
-    int measure_num = query->numOfMeasures();
-    for (int i = 0; i < measure_num; i++)
-    {
-        auto attrs = query->attributesInMeasure(i);
-        for (auto a : *attrs)
-            direct_attributes.set(table_schema->getOffset(a));
-    }
-    vector<substrait::Rel *> read_rel;
+    AttributeSet direct_attributes = query->attributesInMeasures();
+    // read the blocks directly into the inputs of the union
+    substrait::Rel *union_rel = newRel(*rel);
     shared_ptr<Schema> schema_after_read;
     for (auto p : scan_parameters)
     {
-        auto rel = new substrait::Rel();
-        auto s =
-            readForDirectEval(rel, p, table_schema, direct_attributes);
+        auto s = readForDirectEval(
+            union_rel->mutable_set()->add_inputs(), p, table_schema,
+            direct_attributes);
         if (!schema_after_read)
             schema_after_read = std::move(s);
         else if (schema_after_read && !schema_after_read->equal(s))
             throw Exception("directEvalPath: inputs of union have "
                             "different schemas");
-        read_rel.push_back(rel);
     }
 
     // union all
-    substrait::Rel *union_rel = new substrait::Rel();
     auto schema_after_union = unionAll(union_rel, schema_after_read);
-    for (auto r : read_rel)
-    {
-        *union_rel->mutable_set()->add_inputs() = *r;
-        delete r;
-    }
 
     // project
     substrait::Rel *project_input_rel;
@@ -347,27 +500,32 @@ shared_ptr<Schema> evaluateAggregatePlan(
         mergeBeforeRead(unmerged_reconstruct_params);
     auto direct_params = mergeBeforeRead(unmerged_direct_params);
 
-    // print input plan
-    cout << table_schema->toString() << endl;
-    cout << query->toString() << endl;
-    printf("*************Reconstruct parameters (%zu "
-           "params)*************\n",
-           reconstruct_params.size());
-    for (auto p : reconstruct_params)
-        cout << p->toString() << endl;
-    printf(
-        "*************Direct parameters  (%zu params)*************\n",
-        direct_params.size());
-    for (auto p : direct_params)
-        cout << p->toString() << endl;
-
-    auto all_measures = query->getMeasures();
+    // print input plan in one write, so that the plans of the queries
+    // planned at the same time do not interleave
+    if (InputParameter::get()->verbose)
+    {
+        std::ostringstream dump;
+        dump << table_schema->toString() << endl;
+        dump << query->toString() << endl;
+        dump << "*************Reconstruct parameters ("
+             << reconstruct_params.size() << " params)*************\n";
+        for (auto p : reconstruct_params)
+            dump << p->toString() << endl;
+        dump << "*************Direct parameters  ("
+             << direct_params.size() << " params)*************\n";
+        for (auto p : direct_params)
+            dump << p->toString() << endl;
+        fputs(dump.str().c_str(), stdout);
+    }
+
+    const auto &all_measures = query->getMeasures();
     shared_ptr<Schema> schema_out_path;
 
-    substrait::Rel *reconstruct_rel = new substrait::Rel();
+    substrait::Rel *reconstruct_rel = nullptr;
     shared_ptr<Schema> schema_after_reconstruct;
     if (reconstruct_params.size() > 0)
     {
+        reconstruct_rel = newRel(*rel);
         schema_after_reconstruct = reconstructPath(
             reconstruct_rel, table_schema, reconstruct_params, query);
         if (schema_after_reconstruct->size() != all_measures.size())
@@ -377,10 +535,11 @@ shared_ptr<Schema> evaluateAggregatePlan(
         schema_out_path = schema_after_reconstruct;
     }
 
-    substrait::Rel *direct_rel = new substrait::Rel();
+    substrait::Rel *direct_rel = nullptr;
     shared_ptr<Schema> schema_after_direct;
     if (direct_params.size() > 0)
     {
+        direct_rel = newRel(*rel);
         schema_after_direct = directEvalPath(direct_rel, table_schema,
                                              direct_params, query);
         if (schema_after_direct->size() != all_measures.size())
@@ -395,8 +554,13 @@ shared_ptr<Schema> evaluateAggregatePlan(
         throw Exception("evaluate: direct path and reconstruction path "
                         "must have the same out schema");
 
+    // no block passes the filter, so aggregate an empty table
+    substrait::Rel *empty_rel = nullptr;
     if (!schema_out_path)
-        return nullptr;
+    {
+        empty_rel = newRel(*rel);
+        schema_out_path = readNothing(empty_rel, all_measures);
+    }
 
     auto agg_rel = rel;
     auto union_rel = agg_rel->mutable_aggregate()->mutable_input();
@@ -408,12 +572,15 @@ shared_ptr<Schema> evaluateAggregatePlan(
     }
 
     auto schema_after_union = unionAll(union_rel, schema_out_path);
-    if (schema_after_reconstruct)
-        *union_rel->mutable_set()->add_inputs() = *reconstruct_rel;
-    if (schema_after_direct)
-        *union_rel->mutable_set()->add_inputs() = *direct_rel;
-    delete reconstruct_rel;
-    delete direct_rel;
+    if (reconstruct_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            reconstruct_rel);
+    if (direct_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            direct_rel);
+    if (empty_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            empty_rel);
 
     if (exchange_rel)
         schema_after_union =
@@ -2,12 +2,14 @@
 #include "produce_plan/helper.h"
 #include "produce_plan/join_sequence.h"
 #include "produce_plan/make_plan.h"
+#include <sstream>
 
 shared_ptr<Schema> unionReconsMeasure(
     substrait::Rel *rel, shared_ptr<const Schema> table_schema,
     shared_ptr<const Query> query,
     const vector<vector<shared_ptr<const ScanParameter>>>
-        &recons_measure_params)
+        &recons_measure_params,
+    unordered_set<int> &checked_measures)
 {
     assert(recons_measure_params.size() > 1);
     substrait::Rel *exchange_rel = nullptr, *union_rel = rel;
@@ -24,9 +26,9 @@ shared_ptr<Schema> unionReconsMeasure(
     for (const auto &p : recons_measure_params)
         for (auto i : p)
         {
-            for (int a = i->project_attributes.find_first();
-                 a != i->project_attributes.npos;
-                 a = i->project_attributes.find_next(a))
+            for (int a = i->project_attributes.findFirst();
+                 a != AttributeSet::npos;
+                 a = i->project_attributes.findNext(a))
                 union_attributes.insert(
                     table_schema->get(a)->getName());
         }
@@ -35,7 +37,7 @@ shared_ptr<Schema> unionReconsMeasure(
         auto project_rel = union_rel->mutable_set()->add_inputs();
         auto schema_after_join = makeJoinSequence(
             project_rel->mutable_project()->mutable_input(), params,
-            table_schema, query, true);
+            table_schema, query, true, checked_measures);
 
         vector<shared_ptr<const Expression>> project_expression;
         for (auto a : union_attributes)
@@ -78,8 +80,8 @@ shared_ptr<Schema> reconstructByJoin(
         filter_rel->mutable_filter()->mutable_input();
     ::substrait::Rel *join_rel =
         project_rel->mutable_project()->mutable_input();
-    *join_rel->mutable_join()->mutable_left() = *left_rel;
-    *join_rel->mutable_join()->mutable_right() = *right_rel;
+    join_rel->mutable_join()->set_allocated_left(left_rel);
+    join_rel->mutable_join()->set_allocated_right(right_rel);
 
     vector<int> left_map, right_map;
     auto join_out_schema = equalJoin(
@@ -120,8 +122,7 @@ shared_ptr<Schema> reconstructByJoin(
     }
 
     // filter tuples that do not pass all predicates
-    int pred_count =
-        query->getFilter()->getSubExpressions("and").size();
+    int pred_count = query->getTemplate()->numOfSubFilters();
     auto bitmap_count_exp = make_shared<FunctionExpression>(
         "bitmap_count_exp", "bitmap_count",
         vector<shared_ptr<const Expression>>{
@@ -143,7 +144,7 @@ shared_ptr<Schema> evaluateMeasure(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema)
 {
-    *rel->mutable_project()->mutable_input() = *input_rel;
+    rel->mutable_project()->set_allocated_input(input_rel);
 
     vector<shared_ptr<const Expression>> project_expression;
     const auto &all_measures = query->getMeasures();
@@ -156,8 +157,7 @@ shared_ptr<Schema> evaluateMeasure(
 
         // check if all referred attributes are valid
         bool all_exist = true;
-        boost::dynamic_bitset<> attributes_offset(table_schema->size(),
-                                                  false);
+        AttributeSet attributes_offset(table_schema->size());
         for (const string &a : attributes_in_measures)
         {
             all_exist &= input_schema->contains(a);
@@ -217,43 +217,45 @@ shared_ptr<Schema> reconstructPath(
     const vector<vector<shared_ptr<const ScanParameter>>>
         &recons_measure_params)
 {
-    auto project_rel = rel;
-    auto join_rel = project_rel->mutable_project()->mutable_input();
     shared_ptr<Schema> schema_after_join;
 
-    // union the probe table
+    // union the probe table. The validity of a measure is checked once
+    // in the plan
     assert(recons_measure_params.size() > 0);
-    ::substrait::Rel join_left_rel;
+    unordered_set<int> checked_measures;
+    auto join_left_rel = newRel(*rel);
     shared_ptr<Schema> join_left_schema;
     if (recons_measure_params.size() == 1)
         join_left_schema =
-            makeJoinSequence(&join_left_rel, recons_measure_params[0],
-                             table_schema, query, true);
+            makeJoinSequence(join_left_rel, recons_measure_params[0],
+                             table_schema, query, true,
+                             checked_measures);
     else
         join_left_schema = unionReconsMeasure(
-            &join_left_rel, table_schema, query, recons_measure_params);
+            join_left_rel, table_schema, query, recons_measure_params,
+            checked_measures);
 
     // join the probe table with the filter table
+    ::substrait::Rel *join_rel = join_left_rel;
     if (recons_filter_params.size() == 0)
-    {
-        *join_rel = join_left_rel;
         schema_after_join = join_left_schema;
-    }
     else
     {
         // build the filter table
-        ::substrait::Rel join_right_rel;
+        auto join_right_rel = newRel(*rel);
         auto join_right_schema =
-            makeJoinSequence(&join_right_rel, recons_filter_params,
-                             table_schema, query, false);
+            makeJoinSequence(join_right_rel, recons_filter_params,
+                             table_schema, query, false,
+                             checked_measures);
+        join_rel = newRel(*rel);
         schema_after_join = reconstructByJoin(
-            join_rel, &join_left_rel, join_left_schema, &join_right_rel,
+            join_rel, join_left_rel, join_left_schema, join_right_rel,
             join_right_schema, query);
     }
 
     // evaluate the measures
-    return evaluateMeasure(project_rel, join_rel, schema_after_join,
-                           query, table_schema);
+    return evaluateMeasure(rel, join_rel, schema_after_join, query,
+                           table_schema);
 }
 
 shared_ptr<Schema> evalauteJoinPlan(
@@ -275,46 +277,55 @@ shared_ptr<Schema> evalauteJoinPlan(
     for (const auto &p : unmerged_recons_measure_params)
         recons_measure_params.push_back(mergeBeforeRead(p));
 
-    // print input plan
-    cout << table_schema->toString() << endl;
-    cout << query->toString() << endl;
-    printf("*************Direct parameters (%zu params)*************\n",
-           direct_params.size());
-    for (auto p : direct_params)
-        cout << p->toString() << endl;
-    printf("*************Reconstruct filter parameters (%zu "
-           "params)*************\n",
-           recons_filter_params.size());
-    for (auto p : recons_filter_params)
-        cout << p->toString() << endl;
-    printf("*************Reconstruct measure parameters (%zu "
-           "params)*************\n",
-           recons_measure_params.size());
-    for (int i = 0; i < recons_measure_params.size(); i++)
+    // print input plan in one write, so that the plans of the queries
+    // planned at the same time do not interleave
+    if (InputParameter::get()->verbose)
     {
-        cout << "*************Group " << i << "*************" << endl;
-        for (auto p : recons_measure_params[i])
-            cout << p->toString() << endl;
+        std::ostringstream dump;
+        dump << table_schema->toString() << endl;
+        dump << query->toString() << endl;
+        dump << "*************Direct parameters ("
+             << direct_params.size() << " params)*************\n";
+        for (auto p : direct_params)
+            dump << p->toString() << endl;
+        dump << "*************Reconstruct filter parameters ("
+             << recons_filter_params.size()
+             << " params)*************\n";
+        for (auto p : recons_filter_params)
+            dump << p->toString() << endl;
+        dump << "*************Reconstruct measure parameters ("
+             << recons_measure_params.size()
+             << " params)*************\n";
+        for (int i = 0; i < recons_measure_params.size(); i++)
+        {
+            dump << "*************Group " << i << "*************"
+                 << endl;
+            for (auto p : recons_measure_params[i])
+                dump << p->toString() << endl;
+        }
+        fputs(dump.str().c_str(), stdout);
     }
 
     shared_ptr<Schema> schema_out_path;
-    substrait::Rel reconstruct_rel;
+    substrait::Rel *reconstruct_rel = nullptr;
     shared_ptr<Schema> schema_after_reconstruct;
     if (recons_measure_params.size() > 0)
     {
+        reconstruct_rel = newRel(*rel);
         schema_after_reconstruct = reconstructPath(
-            &reconstruct_rel, table_schema, query, recons_filter_params,
+            reconstruct_rel, table_schema, query, recons_filter_params,
             recons_measure_params);
         assert(schema_after_reconstruct->size() ==
                query->getMeasures().size());
         schema_out_path = schema_after_reconstruct;
     }
 
-    substrait::Rel direct_rel;
+    substrait::Rel *direct_rel = nullptr;
     shared_ptr<Schema> schema_after_direct;
     if (direct_params.size() > 0)
     {
-        schema_after_direct = directEvalPath(&direct_rel, table_schema,
+        direct_rel = newRel(*rel);
+        schema_after_direct = directEvalPath(direct_rel, table_schema,
                                              direct_params, query);
         assert(schema_after_direct->size() ==
                query->getMeasures().size());
@@ -324,8 +335,13 @@ shared_ptr<Schema> evalauteJoinPlan(
     if (schema_after_direct && schema_after_reconstruct)
         assert(schema_after_direct->equal(schema_after_reconstruct));
 
+    // no block passes the filter, so aggregate an empty table
+    substrait::Rel *empty_rel = nullptr;
     if (!schema_out_path)
-        return nullptr;
+    {
+        empty_rel = newRel(*rel);
+        schema_out_path = readNothing(empty_rel, query->getMeasures());
+    }
 
     auto agg_rel = rel;
     auto union_rel = agg_rel->mutable_aggregate()->mutable_input();
@@ -337,10 +353,15 @@ shared_ptr<Schema> evalauteJoinPlan(
     }
 
     auto schema_after_union = unionAll(union_rel, schema_out_path);
-    if (schema_after_reconstruct)
-        *union_rel->mutable_set()->add_inputs() = reconstruct_rel;
-    if (schema_after_direct)
-        *union_rel->mutable_set()->add_inputs() = direct_rel;
+    if (reconstruct_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            reconstruct_rel);
+    if (direct_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            direct_rel);
+    if (empty_rel)
+        union_rel->mutable_set()->mutable_inputs()->AddAllocated(
+            empty_rel);
 
     if (exchange_rel)
         schema_after_union =
@@ -1,16 +1,22 @@
 #include "produce_plan/produce_scan_parameter.h"
+#include "arena.h"
 #include "metadata/boundary.h"
 
 namespace scan_parameter_internal
 {
-unordered_set<shared_ptr<const BlockMeta>> filterBlocks(
-    const unordered_set<shared_ptr<const BlockMeta>> &blocks,
-    shared_ptr<const Boundary> filter,
-    const unordered_set<string> &attributes)
+BlockSet filterBlocks(const BlockSet &blocks,
+                      shared_ptr<const ComplexBoundary> filter,
+                      const AttributeSet &attributes,
+                      std::pmr::memory_resource *resource,
+                      const BlockMeta *source)
 {
-    unordered_set<shared_ptr<const BlockMeta>> result;
+    BlockSet result(resource);
     for (auto b : blocks)
     {
+        // the tuple id test is cheaper than the boundary, so it goes
+        // first
+        if (source && source->tidDisjoint(*b))
+            continue;
         if (b->relationship(filter, attributes) !=
             SET_RELATION::DISJOINT)
             result.insert(b);
@@ -18,14 +24,16 @@ unordered_set<shared_ptr<const BlockMeta>> filterBlocks(
     return result;
 }
 
-shared_ptr<Boundary> convergeBoundary(shared_ptr<const Boundary> source,
-                                      shared_ptr<const Boundary> target)
+shared_ptr<Boundary>
+convergeBoundary(shared_ptr<const Boundary> source,
+                 shared_ptr<const Boundary> target,
+                 std::pmr::memory_resource *resource)
 {
-    Boundary b = source->intersect(*target);
+    Boundary b = source->intersect(*target, resource);
     // remove the intervals from b that are equal to the source
-    auto intervals_b = b.getIntervals();
-    auto intervals_s = source->getIntervals();
-    unordered_map<string, shared_ptr<const Interval>> intervals_result;
+    const auto &intervals_b = b.getIntervals();
+    const auto &intervals_s = source->getIntervals();
+    IntervalMap intervals_result(resource);
     for (auto it = intervals_b.begin(); it != intervals_b.end(); it++)
     {
         auto it_s = intervals_s.find(it->first);
@@ -34,42 +42,48 @@ shared_ptr<Boundary> convergeBoundary(shared_ptr<const Boundary> source,
                 SET_RELATION::EQUAL)
             intervals_result.emplace(it->first, it->second);
     }
-    return make_shared<Boundary>(intervals_result);
+    return makeArenaShared<Boundary>(
+        resource, std::move(intervals_result), b.getStatistics());
 }
 
 shared_ptr<ComplexBoundary> convergeBoundary(
     shared_ptr<const Boundary> source,
-    shared_ptr<const ComplexBoundary> target)
+    shared_ptr<const ComplexBoundary> target,
+    std::pmr::memory_resource *resource)
 {
-    ComplexBoundary b = target->intersect(*source);
-    auto intervals_b = b.getIntervals();
-    auto intervals_s = source->getIntervals();
-    unordered_set<string> keep_attributes;
+    ComplexBoundary b = target->intersect(*source, resource);
+    const auto &intervals_b = b.getIntervals();
+    const auto &intervals_s = source->getIntervals();
+    AttributeSet keep_attributes;
     for (auto it = intervals_b.begin(); it != intervals_b.end(); it++)
     {
         auto it_s = intervals_s.find(it->first);
-        if (it_s == intervals_s.end())
-            keep_attributes.insert(it->first);
-        else if (it->second.size() != 1 ||
-                 it->second[0]->relationship(*it_s->second) !=
-                     SET_RELATION::EQUAL)
-            keep_attributes.insert(it->first);
+        if (it_s == intervals_s.end() || it->second.size() != 1 ||
+            it->second[0]->relationship(*it_s->second) !=
+                SET_RELATION::EQUAL)
+            keep_attributes.set(it->first);
     }
     b.keepAttributes(keep_attributes);
-    return make_shared<ComplexBoundary>(b);
+    return makeArenaShared<ComplexBoundary>(resource, std::move(b));
 }
 
 string RawRequest::toString() const
 {
+    auto table_schema = query->getTableSchema();
+    auto names = [&](const AttributeSet &attributes) {
+        string r;
+        for (int i = attributes.findFirst(); i != AttributeSet::npos;
+             i = attributes.findNext(i))
+            r += table_schema->get(i)->getName() + ",";
+        return r;
+    };
     string s = "RawRequest{\n\tpartition:";
     s += block->getPartition()->getPath() + "\n\tblock_id:";
     s += std::to_string(block->getBlockID()) +
          "\n\tfilter_requested_attributes:{";
-    for (auto a : filter_requested_attributes)
-        s += a + ",";
+    s += names(filter_requested_attributes);
     s += "}\n\tmeasure_requested_attributes:{";
-    for (auto a : measure_requested_attributes)
-        s += a + ",";
+    s += names(measure_requested_attributes);
     s += "}\n\tfilter_requested_filters:{";
     for (auto f : filter_requested_filters)
         s += "\t\t" + f->toString() + "\n";
@@ -77,20 +91,20 @@ string RawRequest::toString() const
     for (auto f : measure_requested_filters)
         s += "\t\t" + f->toString() + "\n";
     s += "}\n\tpassed_filter_attributes:";
-    for (auto a : passed_filter_attributes)
-        s += a;
+    s += names(passed_filter_attributes);
     s += "\n\textra_check_filter_attributes:";
-    for (auto a : extra_check_filter_attributes)
-        s += a;
+    s += names(extra_check_filter_attributes);
     s += "\n}";
     return s;
 }
 
-RawRequest *RawRequest::clone() const
+shared_ptr<RawRequest>
+RawRequest::clone(std::pmr::memory_resource *resource) const
 {
-    RawRequest *new_request = new RawRequest();
+    auto new_request = makeArenaShared<RawRequest>(resource);
     new_request->block = this->block;
     new_request->query = this->query;
+    new_request->resource = resource;
     new_request->filter_requested_attributes =
         this->filter_requested_attributes;
     new_request->measure_requested_attributes =
@@ -100,25 +114,23 @@ RawRequest *RawRequest::clone() const
     new_request->extra_check_filter_attributes =
         this->extra_check_filter_attributes;
 
-    for (auto f : this->filter_requested_filters)
-        new_request->filter_requested_filters.push_back(
-            shared_ptr<const Boundary>(f->clone()));
-    for (auto f : this->measure_requested_filters)
-        new_request->measure_requested_filters.push_back(
-            shared_ptr<const Boundary>(f->clone()));
+    // the requested filters are immutable and can be shared
+    new_request->filter_requested_filters =
+        this->filter_requested_filters;
+    new_request->measure_requested_filters =
+        this->measure_requested_filters;
     return new_request;
 }
 
-void RawRequest::add_attributes(unordered_set<string> &target,
-                                const unordered_set<string> &attributes)
+void RawRequest::add_attributes(AttributeSet &target,
+                                const AttributeSet &attributes)
 {
-    auto attribute_block = block->getSchema()->getAttributeNames();
-    auto intersection = set_intersection(attribute_block, attributes);
-    target.insert(intersection.begin(), intersection.end());
+    target |= attributes & block->getSchema()->getAttributeSet();
 }
 
-void RawRequest::request(const unordered_set<string> &attributes,
-                         shared_ptr<const Boundary> filter, int type)
+void RawRequest::request(const AttributeSet &attributes,
+                         shared_ptr<const ComplexBoundary> filter,
+                         int type)
 {
     switch (type)
     {
@@ -138,76 +150,54 @@ void RawRequest::request(const unordered_set<string> &attributes,
     }
 }
 
-void RawRequest::intersectFilter(const Boundary &b)
+void RawRequest::intersectFilter(const ComplexBoundary &b)
 {
     for (int i = 0; i < this->filter_requested_filters.size(); i++)
-        filter_requested_filters[i] = make_shared<Boundary>(
-            filter_requested_filters[i]->intersect(b));
+        filter_requested_filters[i] = makeArenaShared<ComplexBoundary>(
+            resource,
+            filter_requested_filters[i]->intersect(b, resource));
     for (int i = 0; i < this->measure_requested_filters.size(); i++)
-        measure_requested_filters[i] = make_shared<Boundary>(
-            measure_requested_filters[i]->intersect(b));
+        measure_requested_filters[i] = makeArenaShared<ComplexBoundary>(
+            resource,
+            measure_requested_filters[i]->intersect(b, resource));
 }
 
 void RawRequest::finalize()
 {
     // remove requested attributes that are not in the block
-    for (auto it = this->filter_requested_attributes.begin();
-         it != this->filter_requested_attributes.end();)
-    {
-        if (block->getSchema()->contains(*it))
-            it++;
-        else
-            it = this->filter_requested_attributes.erase(it);
-    }
-    for (auto it = this->measure_requested_attributes.begin();
-         it != this->measure_requested_attributes.end();)
-    {
-        if (block->getSchema()->contains(*it))
-            it++;
-        else
-            it = this->measure_requested_attributes.erase(it);
-    }
-
-    for (auto it = extra_check_filter_attributes.begin();
-         it != extra_check_filter_attributes.end();)
-        if (block->getSchema()->contains(*it))
-            it++;
-        else
-            it = this->extra_check_filter_attributes.erase(it);
+    const auto &block_attributes =
+        block->getSchema()->getAttributeSet();
+    filter_requested_attributes &= block_attributes;
+    measure_requested_attributes &= block_attributes;
+    extra_check_filter_attributes &= block_attributes;
 
     // intersect filters
-    intersectFilter(
-        block->getBoundary()->intersect(*query->getFilterBoundary()));
+    intersectFilter(query->getFilterBoundary()->intersect(
+        *block->getBoundary(), resource));
 }
 
 ScanParameter RawScanParameter::produceScanParameter(
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const FunctionExpression>>
-        &sub_filters_in_query,
+    const vector<int> &sub_filter_attributes,
     shared_ptr<const BlockMeta> block) const
 {
     ScanParameter p;
-    p.read_attributes.resize(table_schema->size(), false);
-    for (auto i : read_attributes)
-        p.read_attributes.set(table_schema->getOffset(i));
-    p.project_attributes.resize(table_schema->size(), false);
-    for (auto i : project_attributes)
-        p.project_attributes.set(table_schema->getOffset(i));
+    p.read_attributes = read_attributes;
+    p.read_attributes.resize(table_schema->size());
+    p.project_attributes = project_attributes;
+    p.project_attributes.resize(table_schema->size());
     p.direct_meassures = *this->direct_measures;
 
-    p.passed_preds.resize(sub_filters_in_query.size(), false);
-    for (int i = 0; i < sub_filters_in_query.size(); i++)
-    {
-        auto attributes = sub_filters_in_query[i]->getAttributes();
-        if (attributes.size() != 1)
-            throw Exception("The atom sub expression in query "
-                            "predicate must have one attribtue");
-        string a = *attributes.begin();
-        if (this->passed_attributes.count(a))
+    p.passed_preds.resize(sub_filter_attributes.size(), false);
+    for (int i = 0; i < sub_filter_attributes.size(); i++)
+        if (sub_filter_attributes[i] >= 0 &&
+            this->passed_attributes.test(sub_filter_attributes[i]))
             p.passed_preds.set(i);
-    }
     p.filter_boundary = this->filters;
-    p.filter = this->filters->makeExpression();
+    // equal filters share one node, so that merging the parameters of
+    // the blocks compares them by pointer
+    p.filter = Expression::intern<FunctionExpression>(
+        this->filters->makeExpression());
 
     p.block_id = {block->getBlockID()};
     p.blocks = {block};
@@ -216,57 +206,61 @@ ScanParameter RawScanParameter::produceScanParameter(
     return p;
 }
 
-void postRequests(
-    shared_ptr<const Query> query,
-    const unordered_set<shared_ptr<const BlockMeta>> &target_blocks,
-    shared_ptr<const Boundary> filter,
-    const unordered_set<string> &attributes, int request_type,
-    unordered_map<shared_ptr<const BlockMeta>, RawRequest> &requests)
+void postRequests(shared_ptr<const Query> query,
+                  const BlockSet &target_blocks,
+                  shared_ptr<const ComplexBoundary> filter,
+                  const AttributeSet &attributes, int request_type,
+                  RequestMap &requests)
 {
+    auto resource = requests.get_allocator().resource();
     for (auto b : target_blocks)
     {
         if (requests.count(b) == 0)
-            requests[b] = {b, query};
+            requests[b] = {b, query, resource};
         requests[b].request(attributes, filter, request_type);
     }
 }
 
-unordered_map<shared_ptr<const BlockMeta>, RawRequest> postRequests(
-    shared_ptr<const Query> query,
-    const unordered_set<shared_ptr<const BlockMeta>> &block_measures,
-    const unordered_set<shared_ptr<const BlockMeta>> &block_filters)
+RequestMap postRequests(shared_ptr<const Query> query,
+                        const BlockSet &block_measures,
+                        const BlockSet &block_filters,
+                        std::pmr::memory_resource *resource)
 {
-    unordered_map<shared_ptr<const BlockMeta>, RawRequest> requests;
+    RequestMap requests(resource);
 
     auto boundary_query = query->getFilterBoundary();
-    auto query_filter_attributes = boundary_query->getAttributes();
+    const auto &query_filter_attributes = query->attributesInFilter();
+    const auto &residual_attributes =
+        query->attributesInResidualFilters();
     int measure_num = query->numOfMeasures();
 
     for (auto b : block_measures)
     {
         auto boundary_block = b->getBoundary();
-        auto schema_block = b->getSchema();
-        auto attributes_block = schema_block->getAttributeNames();
+        const auto &attributes_block =
+            b->getSchema()->getAttributeSet();
         // skip the block if the block boundary is disjoint with the
         // query boundary (should not happen)
         auto filter_rel = boundary_block->relationship(*boundary_query);
         if (filter_rel == SET_RELATION::DISJOINT)
             continue;
 
-        shared_ptr<Boundary> boundary_block_query =
-            make_shared<Boundary>(
-                boundary_block->intersect(*boundary_query));
+        shared_ptr<ComplexBoundary> boundary_block_query =
+            makeArenaShared<ComplexBoundary>(
+                resource,
+                boundary_query->intersect(*boundary_block, resource));
         // post the missing attributes requested in measures
         for (int i = 0; i < measure_num; i++)
         {
-            auto attributes_measure = query->attributesInMeasure(i);
+            const auto &attributes_measure =
+                query->attributesInMeasure(i);
             auto attributes_diff =
-                set_difference(*attributes_measure, attributes_block);
-            if (attributes_diff.size() == attributes_measure->size())
+                attributes_measure - attributes_block;
+            if (attributes_diff == attributes_measure)
                 // the block does not contain any attributes in the
                 // measure
                 continue;
-            else if (attributes_diff.size() == 0)
+            else if (attributes_diff.empty())
                 // the block contains all requested attributes in the
                 // measure
                 continue;
@@ -274,53 +268,59 @@ unordered_map<shared_ptr<const BlockMeta>, RawRequest> postRequests(
             // find all blocks from block_measures that contain the
             // missing attributes and then post requests to the target
             // blocks in order to read the missing attributes
-            auto target_blocks = filterBlocks(
-                block_measures, boundary_block_query, attributes_diff);
+            auto target_blocks =
+                filterBlocks(block_measures, boundary_block_query,
+                             attributes_diff, resource, b.get());
             postRequests(query, target_blocks, boundary_block_query,
                          attributes_diff, 1, requests);
         }
 
         if (requests.count(b) == 0)
-            requests[b] = {b, query};
+            requests[b] = {b, query, resource};
 
-        if (filter_rel == SET_RELATION::SUBSET ||
-            filter_rel == SET_RELATION::EQUAL)
+        if ((filter_rel == SET_RELATION::SUBSET ||
+             filter_rel == SET_RELATION::EQUAL) &&
+            residual_attributes.empty())
         {
             // the entire data block pass all predicates
             requests[b].passed_filter_attributes =
                 query_filter_attributes;
         }
-        else if (filter_rel == SET_RELATION::INTERSECT ||
-                 filter_rel == SET_RELATION::SUPERSET)
+        else
         {
             // post the missing filters if the block is not fully
-            // covered by the query predicates
+            // covered by the query predicates. The block boundary
+            // never covers a conjunct on several attributes
 
-            auto boundary_extra =
-                convergeBoundary(boundary_block, boundary_query);
             // the attributes that we should read and evaluate
             // predicates on
-            auto boundary_extra_attributes =
-                boundary_extra->getAttributes();
+            auto boundary_extra_attributes = residual_attributes;
+            if (filter_rel == SET_RELATION::INTERSECT ||
+                filter_rel == SET_RELATION::SUPERSET)
+                boundary_extra_attributes |=
+                    convergeBoundary(boundary_block, boundary_query,
+                                     resource)
+                        ->getAttributeSet();
 
             // only request attributes that are not in the data block
-            auto extra_attributes_not_in_block = set_difference(
-                boundary_extra_attributes, attributes_block);
-            if (extra_attributes_not_in_block.size() > 0)
+            auto extra_attributes_not_in_block =
+                boundary_extra_attributes - attributes_block;
+            if (!extra_attributes_not_in_block.empty())
             {
                 auto target_blocks =
                     filterBlocks(block_filters, boundary_block_query,
-                                 extra_attributes_not_in_block);
+                                 extra_attributes_not_in_block,
+                                 resource, b.get());
                 postRequests(query, target_blocks, boundary_block_query,
                              extra_attributes_not_in_block, 0,
                              requests);
             }
 
-            requests[b].passed_filter_attributes = set_difference(
-                query_filter_attributes, extra_attributes_not_in_block);
+            requests[b].passed_filter_attributes =
+                query_filter_attributes -
+                extra_attributes_not_in_block - residual_attributes;
             requests[b].extra_check_filter_attributes =
-                set_intersection(boundary_extra_attributes,
-                                 attributes_block);
+                boundary_extra_attributes & attributes_block;
         }
     }
 
@@ -334,16 +334,18 @@ unordered_map<shared_ptr<const BlockMeta>, RawRequest> postRequests(
             auto &request = it->second;
             auto boundary_extra_attributes =
                 convergeBoundary(request.block->getBoundary(),
-                                 boundary_query)
-                    ->getAttributes();
-            auto block_attributes =
-                request.block->getSchema()->getAttributeNames();
-            auto extra_attributes_not_in_block = set_difference(
-                boundary_extra_attributes, block_attributes);
-            request.passed_filter_attributes = set_difference(
-                query_filter_attributes, extra_attributes_not_in_block);
-            request.extra_check_filter_attributes = set_intersection(
-                boundary_extra_attributes, block_attributes);
+                                 boundary_query, resource)
+                    ->getAttributeSet() |
+                residual_attributes;
+            const auto &block_attributes =
+                request.block->getSchema()->getAttributeSet();
+            auto extra_attributes_not_in_block =
+                boundary_extra_attributes - block_attributes;
+            request.passed_filter_attributes =
+                query_filter_attributes -
+                extra_attributes_not_in_block - residual_attributes;
+            request.extra_check_filter_attributes =
+                boundary_extra_attributes & block_attributes;
         }
         it->second.finalize();
     }
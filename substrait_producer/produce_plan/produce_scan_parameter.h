@@ -1,35 +1,29 @@
 #pragma once
 #include "metadata/complex_boundary.h"
 #include "produce_plan/scan_parameter.h"
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
 
-template <typename T>
-unordered_set<T> set_difference(const unordered_set<T> &a,
-                                const unordered_set<T> &b)
-{
-    unordered_set<T> result;
-    for (auto it = a.begin(); it != a.end(); it++)
-        if (b.count(*it) == 0)
-            result.insert(*it);
-    return result;
-}
-
-template <typename T>
-unordered_set<T> set_intersection(const unordered_set<T> &a,
-                                  const unordered_set<T> &b)
-{
-    unordered_set<T> result;
-    for (auto it = a.begin(); it != a.end(); it++)
-        if (b.count(*it))
-            result.insert(*it);
-    return result;
-}
-
+/**
+ * @brief Produce the scan parameters of the late reconstruction by
+ * aggregation
+ *
+ * @param query
+ * @param table_schema
+ * @param partitions
+ * @param resource the memory resource of the parameters and the
+ * intermediate objects, usually the QueryArena of the query. The
+ * parameters must not outlive it
+ * @return the direct and the reconstruction parameters
+ */
 std::pair<vector<shared_ptr<const ScanParameter>>,
           vector<shared_ptr<const ScanParameter>>>
 produceScanParametersAggregation(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const PartitionMeta>> &partitions);
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    std::pmr::memory_resource *resource);
 
 void produceScanParameterJoin(
     shared_ptr<const Query> query,
@@ -38,14 +32,30 @@ void produceScanParameterJoin(
     vector<shared_ptr<const ScanParameter>> &direct_params,
     vector<shared_ptr<const ScanParameter>> &recons_filter_params,
     vector<vector<shared_ptr<const ScanParameter>>>
-        &recons_measure_params);
+        &recons_measure_params,
+    std::pmr::memory_resource *resource);
 
 namespace scan_parameter_internal
 {
-unordered_set<shared_ptr<const BlockMeta>> filterBlocks(
-    const unordered_set<shared_ptr<const BlockMeta>> &blocks,
-    shared_ptr<const Boundary> filter,
-    const unordered_set<string> &attributes);
+typedef std::pmr::unordered_set<shared_ptr<const BlockMeta>> BlockSet;
+
+/**
+ * @brief Get the blocks that are not disjoint with the filter and the
+ * attributes
+ *
+ * @param blocks
+ * @param filter
+ * @param attributes
+ * @param resource the memory resource of the result
+ * @param source if set, also skip the blocks that have no tuple in
+ * common with the source block, see BlockMeta::tidDisjoint
+ * @return BlockSet
+ */
+BlockSet filterBlocks(const BlockSet &blocks,
+                      shared_ptr<const ComplexBoundary> filter,
+                      const AttributeSet &attributes,
+                      std::pmr::memory_resource *resource,
+                      const BlockMeta *source = nullptr);
 /**
  * @brief Find the extra filter to converge the source filter to be the
  * subset of the target filter. The source filter and the target filter
@@ -53,53 +63,68 @@ unordered_set<shared_ptr<const BlockMeta>> filterBlocks(
  *
  * @param source the source filter
  * @param target the target filter
+ * @param resource the memory resource of the result
  * @return shared_ptr<Boundary> the extra filter that should be added to
  * the source filter to converge.
  */
 shared_ptr<Boundary> convergeBoundary(
     shared_ptr<const Boundary> source,
-    shared_ptr<const Boundary> target);
+    shared_ptr<const Boundary> target,
+    std::pmr::memory_resource *resource);
 
 shared_ptr<ComplexBoundary> convergeBoundary(
     shared_ptr<const Boundary> source,
-    shared_ptr<const ComplexBoundary> target);
+    shared_ptr<const ComplexBoundary> target,
+    std::pmr::memory_resource *resource);
 
 struct RawRequest
 {
     shared_ptr<const BlockMeta> block;
     shared_ptr<const Query> query;
+    // the memory resource of the filters the request intersects
+    std::pmr::memory_resource *resource =
+        std::pmr::get_default_resource();
 
     // the attributes that are requested by other blocks to evaluate
     // predicates. An empty set means that non other blocks requests to
     // read data from this block.
-    unordered_set<string> filter_requested_attributes;
+    AttributeSet filter_requested_attributes;
     // the attributes that are requested by other blocks to evaluate
     // aggregation measures. An empty set means that non other blocks
     // requests to read data from this block.
-    unordered_set<string> measure_requested_attributes;
+    AttributeSet measure_requested_attributes;
     // The filters requested by other blocks to evaluate predicates. An
     // empty vector means that non other blocks requests to read data
     // from this block.
-    vector<shared_ptr<const Boundary>> filter_requested_filters;
+    vector<shared_ptr<const ComplexBoundary>> filter_requested_filters;
     // The filters requested by other blocks to evaluate aggregation
     // measures. An empty vector means that non other blocks requests to
     // read data from this block.
-    vector<shared_ptr<const Boundary>> measure_requested_filters;
+    vector<shared_ptr<const ComplexBoundary>> measure_requested_filters;
 
     // The attributes that the passed query predicates refer to. The
     // data block can satisfy a predicate in two cases: the boundary of
     // the block is equal to or the subset of the query on that
     // predicate; Or the data block contains the attribute referred by
     // the predicate.
-    unordered_set<string> passed_filter_attributes;
+    AttributeSet passed_filter_attributes;
     // The attributes in the second case. These attributes will be read
     // in the both the direct path and reconstruction path
-    unordered_set<string> extra_check_filter_attributes;
+    AttributeSet extra_check_filter_attributes;
 
     string toString() const;
-    RawRequest *clone() const;
-    void add_attributes(unordered_set<string> &target,
-                        const unordered_set<string> &attributes);
+    /**
+     * @brief Clone the request. The requested filters are immutable and
+     * shared with the clone
+     *
+     * @param resource the memory resource of the clone and of the
+     * filters it intersects
+     * @return shared_ptr<RawRequest>
+     */
+    shared_ptr<RawRequest>
+    clone(std::pmr::memory_resource *resource) const;
+    void add_attributes(AttributeSet &target,
+                        const AttributeSet &attributes);
     /**
      * @brief Add request
      *
@@ -108,9 +133,9 @@ struct RawRequest
      * @param type 0 is to request for predicate. 1 is to request for
      * aggregation measures
      */
-    void request(const unordered_set<string> &attributes,
-                 shared_ptr<const Boundary> filter, int type);
-    void intersectFilter(const Boundary &b);
+    void request(const AttributeSet &attributes,
+                 shared_ptr<const ComplexBoundary> filter, int type);
+    void intersectFilter(const ComplexBoundary &b);
     /**
      * @brief Remove the attributes in requested_attributes and
      * extra_check_filter_attributes that will be read in future but not
@@ -123,27 +148,40 @@ struct RawRequest
 struct RawScanParameter
 {
     // the attributes reading from the file
-    unordered_set<string> read_attributes;
+    AttributeSet read_attributes;
 
     // the projected attributes after reading but before union
-    unordered_set<string> project_attributes;
+    AttributeSet project_attributes;
 
     // the filters that evaluate right after scanning the data
     shared_ptr<ComplexBoundary> filters;
     // shared_ptr<Boundary> filters;
 
-    unordered_set<string> passed_attributes;
+    AttributeSet passed_attributes;
 
     // the measures that are directly evaluated
-    shared_ptr<boost::dynamic_bitset<>> direct_measures;
+    shared_ptr<Bitmap> direct_measures;
 
+    /**
+     * @brief Produce the scan parameter of the block
+     *
+     * @param table_schema
+     * @param sub_filter_attributes the attribute offset of each
+     * conjunct in the query filter, see QueryTemplate
+     * @param block
+     * @return ScanParameter
+     */
     ScanParameter produceScanParameter(
         shared_ptr<const Schema> table_schema,
-        const vector<shared_ptr<const FunctionExpression>>
-            &sub_filters_in_query,
+        const vector<int> &sub_filter_attributes,
         shared_ptr<const BlockMeta> block) const;
 };
 
+// the request of each block. The map and its requests share one memory
+// resource
+typedef std::pmr::unordered_map<shared_ptr<const BlockMeta>, RawRequest>
+    RequestMap;
+
 /**
  * @brief add requests to blocks
  *
@@ -155,15 +193,24 @@ struct RawScanParameter
  * request is for aggregation measures
  * @param requests
  */
-void postRequests(
-    shared_ptr<const Query> query,
-    const unordered_set<shared_ptr<const BlockMeta>> &target_blocks,
-    shared_ptr<const Boundary> filter,
-    const unordered_set<string> &attributes, int request_type,
-    unordered_map<shared_ptr<const BlockMeta>, RawRequest> &requests);
+void postRequests(shared_ptr<const Query> query,
+                  const BlockSet &target_blocks,
+                  shared_ptr<const ComplexBoundary> filter,
+                  const AttributeSet &attributes, int request_type,
+                  RequestMap &requests);
 
-unordered_map<shared_ptr<const BlockMeta>, RawRequest> postRequests(
-    shared_ptr<const Query> query,
-    const unordered_set<shared_ptr<const BlockMeta>> &block_measures,
-    const unordered_set<shared_ptr<const BlockMeta>> &block_filters);
+/**
+ * @brief Compute the requests of the blocks of a query
+ *
+ * @param query
+ * @param block_measures the blocks that overlap with the measures
+ * @param block_filters the blocks that overlap with the predicates
+ * @param resource the memory resource of the requests and their
+ * filters
+ * @return RequestMap
+ */
+RequestMap postRequests(shared_ptr<const Query> query,
+                        const BlockSet &block_measures,
+                        const BlockSet &block_filters,
+                        std::pmr::memory_resource *resource);
 }; // namespace scan_parameter_internal
\ No newline at end of file
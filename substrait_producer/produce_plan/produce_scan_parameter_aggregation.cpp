@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "metadata/boundary.h"
 #include "produce_plan/produce_scan_parameter.h"
 
@@ -12,19 +13,19 @@ RawScanParameter produceDirect(
     RawScanParameter p;
     auto query = finalized_request.query;
     auto block = finalized_request.block;
+    auto resource = finalized_request.resource;
 
     int measure_num = query->numOfMeasures();
-    p.direct_measures = make_shared<boost::dynamic_bitset<>>();
+    p.direct_measures = makeArenaShared<Bitmap>(resource);
     p.direct_measures->resize(measure_num, false);
 
     p.read_attributes = finalized_request.extra_check_filter_attributes;
     p.passed_attributes = finalized_request.passed_filter_attributes;
-    if (p.passed_attributes !=
-        query->getFilterBoundary()->getAttributes())
+    if (p.passed_attributes != query->attributesInFilter())
         throw Exception(
             "produceDirect: the block must pass all query predicates");
 
-    unordered_set<string> reconstruct_attributes;
+    AttributeSet reconstruct_attributes;
     bool reconstruct_all_tuples = false;
     if (reconstruct_scan_parameter)
     {
@@ -38,31 +39,29 @@ RawScanParameter produceDirect(
         auto relationship =
             reconstruct_scan_parameter->filters->relationship(
                 query->getFilterBoundary()->intersect(
-                    *block->getBoundary()));
+                    *block->getBoundary(), resource));
         if (relationship == SET_RELATION::EQUAL ||
             relationship == SET_RELATION::SUPERSET)
             reconstruct_all_tuples = true;
     }
 
-    auto block_attributes = block->getSchema()->getAttributeNames();
+    const auto &block_attributes =
+        block->getSchema()->getAttributeSet();
     for (int i = 0; i < measure_num; i++)
     {
-        auto measure_attributes = query->attributesInMeasure(i);
-        if (set_difference(*measure_attributes, block_attributes)
-                .size() != 0)
+        const auto &measure_attributes = query->attributesInMeasure(i);
+        if (!measure_attributes.isSubsetOf(block_attributes))
         {
             // the block does not contain all attributes in the measure.
             // In this case, the attributes that are both in the block
             // and the measure must have been requested
-            auto t1 =
-                set_intersection(*measure_attributes, block_attributes);
-            auto t2 = set_intersection(*measure_attributes,
-                                       reconstruct_attributes);
+            auto t1 = measure_attributes & block_attributes;
+            auto t2 = measure_attributes & reconstruct_attributes;
             if (t1 != t2)
                 throw Exception("produceDirect: attributes in a "
                                 "partial measure are not requested.");
 
-            if (t1.size() != 0 && reconstruct_all_tuples == false)
+            if (!t1.empty() && reconstruct_all_tuples == false)
                 throw Exception("productDirect: tuples in a partial "
                                 "measure are not requested");
             continue;
@@ -72,8 +71,7 @@ RawScanParameter produceDirect(
         // measure if the reconstruction processes all attributes in the
         // measure and all tuples in the block.
         bool contain_attributes =
-            set_difference(*measure_attributes, reconstruct_attributes)
-                .size() == 0;
+            measure_attributes.isSubsetOf(reconstruct_attributes);
         if (contain_attributes && reconstruct_all_tuples)
             continue;
 
@@ -81,16 +79,12 @@ RawScanParameter produceDirect(
         // attributes in the measure. Hence, we evaluate the measure in
         // the direct path.
         p.direct_measures->set(i);
-        p.read_attributes.insert(measure_attributes->begin(),
-                                 measure_attributes->end());
-        // set_union(p.read_attributes, *measure_attributes);
-        p.project_attributes.insert(measure_attributes->begin(),
-                                    measure_attributes->end());
-        // set_union(p.project_attributes, *measure_attributes);
+        p.read_attributes |= measure_attributes;
+        p.project_attributes |= measure_attributes;
     }
 
-    p.filters =
-        make_shared<ComplexBoundary>(*query->getFilterBoundary());
+    p.filters = makeArenaShared<ComplexBoundary>(
+        resource, *query->getFilterBoundary(), resource);
     p.filters->keepAttributes(
         finalized_request.extra_check_filter_attributes);
 
@@ -104,29 +98,28 @@ RawScanParameter produceReconstruct(const RawRequest &finalized_request)
     // read the requested attributes and attributes for evaluating
     // predicates
     p.project_attributes =
-        finalized_request.filter_requested_attributes;
-    p.project_attributes.insert(
-        finalized_request.measure_requested_attributes.begin(),
-        finalized_request.measure_requested_attributes.end());
-    p.project_attributes.insert(tuple_id_name);
+        finalized_request.filter_requested_attributes |
+        finalized_request.measure_requested_attributes;
+    p.project_attributes.set(
+        finalized_request.query->getTableSchema()->getOffset(
+            tuple_id_name));
 
-    p.read_attributes = p.project_attributes;
-    p.read_attributes.insert(
-        finalized_request.extra_check_filter_attributes.begin(),
-        finalized_request.extra_check_filter_attributes.end());
-    // set_union(p.project_attributes,
-    //           finalized_request.extra_check_filter_attributes);
+    p.read_attributes = p.project_attributes |
+                        finalized_request.extra_check_filter_attributes;
 
     p.passed_attributes = finalized_request.passed_filter_attributes;
     auto filters = finalized_request.filter_requested_filters;
     filters.insert(filters.end(),
                    finalized_request.measure_requested_filters.begin(),
                    finalized_request.measure_requested_filters.end());
-    p.filters = ComplexBoundary::makeComplexBoundary(filters, 5);
+    p.filters = ComplexBoundary::makeComplexBoundary(
+        filters, ComplexBoundary::kMaxIntervalsPerAttribute,
+        finalized_request.resource);
     p.filters->keepAttributes(p.read_attributes);
 
     auto block_boundary = finalized_request.block->getBoundary();
-    p.filters = convergeBoundary(block_boundary, p.filters);
+    p.filters = convergeBoundary(block_boundary, p.filters,
+                                 finalized_request.resource);
 
     return p;
 }
@@ -138,9 +131,10 @@ std::pair<vector<shared_ptr<const ScanParameter>>,
 produceScanParametersAggregation(
     shared_ptr<const Query> query,
     shared_ptr<const Schema> table_schema,
-    const vector<shared_ptr<const PartitionMeta>> &partitions)
+    const vector<shared_ptr<const PartitionMeta>> &partitions,
+    std::pmr::memory_resource *resource)
 {
-    unordered_set<shared_ptr<const BlockMeta>> all_blocks;
+    scan_parameter_internal::BlockSet all_blocks(resource);
     for (auto p : partitions)
     {
         auto b = p->getBlocks();
@@ -150,26 +144,21 @@ produceScanParametersAggregation(
     // get blocks that overlap with the measures or the query predicate
     auto boundary_query = query->getFilterBoundary();
     auto measure_num = query->numOfMeasures();
-    unordered_set<string> attributes_all_measures;
-    for (int i = 0; i < measure_num; i++)
-    {
-        auto a = query->attributesInMeasure(i);
-        attributes_all_measures.insert(a->begin(), a->end());
-    }
-    auto attributes_query_filters = boundary_query->getAttributes();
+    const auto &attributes_all_measures = query->attributesInMeasures();
+    const auto &attributes_query_filters = query->attributesInFilter();
 
     auto block_measures = scan_parameter_internal::filterBlocks(
-        all_blocks, boundary_query, attributes_all_measures);
+        all_blocks, boundary_query, attributes_all_measures, resource);
     auto block_filters = scan_parameter_internal::filterBlocks(
-        all_blocks, boundary_query, attributes_query_filters);
+        all_blocks, boundary_query, attributes_query_filters, resource);
 
     // compute the requests to each block
     auto reconstruct_requests = scan_parameter_internal::postRequests(
-        query, block_measures, block_filters);
+        query, block_measures, block_filters, resource);
 
-    unordered_map<shared_ptr<const BlockMeta>,
-                  scan_parameter_internal::RawScanParameter>
-        direct_parameters, reconstruct_paramters;
+    std::pmr::unordered_map<shared_ptr<const BlockMeta>,
+                            scan_parameter_internal::RawScanParameter>
+        direct_parameters(resource), reconstruct_paramters(resource);
 
     for (auto b : block_measures)
     {
@@ -180,15 +169,14 @@ produceScanParametersAggregation(
                 "for a measure block");
 
         auto &request = it->second;
-        if (request.passed_filter_attributes.size() ==
-            attributes_query_filters.size())
+        if (request.passed_filter_attributes.count() ==
+            attributes_query_filters.count())
         {
             // the block can evaluate all predicates by block bounary
             // and the attribtues in the block, without referring to
             // other blocks
-            if (request.filter_requested_attributes.size() +
-                    request.measure_requested_attributes.size() !=
-                0)
+            if (!request.filter_requested_attributes.empty() ||
+                !request.measure_requested_attributes.empty())
                 // the block is requested by other blocks.
                 reconstruct_paramters[b] = scan_parameter_internal::
                     aggregate::produceReconstruct(request);
@@ -212,19 +200,18 @@ produceScanParametersAggregation(
         }
         else
         {
-            // The block cannot be directly evaluated.
-            unordered_set<string> measure_attributes;
-            for (int i = 0; i < measure_num; i++)
-                measure_attributes.insert(
-                    query->attributesInMeasure(i)->begin(),
-                    query->attributesInMeasure(i)->end());
-            request.request(measure_attributes, boundary_query, 0);
+            // The block cannot be directly evaluated. The attributes
+            // of the conjuncts on several attributes are projected for
+            // the residual filter
+            request.request(attributes_all_measures |
+                                query->attributesInResidualFilters(),
+                            boundary_query, 0);
             request.finalize();
             reconstruct_paramters[b] =
                 scan_parameter_internal::aggregate::produceReconstruct(
                     request);
             reconstruct_paramters[b].direct_measures =
-                make_shared<boost::dynamic_bitset<>>();
+                makeArenaShared<Bitmap>(resource);
             reconstruct_paramters[b].direct_measures->resize(
                 measure_num, false);
         }
@@ -240,26 +227,27 @@ produceScanParametersAggregation(
             auto param =
                 scan_parameter_internal::aggregate::produceReconstruct(
                     it->second);
-            param.direct_measures =
-                make_shared<boost::dynamic_bitset<>>();
+            param.direct_measures = makeArenaShared<Bitmap>(resource);
             param.direct_measures->resize(measure_num, false);
             reconstruct_paramters[it->first] = param;
         }
     }
 
-    auto sub_filter_query =
-        query->getFilter()->getSubExpressions("and");
+    const auto &sub_filter_query =
+        query->getTemplate()->subFilterAttributes();
     vector<shared_ptr<const ScanParameter>> reconstruct_result,
         direct_result;
     for (auto it = reconstruct_paramters.begin();
          it != reconstruct_paramters.end(); it++)
         reconstruct_result.push_back(
-            make_shared<ScanParameter>(it->second.produceScanParameter(
-                table_schema, sub_filter_query, it->first)));
+            makeArenaShared<ScanParameter>(
+                resource, it->second.produceScanParameter(
+                    table_schema, sub_filter_query, it->first)));
     for (auto it = direct_parameters.begin();
          it != direct_parameters.end(); it++)
         direct_result.push_back(
-            make_shared<ScanParameter>(it->second.produceScanParameter(
-                table_schema, sub_filter_query, it->first)));
+            makeArenaShared<ScanParameter>(
+                resource, it->second.produceScanParameter(
+                    table_schema, sub_filter_query, it->first)));
     return make_pair(direct_result, reconstruct_result);
 }
\ No newline at end of file
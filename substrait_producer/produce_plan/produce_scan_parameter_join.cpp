@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "metadata/boundary.h"
 #include "produce_plan/produce_scan_parameter.h"
 
@@ -8,29 +9,30 @@ namespace join
 RawScanParameter produceReconstructFilter(const RawRequest &request)
 {
     RawScanParameter p;
-    if (request.filter_requested_attributes.size() == 0)
+    if (request.filter_requested_attributes.empty())
         throw Exception("produceReconstructFilter: invalid "
                         "filter_requested_attributes\n" +
                         request.toString());
     // the project attributes actually only need the tuple id and
     // passed_preds bitmap
-    p.project_attributes.insert(tuple_id_name);
+    int tid = request.query->getTableSchema()->getOffset(tuple_id_name);
+    p.project_attributes.set(tid);
 
-    p.read_attributes = request.filter_requested_attributes;
-    p.read_attributes.insert(tuple_id_name);
-    p.read_attributes.insert(
-        request.extra_check_filter_attributes.begin(),
-        request.extra_check_filter_attributes.end());
+    p.read_attributes = request.filter_requested_attributes |
+                        request.extra_check_filter_attributes;
+    p.read_attributes.set(tid);
 
     p.passed_attributes = request.passed_filter_attributes;
 
     p.filters = ComplexBoundary::makeComplexBoundary(
-        request.filter_requested_filters, 5);
+        request.filter_requested_filters,
+        ComplexBoundary::kMaxIntervalsPerAttribute, request.resource);
     p.filters->keepAttributes(p.read_attributes);
     auto block_boundary = request.block->getBoundary();
-    p.filters = convergeBoundary(block_boundary, p.filters);
+    p.filters =
+        convergeBoundary(block_boundary, p.filters, request.resource);
 
-    p.direct_measures = make_shared<boost::dynamic_bitset<>>();
+    p.direct_measures = makeArenaShared<Bitmap>(request.resource);
     p.direct_measures->resize(request.query->numOfMeasures(), false);
 
     return p;
@@ -40,20 +42,21 @@ RawScanParameter produceReconstructMeasure(const RawRequest &request)
 {
     RawScanParameter p;
     p.project_attributes = request.measure_requested_attributes;
-    p.project_attributes.insert(tuple_id_name);
+    p.project_attributes.set(
+        request.query->getTableSchema()->getOffset(tuple_id_name));
 
-    p.read_attributes = p.project_attributes;
-    p.read_attributes.insert(
-        request.extra_check_filter_attributes.begin(),
-        request.extra_check_filter_attributes.end());
+    p.read_attributes =
+        p.project_attributes | request.extra_check_filter_attributes;
 
     p.passed_attributes = request.passed_filter_attributes;
     p.filters = ComplexBoundary::makeComplexBoundary(
-        request.measure_requested_filters, 5);
+        request.measure_requested_filters,
+        ComplexBoundary::kMaxIntervalsPerAttribute, request.resource);
     p.filters->keepAttributes(p.read_attributes);
 
     auto block_boundary = request.block->getBoundary();
-    p.filters = convergeBoundary(block_boundary, p.filters);
+    p.filters =
+        convergeBoundary(block_boundary, p.filters, request.resource);
 
     return p;
 }
@@ -65,19 +68,19 @@ RawScanParameter produceDirect(
     RawScanParameter p;
     auto query = request.query;
     auto block = request.block;
+    auto resource = request.resource;
 
     int measure_num = query->numOfMeasures();
-    p.direct_measures = make_shared<boost::dynamic_bitset<>>();
+    p.direct_measures = makeArenaShared<Bitmap>(resource);
     p.direct_measures->resize(measure_num, false);
 
     p.read_attributes = request.extra_check_filter_attributes;
     p.passed_attributes = request.passed_filter_attributes;
-    if (p.passed_attributes !=
-        query->getFilterBoundary()->getAttributes())
+    if (p.passed_attributes != query->attributesInFilter())
         throw Exception(
             "produceDirect: the block must pass all query predicates");
 
-    unordered_set<string> reconstruct_attributes;
+    AttributeSet reconstruct_attributes;
     if (recons_measure_param)
     {
         reconstruct_attributes =
@@ -85,41 +88,35 @@ RawScanParameter produceDirect(
         SET_RELATION relationship =
             recons_measure_param->filters->relationship(
                 query->getFilterBoundary()->intersect(
-                    *block->getBoundary()));
+                    *block->getBoundary(), resource));
         if (relationship != SET_RELATION::EQUAL &&
             relationship != SET_RELATION::SUPERSET)
             throw Exception("produceDirect: expect to reconstruct all "
                             "tuples in the block");
     }
 
-    unordered_set<string> block_attributes =
-        block->getSchema()->getAttributeNames();
+    const auto &block_attributes =
+        block->getSchema()->getAttributeSet();
     for (int i = 0; i < measure_num; i++)
     {
-        auto measure_attributes = query->attributesInMeasure(i);
-        unordered_set<string> t1 =
-            set_intersection(*measure_attributes, block_attributes);
+        const auto &measure_attributes = query->attributesInMeasure(i);
         // skip the measure if the block does not contain all attributes
         // in the measure
-        if (t1 != *measure_attributes)
+        if (!measure_attributes.isSubsetOf(block_attributes))
             continue;
 
-        unordered_set<string> t2 = set_intersection(
-            *measure_attributes, reconstruct_attributes);
         // skip the measure if all requested attributes are
         // reconstructed
-        if (t2 == *measure_attributes)
+        if (measure_attributes.isSubsetOf(reconstruct_attributes))
             continue;
 
         p.direct_measures->set(i);
-        p.read_attributes.insert(measure_attributes->begin(),
-                                 measure_attributes->end());
-        p.project_attributes.insert(measure_attributes->begin(),
-                                    measure_attributes->end());
+        p.read_attributes |= measure_attributes;
+        p.project_attributes |= measure_attributes;
     }
 
-    p.filters =
-        make_shared<ComplexBoundary>(*query->getFilterBoundary());
+    p.filters = makeArenaShared<ComplexBoundary>(
+        resource, *query->getFilterBoundary(), resource);
     p.filters->keepAttributes(request.extra_check_filter_attributes);
 
     return p;
@@ -132,19 +129,19 @@ struct Node
 };
 
 unordered_map<shared_ptr<const BlockMeta>, shared_ptr<Node>> buildGraph(
-    shared_ptr<const Query> query,
-    const unordered_map<shared_ptr<const BlockMeta>, RawRequest>
-        &requests)
+    shared_ptr<const Query> query, const RequestMap &requests)
 {
     unordered_map<shared_ptr<const BlockMeta>, shared_ptr<Node>> graph;
     auto query_boundary = query->getFilterBoundary();
-    unordered_set<shared_ptr<const BlockMeta>> all_blocks;
+    auto resource = requests.get_allocator().resource();
+    BlockSet all_blocks(resource);
     for (auto it = requests.begin(); it != requests.end(); it++)
         all_blocks.insert(it->first);
     for (int i = 0; i < query->numOfMeasures(); i++)
     {
-        auto blocks_in_measure = filterBlocks(
-            all_blocks, query_boundary, *query->attributesInMeasure(i));
+        auto blocks_in_measure =
+            filterBlocks(all_blocks, query_boundary,
+                         query->attributesInMeasure(i), resource);
         for (auto b : blocks_in_measure)
             if (graph.count(b) == 0)
             {
@@ -156,7 +153,7 @@ unordered_map<shared_ptr<const BlockMeta>, shared_ptr<Node>> buildGraph(
         for (auto b1 : blocks_in_measure)
             for (auto b2 : blocks_in_measure)
             {
-                if (b1 == b2)
+                if (b1 == b2 || b1->tidDisjoint(*b2))
                     continue;
                 const auto &b1_boundary = *b1->getBoundary();
                 const auto &b2_boundary = *b2->getBoundary();
@@ -214,9 +211,10 @@ void produceScanParameterJoin(
     vector<shared_ptr<const ScanParameter>> &direct_params,
     vector<shared_ptr<const ScanParameter>> &recons_filter_params,
     vector<vector<shared_ptr<const ScanParameter>>>
-        &recons_measure_params)
+        &recons_measure_params,
+    std::pmr::memory_resource *resource)
 {
-    unordered_set<shared_ptr<const BlockMeta>> all_blocks;
+    scan_parameter_internal::BlockSet all_blocks(resource);
     for (auto p : partitions)
     {
         auto b = p->getBlocks();
@@ -226,29 +224,25 @@ void produceScanParameterJoin(
     // get blocks that overlap with the measures or the query predicate
     auto boundary_query = query->getFilterBoundary();
     auto measure_num = query->numOfMeasures();
-    unordered_set<string> attributes_all_measures;
-    for (int i = 0; i < measure_num; i++)
-    {
-        auto a = query->attributesInMeasure(i);
-        attributes_all_measures.insert(a->begin(), a->end());
-    }
-    auto attributes_query_filters = boundary_query->getAttributes();
+    const auto &attributes_all_measures = query->attributesInMeasures();
+    const auto &attributes_query_filters = query->attributesInFilter();
 
     auto block_measures = scan_parameter_internal::filterBlocks(
-        all_blocks, boundary_query, attributes_all_measures);
+        all_blocks, boundary_query, attributes_all_measures, resource);
     auto block_filters = scan_parameter_internal::filterBlocks(
-        all_blocks, boundary_query, attributes_query_filters);
+        all_blocks, boundary_query, attributes_query_filters, resource);
 
     // compute the requests to each block
     auto reconstruct_requests = scan_parameter_internal::postRequests(
-        query, block_measures, block_filters);
+        query, block_measures, block_filters, resource);
 
-    unordered_map<shared_ptr<const BlockMeta>,
-                  scan_parameter_internal::RawScanParameter>
-        map_filter_params, map_measure_params, map_direct_params;
+    std::pmr::unordered_map<shared_ptr<const BlockMeta>,
+                            scan_parameter_internal::RawScanParameter>
+        map_filter_params(resource), map_measure_params(resource),
+        map_direct_params(resource);
     for (const auto &request : reconstruct_requests)
     {
-        if (request.second.filter_requested_attributes.size() > 0)
+        if (!request.second.filter_requested_attributes.empty())
         {
             map_filter_params[request.first] =
                 scan_parameter_internal::join::produceReconstructFilter(
@@ -295,18 +289,14 @@ void produceScanParameterJoin(
         }
         else
         {
-            unordered_set<string> measure_attributes;
-            for (int i = 0; i < measure_num; i++)
-                measure_attributes.insert(
-                    query->attributesInMeasure(i)->begin(),
-                    query->attributesInMeasure(i)->end());
             auto t_request = request;
-            t_request.request(measure_attributes, boundary_query, 1);
+            t_request.request(attributes_all_measures, boundary_query,
+                              1);
             t_request.finalize();
             map_measure_params[b] = scan_parameter_internal::join::
                 produceReconstructMeasure(t_request);
             map_measure_params[b].direct_measures =
-                make_shared<boost::dynamic_bitset<>>();
+                makeArenaShared<Bitmap>(resource);
             map_measure_params[b].direct_measures->resize(measure_num,
                                                           false);
         }
@@ -318,21 +308,23 @@ void produceScanParameterJoin(
     auto sub_graphs =
         scan_parameter_internal::join::partitionGraph(graph);
 
-    auto query_sub_filters =
-        query->getFilter()->getSubExpressions("and");
+    const auto &query_sub_filters =
+        query->getTemplate()->subFilterAttributes();
     direct_params.clear();
     recons_filter_params.clear();
     recons_measure_params.clear();
     for (auto it = map_direct_params.begin();
          it != map_direct_params.end(); it++)
         direct_params.push_back(
-            make_shared<ScanParameter>(it->second.produceScanParameter(
-                table_schema, query_sub_filters, it->first)));
+            makeArenaShared<ScanParameter>(
+                resource, it->second.produceScanParameter(
+                    table_schema, query_sub_filters, it->first)));
     for (auto it = map_filter_params.begin();
          it != map_filter_params.end(); it++)
         recons_filter_params.push_back(
-            make_shared<ScanParameter>(it->second.produceScanParameter(
-                table_schema, query_sub_filters, it->first)));
+            makeArenaShared<ScanParameter>(
+                resource, it->second.produceScanParameter(
+                    table_schema, query_sub_filters, it->first)));
 
     for (const auto &sub : sub_graphs)
     {
@@ -344,8 +336,8 @@ void produceScanParameterJoin(
         {
             auto it = map_measure_params.find(p.first);
             if (it != map_measure_params.end())
-                v.push_back(make_shared<ScanParameter>(
-                    it->second.produceScanParameter(
+                v.push_back(makeArenaShared<ScanParameter>(
+                    resource, it->second.produceScanParameter(
                         table_schema, query_sub_filters, p.first)));
         }
         if (v.size() == 0)
@@ -1,9 +1,10 @@
 #pragma once
 
+#include "data_type/bitmap.h"
 #include "metadata/complex_boundary.h"
 #include "metadata/expression.h"
 #include "metadata/query.h"
-#include <boost/dynamic_bitset.hpp>
+#include <boost/functional/hash.hpp>
 
 /**
  * Define the parameter to read a block for tuple reconstruction and
@@ -16,22 +17,22 @@ struct ScanParameter
     shared_ptr<const ComplexBoundary> filter_boundary = nullptr;
     // shared_ptr<const Boundary> filter_boundary = nullptr;
 
-    // The attributes to read. Each bit is an attribute in the table
-    // schema
-    boost::dynamic_bitset<> read_attributes;
+    // The attributes to read, sized to the table schema
+    AttributeSet read_attributes;
 
-    // The projected attributes after reading but before union
-    boost::dynamic_bitset<> project_attributes;
+    // The projected attributes after reading but before union, sized
+    // to the table schema
+    AttributeSet project_attributes;
 
     // The measures that are directly evaluated w/o reconstruction.
     // Should have the same value for reconstruction and direct
     // evaluation
-    boost::dynamic_bitset<> direct_meassures;
+    Bitmap direct_meassures;
     // The measures that contain any read attributes; (NOT USED)
-    boost::dynamic_bitset<> possible_measures;
+    Bitmap possible_measures;
     // The predicates that will be passed after filtering but before
     // reconstruction. Ignored in the direct_evaluation path
-    boost::dynamic_bitset<> passed_preds;
+    Bitmap passed_preds;
 
     // The path of the parquet file to read. One file is an irregular
     // partition
@@ -73,6 +74,20 @@ struct ScanParameter
                this->passed_preds == other->passed_preds;
     }
 
+    // the hash of the fields compared by equal
+    size_t hash() const
+    {
+        size_t seed = 0;
+        boost::hash_combine(seed, file_path);
+        boost::hash_combine(seed, filter ? filter->getHash() : 0);
+        boost::hash_combine(seed, read_attributes);
+        boost::hash_combine(seed, project_attributes);
+        boost::hash_combine(seed, direct_meassures);
+        boost::hash_combine(seed, possible_measures);
+        boost::hash_combine(seed, passed_preds);
+        return seed;
+    }
+
     string toString() const
     {
         string result =
@@ -86,28 +101,14 @@ struct ScanParameter
         if (this->filter)
             result += "\t filter: " + this->filter->toString() + "\n";
 
-        auto bitset_to_string =
-            [&](const boost::dynamic_bitset<> &bitset) -> string {
-            size_t size = bitset.size();
-            char c_str[size + 1] = {0};
-            // memset(c_str, '0', size);
-            for (size_t i = 0; i < size; i++)
-                if (bitset.test(i))
-                    c_str[i] = '1';
-                else
-                    c_str[i] = '0';
-            return string(c_str);
-        };
-
         result += "\t read_attributes: " +
-                  bitset_to_string(this->read_attributes) + "\n";
+                  this->read_attributes.toString() + "\n";
         result += "\t project_attributes: " +
-                  bitset_to_string(this->project_attributes) + "\n";
+                  this->project_attributes.toString() + "\n";
         result += "\t direct_measures: " +
-                  bitset_to_string(this->direct_meassures) + "\n";
+                  this->direct_meassures.toString() + "\n";
         result +=
-            "\t passed_preds: " + bitset_to_string(this->passed_preds) +
-            "\n";
+            "\t passed_preds: " + this->passed_preds.toString() + "\n";
         result += "}";
         return result;
     }
@@ -0,0 +1,227 @@
+#include "protobuf_io.h"
+#include "exceptions.h"
+#include <climits>
+#include <fcntl.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/delimited_message_util.h>
+#include <google/protobuf/util/json_util.h>
+#include <google/protobuf/util/type_resolver_util.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+// open a file for writing, truncated. The stream closes the file
+unique_ptr<google::protobuf::io::FileOutputStream> openOutput(
+    const string &path, const string &caller)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw Exception(caller + ": cannot open " + path);
+    auto stream =
+        make_unique<google::protobuf::io::FileOutputStream>(fd);
+    stream->SetCloseOnDelete(true);
+    return stream;
+}
+
+// flush the stream and close the file
+void closeOutput(google::protobuf::io::FileOutputStream *stream,
+                 const string &path, const string &caller)
+{
+    bool ok = stream->Close();
+    // the file is closed even if the flush failed
+    stream->SetCloseOnDelete(false);
+    if (!ok)
+        throw Exception(caller + ": cannot write to " + path);
+}
+} // namespace
+
+MappedFile::MappedFile(const string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Exception("MappedFile: cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw Exception("MappedFile: cannot stat " + path);
+    }
+    length = st.st_size;
+    if (length > 0)
+    {
+        void *mapped =
+            mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            throw Exception("MappedFile: cannot map " + path);
+        }
+        bytes = static_cast<const char *>(mapped);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        munmap(const_cast<char *>(bytes), length);
+}
+
+void readMessage(google::protobuf::MessageLite *message,
+                 const string &path)
+{
+    MappedFile file(path);
+    if (file.size() > INT_MAX)
+        throw Exception("readMessage: " + path +
+                        " exceeds the size limit of a message");
+    google::protobuf::io::ArrayInputStream stream(file.data(),
+                                                  file.size());
+    if (!message->ParseFromZeroCopyStream(&stream))
+        throw Exception("readMessage: cannot parse " + path);
+}
+
+void writeMessage(const google::protobuf::MessageLite &message,
+                  const string &path)
+{
+    auto stream = openOutput(path, "writeMessage");
+    if (!message.SerializeToZeroCopyStream(stream.get()))
+        throw Exception("writeMessage: cannot write to " + path);
+    closeOutput(stream.get(), path, "writeMessage");
+}
+
+void writeTextMessage(const google::protobuf::Message &message,
+                      const string &path)
+{
+    auto stream = openOutput(path, "writeTextMessage");
+    if (!google::protobuf::TextFormat::Print(message, stream.get()))
+        throw Exception("writeTextMessage: cannot write to " + path);
+    closeOutput(stream.get(), path, "writeTextMessage");
+}
+
+void writeJsonMessage(const google::protobuf::Message &message,
+                      const string &path)
+{
+    string binary;
+    if (!message.SerializeToString(&binary))
+        throw Exception("writeJsonMessage: cannot serialize " + path);
+    google::protobuf::io::ArrayInputStream input(binary.data(),
+                                                 binary.size());
+
+    const string prefix = "type.googleapis.com";
+    unique_ptr<google::protobuf::util::TypeResolver> resolver(
+        google::protobuf::util::NewTypeResolverForDescriptorPool(
+            prefix, message.GetDescriptor()->file()->pool()));
+    google::protobuf::util::JsonPrintOptions options;
+    options.add_whitespace = true;
+
+    auto stream = openOutput(path, "writeJsonMessage");
+    string type_url =
+        prefix + "/" + message.GetDescriptor()->full_name();
+    if (!google::protobuf::util::BinaryToJsonStream(
+             resolver.get(), type_url, &input, stream.get(), options)
+             .ok())
+        throw Exception("writeJsonMessage: cannot write to " + path);
+    closeOutput(stream.get(), path, "writeJsonMessage");
+}
+
+DelimitedReader::DelimitedReader(const string &path)
+    : path(path), file(path)
+{
+}
+
+bool DelimitedReader::next(google::protobuf::MessageLite *message)
+{
+    if (offset == file.size())
+        return false;
+
+    size_t remaining = file.size() - offset;
+    auto begin =
+        reinterpret_cast<const uint8_t *>(file.data()) + offset;
+    google::protobuf::io::CodedInputStream coded(
+        begin, std::min<size_t>(remaining, INT_MAX));
+    uint32_t size;
+    if (!coded.ReadVarint32(&size))
+        throw Exception("DelimitedReader: truncated size in " + path);
+    size_t header = coded.CurrentPosition();
+    if (header + size > remaining)
+        throw Exception("DelimitedReader: truncated message in " +
+                        path);
+    if (!message->ParseFromArray(begin + header, size))
+        throw Exception("DelimitedReader: cannot parse a message in " +
+                        path);
+    offset += header + size;
+    return true;
+}
+
+DelimitedWriter::DelimitedWriter(const string &path)
+    : path(path), stream(openOutput(path, "DelimitedWriter"))
+{
+}
+
+DelimitedWriter::~DelimitedWriter()
+{
+    // close the file without throwing if close() was not called
+    stream.reset();
+}
+
+void DelimitedWriter::write(
+    const google::protobuf::MessageLite &message)
+{
+    if (!stream ||
+        !google::protobuf::util::SerializeDelimitedToZeroCopyStream(
+            message, stream.get()))
+        throw Exception("DelimitedWriter: cannot write to " + path);
+}
+
+void DelimitedWriter::writeSerialized(const string &bytes)
+{
+    if (!stream || bytes.size() > INT_MAX)
+        throw Exception("DelimitedWriter: cannot write to " + path);
+    // the coded stream gives the unused buffer back when destroyed
+    google::protobuf::io::CodedOutputStream coded(stream.get());
+    coded.WriteVarint32(bytes.size());
+    coded.WriteRaw(bytes.data(), bytes.size());
+    if (coded.HadError())
+        throw Exception("DelimitedWriter: cannot write to " + path);
+}
+
+void DelimitedWriter::close()
+{
+    if (!stream)
+        return;
+    auto closing = std::move(stream);
+    closeOutput(closing.get(), path, "DelimitedWriter");
+}
+
+MessageChannel::MessageChannel(int fd) : input(fd), output(fd)
+{
+}
+
+bool MessageChannel::read(google::protobuf::MessageLite *message)
+{
+    // the message is merged into, not replaced
+    message->Clear();
+    bool clean_eof;
+    if (google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+            message, &input, &clean_eof))
+        return true;
+    if (clean_eof)
+        return false;
+    throw Exception("MessageChannel: malformed message");
+}
+
+void MessageChannel::write(const google::protobuf::MessageLite &message)
+{
+    if (!google::protobuf::util::SerializeDelimitedToZeroCopyStream(
+            message, &output))
+        throw Exception("MessageChannel: cannot send a message");
+}
+
+void MessageChannel::flush()
+{
+    if (!output.Flush())
+        throw Exception("MessageChannel: cannot send a message");
+}
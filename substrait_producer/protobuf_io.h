@@ -0,0 +1,165 @@
+#pragma once
+
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/message_lite.h>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+/**
+ * @brief A read-only memory mapping of a whole file. An empty file has
+ * no mapping and a nullptr data.
+ */
+class MappedFile
+{
+  public:
+    explicit MappedFile(const string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const
+    {
+        return bytes;
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+  private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+};
+
+/**
+ * @brief Parse a file holding one message. The message is parsed from a
+ * zero-copy stream over the mapped file, without a copy of the file.
+ *
+ * @param message
+ * @param path
+ */
+void readMessage(google::protobuf::MessageLite *message,
+                 const string &path);
+
+/**
+ * @brief Write one message to a file in the binary format. The message
+ * is serialized directly into the buffer of a FileOutputStream, without
+ * an intermediate string.
+ *
+ * @param message
+ * @param path
+ */
+void writeMessage(const google::protobuf::MessageLite &message,
+                  const string &path);
+
+/**
+ * @brief Write one message to a file in the text format, printed
+ * directly into the buffer of a FileOutputStream
+ *
+ * @param message
+ * @param path
+ */
+void writeTextMessage(const google::protobuf::Message &message,
+                      const string &path);
+
+/**
+ * @brief Write one message to a file in the JSON format, printed
+ * directly into the buffer of a FileOutputStream. The JSON printer of
+ * protobuf reads the binary format, so the message is serialized once
+ * in the binary format, which is smaller than its JSON.
+ *
+ * @param message
+ * @param path
+ */
+void writeJsonMessage(const google::protobuf::Message &message,
+                      const string &path);
+
+/**
+ * @brief Read a stream of length-delimited messages, i.e. each message
+ * is preceded by its size as a varint32, the format of
+ * google::protobuf::util::SerializeDelimitedToZeroCopyStream. The file
+ * is mapped and only the message being read is parsed, so a stream of
+ * any length is read with the memory of one message.
+ */
+class DelimitedReader
+{
+  public:
+    explicit DelimitedReader(const string &path);
+
+    /**
+     * @brief Parse the next message
+     *
+     * @param message
+     * @return false if all messages are read
+     */
+    bool next(google::protobuf::MessageLite *message);
+
+  private:
+    string path;
+    MappedFile file;
+    size_t offset = 0;
+};
+
+/**
+ * @brief Write a stream of length-delimited messages that
+ * DelimitedReader reads. The messages are serialized directly into the
+ * buffer of a FileOutputStream.
+ */
+class DelimitedWriter
+{
+  public:
+    explicit DelimitedWriter(const string &path);
+    ~DelimitedWriter();
+
+    DelimitedWriter(const DelimitedWriter &) = delete;
+    DelimitedWriter &operator=(const DelimitedWriter &) = delete;
+
+    void write(const google::protobuf::MessageLite &message);
+
+    // write a message already serialized in the binary format
+    void writeSerialized(const string &bytes);
+
+    // flush the stream and close the file
+    void close();
+
+  private:
+    string path;
+    unique_ptr<google::protobuf::io::FileOutputStream> stream;
+};
+
+/**
+ * @brief Exchange length-delimited messages, in the format of
+ * DelimitedWriter, over a connected stream socket. The messages are
+ * parsed from and serialized into the buffers of the streams, and the
+ * written messages are sent on flush. The socket is not closed with the
+ * channel.
+ */
+class MessageChannel
+{
+  public:
+    explicit MessageChannel(int fd);
+
+    MessageChannel(const MessageChannel &) = delete;
+    MessageChannel &operator=(const MessageChannel &) = delete;
+
+    /**
+     * @brief Parse the next message
+     *
+     * @param message
+     * @return false if the peer closed the connection
+     */
+    bool read(google::protobuf::MessageLite *message);
+
+    void write(const google::protobuf::MessageLite &message);
+
+    void flush();
+
+  private:
+    google::protobuf::io::FileInputStream input;
+    google::protobuf::io::FileOutputStream output;
+};
@@ -0,0 +1,132 @@
+#include "query_pipeline.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+typedef pair<int, shared_ptr<const Query>> Task;
+
+/**
+ * @brief A bounded queue of the parsed queries. push blocks while the
+ * queue is full and pop blocks while it is empty.
+ */
+class TaskQueue
+{
+  public:
+    explicit TaskQueue(size_t capacity) : capacity(capacity)
+    {
+    }
+
+    // false if the queue is closed
+    bool push(Task task)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]
+                      { return closed || tasks.size() < capacity; });
+        if (closed)
+            return false;
+        tasks.push_back(std::move(task));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // false once the queue is closed and empty
+    bool pop(Task &task)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock,
+                       [this] { return closed || !tasks.empty(); });
+        if (tasks.empty())
+            return false;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // no more task is pushed. The queued tasks are dropped if discard
+    void close(bool discard)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        if (discard)
+            tasks.clear();
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+  private:
+    size_t capacity;
+    std::mutex mutex;
+    std::condition_variable not_full, not_empty;
+    std::deque<Task> tasks;
+    bool closed = false;
+};
+} // namespace
+
+int planQueries(
+    QueryReader &reader, int workers,
+    const function<void(int, shared_ptr<const Query>)> &plan)
+{
+    int i = 0;
+    if (workers <= 1)
+    {
+        for (auto query = reader.next(); query;
+             query = reader.next(), i++)
+            plan(i, query);
+        return i;
+    }
+
+    TaskQueue queue(2 * workers);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&]
+    {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+            error = std::current_exception();
+        queue.close(true);
+    };
+
+    vector<std::thread> threads;
+    for (int w = 0; w < workers; w++)
+        threads.emplace_back(
+            [&]
+            {
+                Task task;
+                while (queue.pop(task))
+                {
+                    try
+                    {
+                        plan(task.first, task.second);
+                    }
+                    catch (...)
+                    {
+                        fail();
+                    }
+                    task.second.reset();
+                }
+            });
+
+    try
+    {
+        for (auto query = reader.next(); query;
+             query = reader.next(), i++)
+            if (!queue.push(Task(i, query)))
+                break;
+        queue.close(false);
+    }
+    catch (...)
+    {
+        fail();
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    return i;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "metadata/query.h"
+#include <functional>
+#include <memory>
+
+using namespace std;
+
+/**
+ * @brief Plan the queries of a reader on a number of threads. The
+ * calling thread parses the queries and hands them to the workers
+ * through a bounded queue, so at most 2 * workers parsed queries wait
+ * for a worker. A worker plans one query at a time. The queries are
+ * identified by their position in the
+ * reader, so an output named after the position does not depend on the
+ * number of workers or on the order the queries finish in.
+ *
+ * The first exception, thrown by the reader or by plan, stops the
+ * reading and is rethrown once the workers stopped. The queries still
+ * in the queue are dropped.
+ *
+ * @param reader
+ * @param workers the number of threads. With 1 the queries are planned
+ * in order on the calling thread
+ * @param plan plan the query at a position. It is called concurrently
+ * with workers > 1, so it must only share thread-safe state
+ * @return int the number of queries read
+ */
+int planQueries(
+    QueryReader &reader, int workers,
+    const function<void(int, shared_ptr<const Query>)> &plan);
@@ -0,0 +1,65 @@
+#include "configuration.h"
+#include "exceptions.h"
+#include "plan_writer.h"
+#include "substrait/plan.pb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * Send the queries of a query file to a plan_server and write the
+ * plans it replies as the engine does:
+ *
+ *   plan_client --socket PATH --query_path ... --plan_dir ...
+ *               [--plan_format ...] [--plan_stream ...]
+ */
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    auto parameter = InputParameter::parse(argc, argv);
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (parameter->socket_path.empty() ||
+        parameter->socket_path.size() >= sizeof(address.sun_path))
+        throw Exception("plan_client: invalid socket " +
+                        parameter->socket_path);
+    parameter->socket_path.copy(address.sun_path,
+                                parameter->socket_path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 ||
+        connect(fd, (sockaddr *)&address, sizeof(address)) < 0)
+        throw Exception("plan_client: cannot connect to " +
+                        parameter->socket_path);
+
+    substrait::Plan request;
+    readMessage(&request, parameter->query_path);
+    PlanWriter writer(*parameter);
+    {
+        MessageChannel channel(fd);
+        channel.write(request);
+        channel.flush();
+
+        substrait::Plan plan;
+        for (int i = 0; i < request.relations_size(); i++)
+        {
+            if (!channel.read(&plan))
+                throw Exception("plan_client: the server closed the "
+                                "connection");
+            if (plan.relations_size() == 0)
+                fprintf(stderr,
+                        "plan_client: query %d is not planned\n", i);
+            writer.write(i, plan);
+        }
+    }
+    writer.close();
+    close(fd);
+    google::protobuf::ShutdownProtobufLibrary();
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include "arena.h"
+#include "configuration.h"
+#include "evaluate/table_sample.h"
+#include "exceptions.h"
+#include "metadata/layout.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include "produce_plan/make_plan.h"
+#include <mutex>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+
+using namespace std;
+
+/**
+ * A long-running planner. The schema, the table range and the layout
+ * are loaded once and stay in memory, and plans are served over a Unix
+ * domain socket:
+ *
+ *   plan_server --socket PATH --schema_path ... --table_range ...
+ *               (--partition_path ... | --catalog_path ...)
+ *               [--data_path ...] [--sample_path ...] [--engine ...]
+ *               [--reconstruct-type ...] [--workers N]
+ *
+ * A request is a length-delimited substrait::Plan holding queries, as a
+ * query file does, and the reply is one length-delimited
+ * substrait::Plan per query, in order. The plans of a request whose
+ * queries cannot be planned have no relation. Each of the --workers
+ * threads serves one connection at a time, and a connection sends any
+ * number of requests.
+ *
+ * SIGHUP reloads the layout from the same path: a request planned
+ * after the reload reads the new layout, and the requests in progress
+ * finish on the old one. SIGINT and SIGTERM stop the server.
+ */
+
+namespace
+{
+// the connections being served, shut down to stop the server
+std::mutex connection_mutex;
+unordered_set<int> connections;
+bool stopping = false;
+
+int listenOn(const string &path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw Exception("plan_server: socket path too long " + path);
+    path.copy(address.sun_path, path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw Exception("plan_server: cannot create a socket");
+    // a socket left by a stopped server
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(fd, SOMAXCONN) < 0)
+    {
+        close(fd);
+        throw Exception("plan_server: cannot listen on " + path);
+    }
+    return fd;
+}
+
+void serve(int fd, shared_ptr<const Schema> table_schema,
+           shared_ptr<const TableStatistics> statistics,
+           const shared_ptr<const Layout> &layout)
+{
+    MessageChannel channel(fd);
+    substrait::Plan request;
+    while (channel.read(&request))
+    {
+        // the layout of the whole request, even if it is reloaded
+        auto current = std::atomic_load(&layout);
+        vector<shared_ptr<Query>> queries;
+        try
+        {
+            queries = Query::parseSubstraitQuery(
+                &request, table_schema, statistics,
+                InputParameter::get()->data_path);
+        }
+        catch (const exception &e)
+        {
+            fprintf(stderr, "plan_server: %s\n", e.what());
+            for (int i = 0; i < request.relations_size(); i++)
+                channel.write(substrait::Plan());
+            channel.flush();
+            continue;
+        }
+
+        for (int i = 0; i < (int)queries.size(); i++)
+        {
+            auto &query = queries[i];
+            google::protobuf::Arena arena;
+            auto plan =
+                google::protobuf::Arena::CreateMessage<substrait::Plan>(
+                    &arena);
+            try
+            {
+                QueryArena query_arena;
+                makeQueryPlan(plan, table_schema, query,
+                              current->selectPartitions(*query), i,
+                              query_arena.resource());
+            }
+            catch (const exception &e)
+            {
+                fprintf(stderr, "plan_server: %s\n", e.what());
+                plan->Clear();
+            }
+            query.reset();
+            channel.write(*plan);
+        }
+        channel.flush();
+    }
+}
+
+void acceptConnections(int listener,
+                       shared_ptr<const Schema> table_schema,
+                       shared_ptr<const TableStatistics> statistics,
+                       const shared_ptr<const Layout> &layout)
+{
+    while (true)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+        {
+            std::lock_guard<std::mutex> lock(connection_mutex);
+            if (stopping)
+                return;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(connection_mutex);
+            if (stopping)
+            {
+                close(fd);
+                return;
+            }
+            connections.insert(fd);
+        }
+
+        try
+        {
+            serve(fd, table_schema, statistics, layout);
+        }
+        catch (const exception &e)
+        {
+            // the client is gone or sent a malformed request
+            fprintf(stderr, "plan_server: %s\n", e.what());
+        }
+
+        std::lock_guard<std::mutex> lock(connection_mutex);
+        connections.erase(fd);
+        close(fd);
+    }
+}
+} // namespace
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    auto parameter = InputParameter::parse(argc, argv);
+    if (parameter->socket_path.empty())
+        throw Exception("plan_server: --socket is required");
+
+    // the signals are taken by sigwait in the main thread, so they are
+    // blocked before any thread starts. A closed connection fails the
+    // write instead of killing the server
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    // parse schema
+    shared_ptr<Schema> table_schema;
+    shared_ptr<const TableStatistics> statistics;
+    table_schema = Schema::readSchema(parameter->schema_path);
+    // get min/max
+    {
+        substrait::Partition s;
+        readSubstrait(&s, parameter->table_range_path);
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+        if (!parameter->sample_path.empty())
+            statistics = statistics->withSample(TableSample::readSample(
+                parameter->sample_path, table_schema));
+    }
+    // swapped by a reload, read by the workers with atomic_load
+    shared_ptr<const Layout> layout =
+        Layout::load(*parameter, table_schema, statistics);
+
+    int listener = listenOn(parameter->socket_path);
+    vector<std::thread> workers;
+    for (int w = 0; w < parameter->workers; w++)
+        workers.emplace_back(acceptConnections, listener, table_schema,
+                             statistics, std::cref(layout));
+    fprintf(stderr, "plan_server: listening on %s\n",
+            parameter->socket_path.c_str());
+
+    int signal_number;
+    while (sigwait(&signals, &signal_number) == 0 &&
+           signal_number == SIGHUP)
+    {
+        try
+        {
+            std::atomic_store(
+                &layout,
+                Layout::load(*parameter, table_schema, statistics));
+            fprintf(stderr, "plan_server: layout reloaded\n");
+        }
+        catch (const exception &e)
+        {
+            // keep serving the old layout
+            fprintf(stderr, "plan_server: %s\n", e.what());
+        }
+    }
+
+    // wake the workers blocked in accept or in reading a request
+    {
+        std::lock_guard<std::mutex> lock(connection_mutex);
+        stopping = true;
+        shutdown(listener, SHUT_RDWR);
+        for (int fd : connections)
+            shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &worker : workers)
+        worker.join();
+    close(listener);
+    unlink(parameter->socket_path.c_str());
+    google::protobuf::ShutdownProtobufLibrary();
+
+    return 0;
+}
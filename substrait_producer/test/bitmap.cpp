@@ -0,0 +1,119 @@
+#include "data_type/bitmap.h"
+#include <functional>
+#include <stdio.h>
+
+/**
+ * Check the Bitmap operations on bits in different words, that the
+ * bits beyond the size stay 0 through resizing, and the byte layout of
+ * the fixed binary literals.
+ */
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+Bitmap make(size_t size, const vector<int> &offsets)
+{
+    Bitmap bitmap(size);
+    for (int i : offsets)
+        bitmap.set(i);
+    return bitmap;
+}
+
+bool throws(const std::function<void()> &f)
+{
+    try
+    {
+        f();
+    }
+    catch (const Exception &)
+    {
+        return true;
+    }
+    return false;
+}
+}; // namespace
+
+int main(int argc, char const *argv[])
+{
+    Bitmap a = make(Bitmap::capacity, {0, 63, 64, 255});
+    check(a.test(63) && a.test(64) && a.test(255) && !a.test(1),
+          "set and test across words");
+    check(!a.test(-1) && !a.test(Bitmap::capacity),
+          "test beyond the size");
+    check(a.count() == 4, "count");
+    vector<int> found;
+    for (int i = a.findFirst(); i != Bitmap::npos; i = a.findNext(i))
+        found.push_back(i);
+    check(found == vector<int>({0, 63, 64, 255}), "find the set bits");
+    a.reset(64);
+    check(!a.test(64) && a.count() == 3, "reset");
+    check(Bitmap().size() == Bitmap::capacity && Bitmap().empty(),
+          "the default bitmap is empty at capacity");
+
+    Bitmap b(70);
+    b.resize(130, true);
+    check(b.count() == 60 && b.findFirst() == 70, "grow with ones");
+    b.resize(65);
+    check(b.count() == 0, "shrink clears the tail");
+    b.resize(130);
+    check(b.empty(), "the cleared tail stays 0 when growing");
+    check(throws([&] { b.set(130); }), "set beyond the size throws");
+    check(throws([&] { b.resize(Bitmap::capacity + 1); }),
+          "resize beyond the capacity throws");
+
+    Bitmap x = make(128, {1, 2, 100}), y = make(128, {2, 3});
+    check((x | y) == make(128, {1, 2, 3, 100}), "union");
+    check((x & y) == make(128, {2}), "intersection");
+    check((x - y) == make(128, {1, 100}), "difference");
+    check(x.intersects(y) && !x.intersects(make(128, {3})),
+          "intersects");
+    check(make(128, {2}).isSubsetOf(x) && !y.isSubsetOf(x), "subset");
+    check((make(10, {1}) | make(100, {90})).size() == 100,
+          "the union has the larger size");
+
+    check(x.relationship(x) == EQUAL, "equal");
+    check(make(128, {2}).relationship(x) == SUBSET, "subset relation");
+    check(x.relationship(make(128, {2})) == SUPERSET, "superset");
+    check(x.relationship(y) == INTERSECT, "intersect");
+    check(x.relationship(make(128, {5})) == DISJOINT, "disjoint");
+    check(x.relationship(Bitmap(128)) == DISJOINT,
+          "a non-empty set is disjoint with the empty set");
+    check(Bitmap(128).relationship(x) == SUBSET,
+          "the empty set is a subset");
+
+    check(make(128, {0}) < make(128, {1}) &&
+              make(128, {70}) < make(128, {71}) &&
+              make(128, {63}) < make(128, {64}),
+          "compare as unsigned numbers");
+    check(!(x < x), "a bitmap is not less than itself");
+
+    check(make(12, {0, 9, 11}).toBytes() == string("\x01\x0a", 2),
+          "bit i is bit i % 8 of byte i / 8");
+    check(Bitmap(0).toBytes().empty(), "no bytes for no bits");
+    check(make(5, {1, 4}).toString() == "01001", "toString");
+
+    boost::dynamic_bitset<> bits(70);
+    bits.set(3);
+    bits.set(69);
+    Bitmap converted(bits);
+    check(converted.size() == 70 && converted == make(70, {3, 69}),
+          "convert from boost");
+    check(converted.toBitset(70) == bits, "convert to boost");
+    check(throws([&] { converted.toBitset(50); }),
+          "convert to a smaller boost bitmap throws");
+
+    if (failures)
+        return 1;
+    printf("bitmap: passed\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "metadata/interval_list.h"
+#include <stdio.h>
+
+/**
+ * Check the set operations on normalized interval lists of integers
+ * against lists written out by hand, and the set relationships between
+ * lists and between a list and a plain interval.
+ */
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+// closed intervals [first, second]
+IntervalList make(const vector<pair<int, int>> &intervals)
+{
+    IntervalList list;
+    for (const auto &i : intervals)
+        list.push_back(
+            make_shared<Interval>(i.first, false, i.second, false));
+    return list;
+}
+
+string toString(const DataType *v)
+{
+    return std::to_string(dynamic_cast<const Integer *>(v)->getValue());
+}
+
+string toString(const IntervalList &list)
+{
+    string ret;
+    for (const auto &i : list)
+        ret += "[" + toString(i->lower()) + "," + toString(i->upper()) +
+               "]";
+    return ret;
+}
+
+void expect(const IntervalList &list, const string &expected,
+            const string &what)
+{
+    string got = toString(list);
+    check(got == expected,
+          what + " is " + got + ", expected " + expected);
+}
+}; // namespace
+
+int main(int argc, char const *argv[])
+{
+    using namespace interval_list;
+
+    expect(normalize(
+               make({{5, 7}, {0, 3}, {4, 4}, {10, 12}, {11, 20}})),
+           "[0,7][10,20]", "normalize merges overlapping and adjacent");
+    expect(normalize(make({})), "", "normalize of nothing");
+    IntervalList open;
+    open.push_back(make_shared<Interval>(0, true, 5, true));
+    expect(open, "[1,4]", "open end points");
+
+    auto a = make({{0, 2}, {6, 8}});
+    auto b = make({{3, 4}, {10, 11}});
+    auto u = Union(a, b);
+    expect(u, "[0,4][6,8][10,11]", "union");
+    check(u[1] == a[1], "union shares the unchanged intervals");
+    expect(Union(a, make({})), "[0,2][6,8]", "union with nothing");
+
+    auto c = make({{0, 5}, {8, 12}});
+    expect(intersect(c, make({{3, 9}})), "[3,5][8,9]", "intersect");
+    expect(intersect(c, make({{6, 7}})), "", "intersect in a gap");
+    expect(intersect(c, Interval(4, false, 20, false)), "[4,5][8,12]",
+           "intersect with an interval");
+
+    expect(difference(make({{0, 10}}), make({{2, 3}, {5, 5}})),
+           "[0,1][4,4][6,10]", "difference");
+    expect(difference(make({{0, 10}}), make({{0, 10}})), "",
+           "difference with itself");
+
+    expect(coarsen(make({{0, 1}, {3, 4}, {10, 11}, {13, 14}}), 2),
+           "[0,4][10,14]", "coarsen fills the smallest gaps");
+    expect(coarsen(c, 4), "[0,5][8,12]", "coarsen under the limit");
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto in_arena = Union(a, b, &arena);
+    check(in_arena.get_allocator().resource() == &arena,
+          "the result is allocated from the resource");
+
+    Interval plain(0, false, 9, false);
+    check(relationship(make({}), plain) == DISJOINT,
+          "an empty list is disjoint");
+    check(relationship(make({{0, 9}}), plain) == EQUAL, "equal");
+    check(relationship(make({{1, 2}, {4, 5}}), plain) == SUBSET,
+          "subset");
+    check(relationship(make({{-5, 20}}), plain) == SUPERSET,
+          "superset");
+    check(relationship(make({{-5, 2}, {20, 30}}), plain) == INTERSECT,
+          "intersect");
+    check(relationship(make({{10, 12}}), plain) == DISJOINT,
+          "disjoint");
+
+    check(relationship(c, c) == EQUAL, "lists equal");
+    check(relationship(make({{1, 2}, {9, 10}}), c) == SUBSET,
+          "list subset");
+    check(relationship(c, make({{1, 2}, {9, 10}})) == SUPERSET,
+          "list superset");
+    check(relationship(c, make({{4, 7}})) == INTERSECT,
+          "lists intersect");
+    check(relationship(c, make({{6, 7}, {13, 20}})) == DISJOINT,
+          "lists disjoint");
+    check(relationship(make({}), make({})) == DISJOINT,
+          "empty lists are disjoint");
+
+    if (failures)
+        return 1;
+    printf("interval_list: passed\n");
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "data_type/data_type_api.h"
+#include "evaluate/predicate_program.h"
+#include "metadata/expression.h"
+#include <algorithm>
+#include <limits>
+#include <stdio.h>
+
+/**
+ * Compile predicates over a batch of five rows and compare the rows
+ * selected by the interpreter with the expected ones. The integer
+ * column i holds both ends of int64, so the comparisons against a
+ * literal at or beyond them check the bounds of the range kernels. The
+ * column j is small and nullable for the arithmetic and the null
+ * tests, and d is a double column.
+ */
+
+namespace
+{
+constexpr int64_t kIntMin = std::numeric_limits<int64_t>::min();
+constexpr int64_t kIntMax = std::numeric_limits<int64_t>::max();
+
+int failures = 0;
+
+void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+shared_ptr<const Expression> column(const string &name, DATA_TYPE type)
+{
+    return make_shared<Attribute>(name, type);
+}
+
+shared_ptr<const Expression> intLiteral(int64_t v)
+{
+    return make_shared<Literal>("literal", make_shared<Integer>(v, 64));
+}
+
+// a Double keeps v * 10^precision in an int64, the literals beyond
+// int64 need a negative precision
+shared_ptr<const Expression> doubleLiteral(double v, int precision = 1)
+{
+    return make_shared<Literal>("literal",
+                                make_shared<Double>(v, precision));
+}
+
+shared_ptr<const Expression> call(
+    const string &op, const vector<shared_ptr<const Expression>> &args,
+    DATA_TYPE type = DATA_TYPE::BOOLEAN)
+{
+    return make_shared<FunctionExpression>(op, op, args, type);
+}
+
+// the rows selected by the compiled predicate, as a string of 0 and 1
+string select(shared_ptr<const Expression> predicate,
+              const ColumnBatch &batch, int *instructions = nullptr)
+{
+    auto program = PredicateProgram::compile(predicate, nullptr);
+    if (instructions)
+        *instructions = program->numOfInstructions();
+    vector<uint8_t> selected;
+    program->evaluate(batch, selected);
+    string rows;
+    for (auto s : selected)
+        rows += s ? '1' : '0';
+    check(program->count(batch) == std::count(rows.begin(), rows.end(),
+                                              '1'),
+          "count agrees with evaluate for " + predicate->toString());
+    return rows;
+}
+
+void expect(shared_ptr<const Expression> predicate,
+            const ColumnBatch &batch, const string &rows)
+{
+    string got = select(predicate, batch);
+    check(got == rows, predicate->toString() + " selects " + got +
+                           ", expected " + rows);
+}
+}; // namespace
+
+int main(int argc, char const *argv[])
+{
+    ColumnBatch batch(5);
+    batch.addColumn("i", DATA_TYPE::INTEGER).ints = {kIntMin, -1, 0, 1,
+                                                     kIntMax};
+    Column &j = batch.addColumn("j", DATA_TYPE::INTEGER);
+    j.ints = {3, 1, 4, 1, 5};
+    j.valid = {1, 1, 0, 1, 1};
+    batch.addColumn("d", DATA_TYPE::DOUBLE).doubles = {-2.5, -0.5, 0,
+                                                       0.5, 2.5};
+
+    auto i = column("i", DATA_TYPE::INTEGER);
+    auto jc = column("j", DATA_TYPE::INTEGER);
+    auto d = column("d", DATA_TYPE::DOUBLE);
+
+    // integer literals at the ends of int64
+    expect(call("gt", {i, intLiteral(kIntMax)}), batch, "00000");
+    expect(call("lt", {i, intLiteral(kIntMin)}), batch, "00000");
+    expect(call("gte", {i, intLiteral(kIntMax)}), batch, "00001");
+    expect(call("lte", {i, intLiteral(kIntMin)}), batch, "10000");
+    expect(call("lt", {intLiteral(kIntMax), i}), batch, "00000");
+    expect(call("equal", {i, intLiteral(0)}), batch, "00100");
+
+    // double literals against an integer column
+    expect(call("gt", {i, doubleLiteral(1e19, -1)}), batch, "00000");
+    expect(call("lte", {i, doubleLiteral(1e19, -1)}), batch, "11111");
+    expect(call("lt", {i, doubleLiteral(-1e19, -1)}), batch, "00000");
+    expect(call("gte", {i, doubleLiteral(-1e19, -1)}), batch, "11111");
+    expect(call("equal", {i, doubleLiteral(1e19, -1)}), batch,
+           "00000");
+    expect(call("gt", {i, doubleLiteral(0.5)}), batch, "00011");
+    expect(call("lte", {i, doubleLiteral(-0.5)}), batch, "11000");
+    expect(call("equal", {i, doubleLiteral(0.5)}), batch, "00000");
+
+    // double columns
+    expect(call("gt", {d, doubleLiteral(0)}), batch, "00011");
+    expect(call("lte", {d, intLiteral(0)}), batch, "11100");
+
+    // the ranges of an and chain merge into one kernel per column
+    auto chain = call(
+        "and", {call("gte", {i, intLiteral(-1)}),
+                call("and", {call("lte", {i, intLiteral(1)}),
+                             call("gt", {i, intLiteral(-1)})})});
+    int instructions = 0;
+    check(select(chain, batch, &instructions) == "00110",
+          "the and chain selects the merged range");
+    check(instructions == 1, "the and chain is one range kernel");
+    expect(call("and", {call("gte", {i, intLiteral(-1)}),
+                        call("lt", {d, doubleLiteral(0.5)})}),
+           batch, "01100");
+
+    expect(call("or", {call("equal", {i, intLiteral(kIntMin)}),
+                       call("gt", {d, doubleLiteral(1)})}),
+           batch, "10001");
+    expect(call("not", {call("gt", {d, doubleLiteral(0)})}), batch,
+           "11100");
+
+    // arithmetic and nulls
+    expect(call("gt",
+                {call("add", {jc, intLiteral(1)}, DATA_TYPE::INTEGER),
+                 intLiteral(3)}),
+           batch, "10101");
+    expect(call("is_null", {jc}), batch, "00100");
+    expect(call("is_not_null", {jc}), batch, "11011");
+
+    if (failures)
+        return 1;
+    printf("predicate_program: passed\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "metadata/query_template.h"
+#include "substrait/type.pb.h"
+#include <stdio.h>
+
+/**
+ * Check that the queries differing only in their literals share a
+ * template, that a new shape or a new schema builds another one, and
+ * that the cache evicts the least recently used template once it holds
+ * QueryTemplate::kCacheCapacity templates. Every schema read has its
+ * own identity, so a schema per query fills the cache.
+ */
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+// a0, m
+shared_ptr<const Schema> makeSchema()
+{
+    substrait::NamedStruct s;
+    for (string name : {"a0", "m"})
+    {
+        s.add_names(name);
+        s.mutable_struct_()->add_types()->mutable_i64();
+        s.add_sizes(8);
+    }
+    return Schema::parseSubstraitSchema(&s);
+}
+
+shared_ptr<const Expression> literal(int64_t v)
+{
+    return make_shared<Literal>("literal", make_shared<Integer>(v, 64));
+}
+
+// op(a0, value) and m < 100
+shared_ptr<const FunctionExpression> makeFilter(const string &op,
+                                                int64_t value)
+{
+    auto a0 = make_shared<Attribute>("a0", DATA_TYPE::INTEGER);
+    auto m = make_shared<Attribute>("m", DATA_TYPE::INTEGER);
+    vector<shared_ptr<const Expression>> conjuncts = {
+        make_shared<FunctionExpression>(
+            op, op,
+            vector<shared_ptr<const Expression>>{a0, literal(value)},
+            DATA_TYPE::BOOLEAN),
+        make_shared<FunctionExpression>(
+            "lt", "lt",
+            vector<shared_ptr<const Expression>>{m, literal(100)},
+            DATA_TYPE::BOOLEAN)};
+    return make_shared<FunctionExpression>("and", "and", conjuncts,
+                                           DATA_TYPE::BOOLEAN);
+}
+
+const vector<shared_ptr<const AggregateExpression>> measures = {
+    make_shared<AggregateExpression>(
+        "sum", "sum",
+        vector<shared_ptr<const Expression>>{
+            make_shared<Attribute>("m", DATA_TYPE::INTEGER)},
+        DATA_TYPE::INTEGER)};
+
+shared_ptr<const QueryTemplate> get(shared_ptr<const Schema> schema,
+                                    const string &op, int64_t value)
+{
+    vector<shared_ptr<const Expression>> nodes;
+    return QueryTemplate::get(schema, makeFilter(op, value), measures,
+                              nodes);
+}
+}; // namespace
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    auto schema = makeSchema();
+    auto t = get(schema, "gte", 1);
+    check(t->numOfSubFilters() == 2 &&
+              t->subFilterAttributes() == vector<int>({0, 1}),
+          "the template has a conjunct per attribute");
+    check(get(schema, "lte", 1) != t, "another shape misses");
+    check(get(makeSchema(), "gte", 1) != t, "another schema misses");
+
+    // a hit collects the nodes of the new filter
+    auto filter = makeFilter("gte", 5);
+    vector<shared_ptr<const Expression>> nodes;
+    check(QueryTemplate::get(schema, filter, measures, nodes) == t,
+          "a query with other literals hits");
+    auto conjuncts = t->subFilters(nodes);
+    check(conjuncts.size() == 2 &&
+              conjuncts[0] == filter->getChildren()[0],
+          "the conjuncts of a hit are the nodes of its filter");
+
+    // add a template per schema until the cache overflows. The other
+    // templates above are evicted first, then t is used again before
+    // the last insertion, which evicts the template of schemas[0]
+    // instead
+    size_t n = QueryTemplate::kCacheCapacity;
+    vector<shared_ptr<const Schema>> schemas;
+    vector<shared_ptr<const QueryTemplate>> templates;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i == n - 1)
+            check(get(schema, "gte", 2) == t, "t is still cached");
+        schemas.push_back(makeSchema());
+        templates.push_back(get(schemas.back(), "gte", 1));
+    }
+    check(get(schema, "gte", 3) == t,
+          "the recently used template is kept");
+    check(get(schemas[1], "gte", 1) == templates[1],
+          "a template added after t is kept");
+    check(get(schemas[0], "gte", 1) != templates[0],
+          "the least recently used template is evicted");
+
+    google::protobuf::ShutdownProtobufLibrary();
+    if (failures)
+        return 1;
+    printf("query_template: passed\n");
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "arena.h"
+#include "configuration.h"
+#include "metadata/block_catalog.h"
+#include "metadata/boundary.h"
+#include "metadata/query.h"
+#include "metadata/schema.h"
+#include "metadata/statistics.h"
+#include "partitioner/common.h"
+#include "produce_plan/produce_scan_parameter.h"
+#include "substrait/partition.pb.h"
+#include "substrait/plan.pb.h"
+#include <filesystem>
+#include <stdio.h>
+
+/**
+ * Partition a table into two column groups as the partitioner does and
+ * check that the tuple ids it writes prune the blocks that share no
+ * tuple with the blocks requesting them. The table has 1024 rows in
+ * chunks of 64: a0 is 0 in the even chunks and a1 is 0 in the odd
+ * ones. The query a0 = 0 and a1 = 0 reads a1 from the blocks of the
+ * other group, and the block of a1 = 0 holds none of the tuples of the
+ * block of a0 = 0, so it is not read once the layout has tuple ids,
+ * whether the layout is read from the partition list or the catalog.
+ */
+
+namespace
+{
+constexpr int64_t kRows = 1024;
+constexpr int64_t kChunk = 64;
+
+int failures = 0;
+
+void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+void field(substrait::Expression *e, int i)
+{
+    auto s = e->mutable_selection();
+    s->mutable_direct_reference()->mutable_struct_field()->set_field(i);
+    s->mutable_root_reference();
+}
+
+void compare(substrait::Expression *e, int function, int attribute,
+             int64_t value)
+{
+    auto f = e->mutable_scalar_function();
+    f->set_function_reference(function);
+    field(f->add_arguments()->mutable_value(), attribute);
+    f->add_arguments()->mutable_value()->mutable_literal()->set_i64(
+        value);
+    f->mutable_output_type()->mutable_bool_();
+}
+
+// sum(m) where a0 = 0 and a1 = 0
+substrait::Plan makeQuery()
+{
+    substrait::Plan plan;
+    const char *names[] = {"and", "gte", "lte", "sum"};
+    for (int i = 0; i < 4; i++)
+    {
+        auto f = plan.add_extensions()->mutable_extension_function();
+        f->set_function_anchor(i);
+        f->set_name(names[i]);
+    }
+    auto aggregate =
+        plan.add_relations()->mutable_rel()->mutable_aggregate();
+    auto measure = aggregate->add_measures()->mutable_measure();
+    measure->set_function_reference(3);
+    field(measure->add_arguments()->mutable_value(), 3);
+    measure->mutable_output_type()->mutable_i64();
+    auto conjunction = aggregate->mutable_input()
+                           ->mutable_filter()
+                           ->mutable_condition()
+                           ->mutable_scalar_function();
+    conjunction->set_function_reference(0);
+    conjunction->mutable_output_type()->mutable_bool_();
+    for (int attribute = 1; attribute <= 2; attribute++)
+    {
+        compare(conjunction->add_arguments()->mutable_value(), 1,
+                attribute, 0);
+        compare(conjunction->add_arguments()->mutable_value(), 2,
+                attribute, 0);
+    }
+    return plan;
+}
+
+// the blocks that the plan of the query reads, as "a0:id" for the
+// group of a0 and "a1:id" for the group of a1
+set<string> readBlocks(
+    shared_ptr<const Query> query,
+    shared_ptr<const Schema> table_schema,
+    const vector<shared_ptr<const PartitionMeta>> &partitions)
+{
+    QueryArena arena;
+    auto params = produceScanParametersAggregation(
+        query, table_schema, partitions, arena.resource());
+    set<string> blocks;
+    for (const auto &side : {params.first, params.second})
+        for (auto p : side)
+            for (auto b : p->blocks)
+                blocks.insert(
+                    (b->getSchema()->contains("a0") ? "a0:" : "a1:") +
+                    std::to_string(b->getBlockID()));
+    return blocks;
+}
+}; // namespace
+
+int main(int argc, char const *argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    InputParameter::parse(argc, argv);
+
+    // tid, a0, a1, m
+    shared_ptr<Schema> table_schema;
+    {
+        substrait::NamedStruct s;
+        for (string name : {tuple_id_name, string("a0"), string("a1"),
+                            string("m")})
+        {
+            s.add_names(name);
+            s.mutable_struct_()->add_types()->mutable_i64();
+            s.add_sizes(8);
+        }
+        table_schema = Schema::parseSubstraitSchema(&s);
+    }
+    shared_ptr<const TableStatistics> statistics;
+    {
+        substrait::Partition s;
+        auto b = s.add_blocks();
+        b->set_rows_num(kRows);
+        const pair<string, int64_t> ranges[] = {
+            {tuple_id_name, kRows - 1}, {"a0", 1}, {"a1", 1},
+            {"m", kRows - 1}};
+        for (const auto &range : ranges)
+        {
+            b->add_attributes(range.first);
+            auto interval = b->add_boundary();
+            interval->set_attribute(range.first);
+            interval->mutable_low()->set_i64(0);
+            interval->mutable_high()->set_i64(range.second);
+        }
+        statistics =
+            TableStatistics::parseSubstraitTableRange(&s, table_schema);
+    }
+
+    auto rows = make_shared<ColumnBatch>(kRows);
+    {
+        auto &tid = rows->addColumn(tuple_id_name, DATA_TYPE::INTEGER);
+        auto &a0 = rows->addColumn("a0", DATA_TYPE::INTEGER);
+        auto &a1 = rows->addColumn("a1", DATA_TYPE::INTEGER);
+        auto &m = rows->addColumn("m", DATA_TYPE::INTEGER);
+        for (int64_t i = 0; i < kRows; i++)
+        {
+            tid.ints[i] = m.ints[i] = i;
+            a0.ints[i] = (i / kChunk) % 2;
+            a1.ints[i] = 1 - a0.ints[i];
+        }
+    }
+    TableSample table_rows(table_schema, rows,
+                           {tuple_id_name, "a0", "a1", "m"});
+
+    // {tid, a0, m} split on a0 and {tid, a1} split on a1
+    vector<shared_ptr<const BlockMeta>> blocks;
+    const pair<vector<string>, string> groups[] = {
+        {{tuple_id_name, "a0", "m"}, "a0"},
+        {{tuple_id_name, "a1"}, "a1"}};
+    for (const auto &group : groups)
+    {
+        auto schema = make_shared<Schema>();
+        for (const auto &name : group.first)
+            schema->add(table_schema->get(name));
+        IntervalMap empty_intervals;
+        BlockMeta root(
+            0, make_shared<Boundary>(empty_intervals, statistics),
+            schema, nullptr, kRows);
+        for (auto b : root.split(group.second,
+                                 make_shared<Integer>(0, 64), true))
+            blocks.push_back(b);
+    }
+    boost::dynamic_bitset<> all_attributes(table_schema->size());
+    all_attributes.set();
+
+    // write each layout as the partitioner does and read it back
+    auto read_layout = [&](const TableSample *table_rows,
+                           const string &catalog_path) {
+        auto layout = makePartitions(blocks, all_attributes,
+                                     table_schema, table_rows);
+        substrait::PartitionList list;
+        for (int i = 0; i < (int)layout.size(); i++)
+            layout[i]->makeSubstraitPartition(list.add_partitions(), i,
+                                              table_schema);
+        vector<shared_ptr<const PartitionMeta>> partitions;
+        for (int i = 0; i < list.partitions_size(); i++)
+            partitions.push_back(PartitionMeta::parseSubstraitPartition(
+                &list.partitions(i), table_schema, statistics, ""));
+        BlockCatalog::writeCatalog(catalog_path, layout, table_schema);
+        return partitions;
+    };
+
+    substrait::Plan plan = makeQuery();
+    auto query = Query::parseSubstraitQuery(&plan, table_schema,
+                                            statistics, "")[0];
+    string directory = std::filesystem::temp_directory_path();
+    string with_path = directory + "/tid_pruning_ids.catalog";
+    string without_path = directory + "/tid_pruning.catalog";
+
+    auto with_ids = read_layout(&table_rows, with_path);
+    auto without_ids = read_layout(nullptr, without_path);
+
+    // block 0 of each group is a0 = 0 (even chunks) or a1 = 0 (odd
+    // chunks), written as 8 runs of 64 tuple ids
+    auto a0_block = with_ids[0]->getBlocks()[0];
+    auto a1_block = with_ids[1]->getBlocks()[0];
+    check(a0_block->hasTidRange() && a1_block->hasTidRange(),
+          "the partitioner writes the tuple ids of the blocks");
+    check(a0_block->getTidMin() == 0 &&
+              a0_block->getTidMax() == kRows - kChunk - 1,
+          "the tuple id range is the hull of the runs");
+    check(a0_block->tidDisjoint(*a1_block),
+          "interleaved blocks are disjoint by their tuple ids");
+    check(!a0_block->tidDisjoint(*with_ids[1]->getBlocks()[1]),
+          "blocks sharing tuples are not disjoint");
+    check(!without_ids[0]->getBlocks()[0]->hasTidRange(),
+          "a layout without rows has no tuple ids");
+
+    set<string> expected_with = {"a0:0"},
+                expected_without = {"a0:0", "a1:0"};
+    check(readBlocks(query, table_schema, with_ids) == expected_with,
+          "the partition list prunes the tid-disjoint block");
+    check(readBlocks(query, table_schema, without_ids) ==
+              expected_without,
+          "the block is read without tuple ids");
+
+    for (const auto &catalog :
+         {make_pair(with_path, expected_with),
+          make_pair(without_path, expected_without)})
+    {
+        auto opened = BlockCatalog::openCatalog(
+            catalog.first, table_schema, statistics, "");
+        auto selected =
+            opened->selectPartitions(*query->getFilterBoundary(),
+                                     query->getAllReferredAttributes());
+        check(readBlocks(query, table_schema, selected) ==
+                  catalog.second,
+              "the catalog " + catalog.first + " prunes as the list");
+        std::filesystem::remove(catalog.first);
+    }
+
+    google::protobuf::ShutdownProtobufLibrary();
+    if (failures)
+        return 1;
+    printf("tid_pruning: passed\n");
+    return 0;
+}